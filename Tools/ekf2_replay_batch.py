@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+
+"""
+Run the EKF2 replay over many ULog files in parallel, e.g. to re-evaluate the estimator after a parameter change.
+
+Each log is replayed by a separate, headless px4 process (its own instance id and working directory, so the
+uORB state is isolated). The ekf2 replay mode runs as fast as the estimator can process the data.
+The estimator output of each log is written to <output>/<log name>_replayed.ulg.
+
+PX4 must be built for replay, i.e. with the 'replay' environment variable set (it enables the uORB publisher rules):
+    replay=any.ulg make px4_sitl_default
+
+Example:
+    ./Tools/ekf2_replay_batch.py -j 8 -p replay_params.txt -o replayed ~/logs
+"""
+
+import argparse
+import glob
+import os
+import queue
+import shutil
+import subprocess
+import sys
+import threading
+import time
+
+
+def find_logs(paths):
+    """ get all .ulg files from a list of files and directories (recursive) """
+    logs = []
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, files in os.walk(path):
+                logs.extend(os.path.join(root, f) for f in sorted(files) if f.endswith('.ulg'))
+        else:
+            logs.append(path)
+    return logs
+
+
+def replay_log(log, name, instance, args):
+    """ replay a single log, returns (success, output file or error message) """
+    working_dir = os.path.join(args.output, 'work_' + name)
+    if os.path.exists(working_dir):
+        shutil.rmtree(working_dir)
+    os.makedirs(working_dir)
+
+    if args.params:
+        shutil.copy(args.params, os.path.join(working_dir, 'replay_params.txt'))
+
+    env = os.environ.copy()
+    env['replay'] = os.path.abspath(log)
+    env['replay_mode'] = 'ekf2'
+
+    cmd = [args.px4_binary, '-i', str(instance), '-d', args.romfs, '-s', 'etc/init.d-posix/rcS']
+
+    with open(os.path.join(working_dir, 'out.log'), 'w') as out:
+        try:
+            ret = subprocess.call(cmd, cwd=working_dir, env=env, stdout=out, stderr=subprocess.STDOUT,
+                                  timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            return False, 'timeout'
+
+    if ret != 0:
+        return False, 'px4 exited with {:}'.format(ret)
+
+    replayed = glob.glob(os.path.join(working_dir, 'log', '**', '*.ulg'), recursive=True)
+    if len(replayed) == 0:
+        return False, 'no log written'
+
+    output_file = os.path.join(args.output, name + '_replayed.ulg')
+    shutil.move(max(replayed, key=os.path.getmtime), output_file)
+
+    if not args.keep:
+        shutil.rmtree(working_dir)
+
+    return True, output_file
+
+
+def main():
+    src_path = os.path.realpath(os.path.join(os.path.dirname(__file__), '..'))
+
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('logs', nargs='+', help='ULog files or directories (searched recursively)')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count() or 1,
+                        help='number of parallel replays (default: number of CPUs)')
+    parser.add_argument('-o', '--output', default='replayed', help='output directory (default: %(default)s)')
+    parser.add_argument('-p', '--params', default=None,
+                        help='parameter override file, used for all logs (format: "<name> <value>" per line)')
+    parser.add_argument('--px4-binary', default=os.path.join(src_path, 'build', 'px4_sitl_default', 'bin', 'px4'),
+                        help='px4 binary (default: %(default)s)')
+    parser.add_argument('--romfs', default=os.path.join(src_path, 'ROMFS', 'px4fmu_common'),
+                        help='ROMFS directory (default: %(default)s)')
+    parser.add_argument('--timeout', type=float, default=3600, help='timeout per log [s] (default: %(default)s)')
+    parser.add_argument('--keep', action='store_true', help='keep the working directories (px4 output)')
+    args = parser.parse_args()
+
+    args.px4_binary = os.path.abspath(args.px4_binary)
+    args.romfs = os.path.abspath(args.romfs)
+
+    if not os.path.isfile(args.px4_binary):
+        print('px4 binary not found: {:}'.format(args.px4_binary))
+        sys.exit(1)
+
+    logs = find_logs(args.logs)
+    if len(logs) == 0:
+        print('no logs found')
+        sys.exit(1)
+
+    if not os.path.exists(args.output):
+        os.makedirs(args.output)
+
+    jobs = max(1, min(args.jobs, len(logs)))
+    print('replaying {:} logs with {:} jobs'.format(len(logs), jobs))
+
+    # output names must be unique, even if logs from different directories have the same name
+    pending = queue.Queue()
+    names = set()
+    for log in logs:
+        name = os.path.splitext(os.path.basename(log))[0]
+        unique_name = name
+        suffix = 1
+        while unique_name in names:
+            unique_name = '{:}_{:}'.format(name, suffix)
+            suffix += 1
+        names.add(unique_name)
+        pending.put((log, unique_name))
+
+    lock = threading.Lock()
+    failed = []
+    num_done = [0]
+
+    def worker(instance):
+        while True:
+            try:
+                log, name = pending.get_nowait()
+            except queue.Empty:
+                return
+            log_start = time.time()
+            success, result = replay_log(log, name, instance, args)
+            with lock:
+                num_done[0] += 1
+                status = 'ok' if success else 'FAILED'
+                print('[{:}/{:}] {:}: {:} ({:}, {:.1f} s)'.format(num_done[0], len(logs), log, status, result,
+                                                                  time.time() - log_start))
+                if not success:
+                    failed.append(log)
+
+    start = time.time()
+    # the instance id separates the px4 daemons (sockets) of the parallel replays
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(jobs)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    duration = time.time() - start
+
+    print('')
+    print('replayed {:} logs ({:} failed) in {:.1f} s: {:.0f} logs/hour'.format(
+        len(logs), len(failed), duration, len(logs) * 3600. / duration if duration > 0 else 0))
+    for log in failed:
+        print('  failed: {:}'.format(log))
+
+    sys.exit(1 if len(failed) > 0 else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,251 @@
+#!/usr/bin/env python
+
+"""
+Convert a compressed and/or delta encoded ULog file back into a standard ULog file (.ulg).
+
+- Compressed files (.ulgz) are written by the logger with SDLOG_COMPRESS enabled. The
+  container consists of a 16 byte file header, followed by blocks of LZ4 block format
+  data (see src/modules/logger/log_compressor.h).
+- Delta encoded files are written with SDLOG_DELTA enabled: DATA_DELTA messages are
+  expanded into DATA messages (see src/modules/logger/data_delta.h). The log index is removed,
+  because its file offsets are not valid anymore.
+"""
+
+from __future__ import print_function
+
+from argparse import ArgumentParser
+import io
+import struct
+import sys
+
+
+FILE_MAGIC = b'ULogZ\x01\x12\x35'
+FILE_HEADER = struct.Struct('<8sBBHI')
+BLOCK_HEADER = struct.Struct('<2sBBII')
+BLOCK_MAGIC = b'ZB'
+CODEC_LZ4_BLOCK = 1
+BLOCK_FLAG_STORED = 1 << 0
+
+ULOG_HEADER_SIZE = 16
+ULOG_MSG_HEADER = struct.Struct('<HB')
+INCOMPAT_FLAG0_DATA_DELTA_MASK = 1 << 1
+
+
+def lz4_block_decompress(data, raw_size):
+    """ decompress a single LZ4 block """
+    out = bytearray()
+    i = 0
+    n = len(data)
+
+    while i < n:
+        token = data[i]
+        i += 1
+
+        length = token >> 4
+        if length == 15:
+            while True:
+                b = data[i]
+                i += 1
+                length += b
+                if b != 255:
+                    break
+        out += data[i:i + length]
+        i += length
+
+        if i >= n: # the last sequence only contains literals
+            break
+
+        offset = data[i] | (data[i + 1] << 8)
+        i += 2
+        if offset == 0 or offset > len(out):
+            raise ValueError('invalid match offset')
+
+        length = token & 0xf
+        if length == 15:
+            while True:
+                b = data[i]
+                i += 1
+                length += b
+                if b != 255:
+                    break
+        length += 4
+
+        start = len(out) - offset
+        if length <= offset:
+            out += out[start:start + length]
+        else: # overlapping match
+            for k in range(length):
+                out.append(out[start + k])
+
+    if len(out) != raw_size:
+        raise ValueError('decompressed size mismatch')
+
+    return out
+
+
+def decompress(f_in, f_out):
+    """ decompress a file, returns (compressed bytes, decompressed bytes) """
+    header = f_in.read(FILE_HEADER.size)
+    if len(header) != FILE_HEADER.size:
+        raise ValueError('file too short')
+
+    magic, version, codec, _, max_block_size = FILE_HEADER.unpack(header)
+    if magic != FILE_MAGIC:
+        raise ValueError('not a compressed ULog file')
+    if version != 1 or codec != CODEC_LZ4_BLOCK:
+        raise ValueError('unsupported version ({:}) or codec ({:})'.format(version, codec))
+
+    compressed_size = FILE_HEADER.size
+    raw_size = 0
+
+    while True:
+        block_header = f_in.read(BLOCK_HEADER.size)
+        if len(block_header) == 0:
+            break
+        if len(block_header) != BLOCK_HEADER.size:
+            print('Warning: truncated block header at the end of the file', file=sys.stderr)
+            break
+
+        magic, flags, _, block_raw_size, data_size = BLOCK_HEADER.unpack(block_header)
+        if magic != BLOCK_MAGIC or block_raw_size > max_block_size:
+            raise ValueError('invalid block at offset {:}'.format(compressed_size))
+
+        data = bytearray(f_in.read(data_size))
+        if len(data) != data_size:
+            print('Warning: truncated block at the end of the file', file=sys.stderr)
+            break
+
+        if flags & BLOCK_FLAG_STORED:
+            f_out.write(data)
+        else:
+            f_out.write(lz4_block_decompress(data, block_raw_size))
+
+        compressed_size += BLOCK_HEADER.size + data_size
+        raw_size += block_raw_size
+
+    return compressed_size, raw_size
+
+
+def expand_delta(data):
+    """ expand the DATA_DELTA messages of an ULog file (bytearray), returns the new file """
+    pos = ULOG_HEADER_SIZE
+    msg_size, msg_type = ULOG_MSG_HEADER.unpack_from(data, pos)
+    if msg_type != ord('B') or not data[pos + 3 + 8] & INCOMPAT_FLAG0_DATA_DELTA_MASK:
+        return data # not delta encoded
+
+    out = bytearray(data[:ULOG_HEADER_SIZE])
+    references = {}
+    appended_offsets = list(struct.unpack_from('<3Q', data, pos + 3 + 16))
+    new_appended_offsets = list(appended_offsets)
+    num_invalid = 0
+
+    while pos + ULOG_MSG_HEADER.size <= len(data):
+        for i, offset in enumerate(appended_offsets):
+            if offset == pos:
+                new_appended_offsets[i] = len(out)
+
+        msg_size, msg_type = ULOG_MSG_HEADER.unpack_from(data, pos)
+        message = data[pos:pos + ULOG_MSG_HEADER.size + msg_size]
+        pos += len(message)
+        if len(message) != ULOG_MSG_HEADER.size + msg_size:
+            print('Warning: truncated message at the end of the file', file=sys.stderr)
+            break
+
+        if msg_type == ord('D'):
+            msg_id = message[3] | (message[4] << 8)
+            references[msg_id] = bytearray(message[5:])
+
+        elif msg_type == ord('d'):
+            msg_id = message[3] | (message[4] << 8)
+            reference = references.get(msg_id)
+            if reference is None or not delta_decode(reference, message[5:]):
+                references.pop(msg_id, None)
+                num_invalid += 1
+                continue
+            message = ULOG_MSG_HEADER.pack(len(reference) + 2, ord('D')) + message[3:5] + reference
+
+        elif is_index_message(message):
+            continue
+
+        out += message
+
+    # clear the flag & update the offsets of appended data
+    flags_pos = ULOG_HEADER_SIZE + ULOG_MSG_HEADER.size
+    out[flags_pos + 8] &= ~INCOMPAT_FLAG0_DATA_DELTA_MASK & 0xff
+    struct.pack_into('<3Q', out, flags_pos + 16, *new_appended_offsets)
+
+    if num_invalid > 0:
+        print('Warning: dropped {:} invalid delta messages'.format(num_invalid), file=sys.stderr)
+
+    return out
+
+
+def is_index_message(message):
+    """ check if a message belongs to the log index (INFO 'ulog_index' or INFO_MULTIPLE 'ulog_index_*') """
+    msg_type = message[2]
+    if msg_type == ord('I'):
+        key_start = 4
+    elif msg_type == ord('M'):
+        key_start = 5
+    else:
+        return False
+    key_len = message[key_start - 1]
+    key = bytes(message[key_start:key_start + key_len])
+    return key.split(b' ')[-1] in (b'ulog_index', b'ulog_index_time', b'ulog_index_data',
+                                    b'ulog_index_additional')
+
+
+def delta_decode(reference, payload):
+    """ apply a DATA_DELTA payload in place, returns False if invalid """
+    bitmap_size = (len(reference) + 7) // 8
+    if len(payload) < bitmap_size:
+        return False
+
+    k = bitmap_size
+    for i in range(len(reference)):
+        if payload[i // 8] & (1 << (i & 7)):
+            if k >= len(payload):
+                return False
+            reference[i] ^= payload[k]
+            k += 1
+
+    return k == len(payload)
+
+
+def main():
+    parser = ArgumentParser(description=__doc__)
+    parser.add_argument('input', metavar='file.ulgz', help='compressed and/or delta encoded ULog file')
+    parser.add_argument('output', metavar='file.ulg', nargs='?', default=None,
+                        help='output ULog file (default: input with .ulg extension, or _expanded.ulg)')
+    args = parser.parse_args()
+
+    output = args.output
+    if output is None:
+        if args.input.endswith('.ulgz'):
+            output = args.input[:-1]
+        else:
+            output = args.input[:-4] + '_expanded.ulg' if args.input.endswith('.ulg') else args.input + '.ulg'
+
+    with open(args.input, 'rb') as f_in:
+        input_size = len(f_in.read())
+        f_in.seek(0)
+        if f_in.read(len(FILE_MAGIC)) == FILE_MAGIC:
+            f_in.seek(0)
+            decompressed = io.BytesIO()
+            decompress(f_in, decompressed)
+            data = bytearray(decompressed.getvalue())
+        else:
+            f_in.seek(0)
+            data = bytearray(f_in.read())
+
+    data = expand_delta(data)
+
+    with open(output, 'wb') as f_out:
+        f_out.write(data)
+
+    ratio = float(len(data)) / input_size if input_size > 0 else 0
+    print('{:}: {:} -> {:} bytes (ratio {:.2f})'.format(output, input_size, len(data), ratio))
+
+
+if __name__ == '__main__':
+    main()
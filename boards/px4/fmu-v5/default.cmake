@@ -110,6 +110,7 @@ px4_add_board(
 		tune_control
 		usb_connected
 		ver
+		work_queue
 
 	EXAMPLES
 		bottle_drop # OBC challenge
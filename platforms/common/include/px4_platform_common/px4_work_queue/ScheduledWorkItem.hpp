@@ -44,7 +44,8 @@ class ScheduledWorkItem : public WorkItem
 {
 public:
 
-	ScheduledWorkItem(const wq_config_t &config) : WorkItem(config) {}
+	ScheduledWorkItem(const wq_config_t &config, const char *name = PX4_WORK_ITEM_DEFAULT_NAME) :
+		WorkItem(config, name) {}
 	virtual ~ScheduledWorkItem() override;
 
 	/**
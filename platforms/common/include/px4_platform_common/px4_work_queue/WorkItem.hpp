@@ -38,17 +38,29 @@
 #include "WorkQueue.hpp"
 
 #include <containers/IntrusiveQueue.hpp>
+#include <containers/List.hpp>
 #include <px4_defines.h>
 #include <drivers/drv_hrt.h>
 
 namespace px4
 {
 
-class WorkItem : public IntrusiveQueueNode<WorkItem *>
+// work items are named after the module they are compiled into unless given a name
+#ifdef MODULE_NAME
+#define PX4_WORK_ITEM_DEFAULT_NAME MODULE_NAME
+#else
+#define PX4_WORK_ITEM_DEFAULT_NAME "unknown"
+#endif
+
+class WorkItem : public IntrusiveQueueNode<WorkItem *>, public ListNode<WorkItem *>
 {
 public:
 
-	explicit WorkItem(const wq_config_t &config);
+	/**
+	 * @param config The WorkQueue configuration (see WorkQueueManager.hpp).
+	 * @param name Name used for reporting, must be a string with static lifetime.
+	 */
+	explicit WorkItem(const wq_config_t &config, const char *name = PX4_WORK_ITEM_DEFAULT_NAME);
 	WorkItem() = delete;
 
 	virtual ~WorkItem();
@@ -57,6 +69,11 @@ public:
 
 	virtual void Run() = 0;
 
+	const char *ItemName() const { return _item_name; }
+
+	const wq_item_stats_t &run_stats() const { return _run_stats; }
+	void reset_run_stats() { _run_stats = wq_item_stats_t{}; }
+
 	/**
 	 * Switch to a different WorkQueue.
 	 * NOTE: Caller is responsible for synchronization.
@@ -81,8 +98,54 @@ protected:
 
 private:
 
+	friend class WorkQueue;
+
+	static unsigned hist_bucket(uint32_t us)
+	{
+		const unsigned bucket = (31 - __builtin_clz(us | 1)) / 2;
+		return bucket < WQ_ITEM_HIST_BUCKETS ? bucket : WQ_ITEM_HIST_BUCKETS - 1;
+	}
+
+	// called by the WorkQueue after each run
+	void record_run(hrt_abstime scheduled, hrt_abstime start, hrt_abstime end)
+	{
+		const uint32_t latency = (scheduled != 0 && start > scheduled) ? start - scheduled : 0;
+		const uint32_t run_time = end - start;
+
+		_run_stats.run_count++;
+		_run_stats.latency_sum_us += latency;
+		_run_stats.run_time_sum_us += run_time;
+
+		if (latency > _run_stats.latency_max_us) {
+			_run_stats.latency_max_us = latency;
+		}
+
+		if (run_time > _run_stats.run_time_max_us) {
+			_run_stats.run_time_max_us = run_time;
+		}
+
+		_run_stats.latency_hist[hist_bucket(latency)]++;
+		_run_stats.run_time_hist[hist_bucket(run_time)]++;
+	}
+
 	WorkQueue *_wq{nullptr};
 
+	const char *_item_name;
+
+	hrt_abstime _schedule_time{0}; // first ScheduleNow() since the last run, 0 if not scheduled
+	wq_item_stats_t _run_stats{};
+
+#ifdef PX4_WQ_WORKER_POOL
+
+	// scheduling state in a multi-threaded WorkQueue, ensures an item never runs concurrently with itself
+	static constexpr int POOL_QUEUED = 1; // in a worker queue
+	static constexpr int POOL_RUNNING = 2; // currently running on a worker
+	static constexpr int POOL_RESCHEDULE = 4; // scheduled again while running
+	static constexpr int POOL_WORKER_SHIFT = 3; // worker running the item in the upper bits (valid while POOL_RUNNING)
+
+	px4::atomic_int _pool_state{0};
+#endif /* PX4_WQ_WORKER_POOL */
+
 };
 
 } // namespace px4
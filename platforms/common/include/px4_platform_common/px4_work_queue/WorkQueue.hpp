@@ -35,6 +35,7 @@
 
 #include "WorkQueueManager.hpp"
 
+#include <containers/BlockingList.hpp>
 #include <containers/List.hpp>
 #include <containers/IntrusiveQueue.hpp>
 #include <px4_atomic.h>
@@ -57,6 +58,12 @@ public:
 
 	const char *get_name() { return _config.name; }
 
+	/**
+	 * Attach or detach a work item for reporting (see WorkItem::Init()).
+	 */
+	void Attach(WorkItem *item) { _items.add(item); }
+	void Detach(WorkItem *item) { _items.remove(item); }
+
 	void Add(WorkItem *item);
 	void Remove(WorkItem *item);
 
@@ -64,9 +71,13 @@ public:
 
 	void Run();
 
-	void request_stop() { _should_exit.store(true); }
+	void request_stop();
+
+	void print_status(bool verbose = false);
 
-	void print_status();
+	unsigned item_count() { return _items.size(); }
+	bool item_status(unsigned index, wq_item_status_t &status);
+	void reset_item_stats();
 
 private:
 
@@ -83,9 +94,44 @@ private:
 	px4_sem_t _qlock;
 #endif
 
+#ifdef PX4_WQ_WORKER_POOL
+	static constexpr unsigned MAX_THREADS = 8;
+
+	/**
+	 * Worker thread of a multi-threaded work queue. Each worker has its own queue
+	 * and steals from the other workers' queues when it runs out of work.
+	 * An item moves from a queue to the running slot under the locks of both workers.
+	 */
+	struct Worker {
+		IntrusiveQueue<WorkItem *> q;
+		px4_sem_t lock;
+		WorkQueue *wq;
+		WorkItem *running;
+		bool running_removed; // the running item was removed: it is not accessed anymore after Run()
+		unsigned index;
+	};
+
+	static void *WorkerThread(void *context);
+
+	void RunPool();
+	void RunWorker(unsigned index);
+	void RunWorkItem(unsigned index, WorkItem *item);
+
+	void PushWork(unsigned index, WorkItem *item);
+	WorkItem *PopWork(unsigned index);
+
+	Worker		*_workers{nullptr};
+	unsigned	_num_workers{1};
+	px4::atomic<unsigned>	_next_worker{0};
+#endif /* PX4_WQ_WORKER_POOL */
+
 	IntrusiveQueue<WorkItem *>	_q;
 	px4_sem_t		_process_lock;
 
+	WorkItem		*_running{nullptr}; // cleared if the item is removed while running
+
+	BlockingList<WorkItem *>	_items;
+
 	px4::atomic_bool	_should_exit{false};
 	const wq_config_t	&_config;
 
@@ -40,38 +40,67 @@ namespace px4
 
 class WorkQueue; // forward declaration
 
+// multi-threaded work queues (num_threads > 1) are only available on POSIX
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define PX4_WQ_WORKER_POOL
+#endif
+
 struct wq_config_t {
 	const char *name;
 	uint16_t stacksize;
 	int8_t relative_priority; // relative to max
+	uint8_t num_threads; // number of worker threads (work stealing pool if > 1, see PX4_WQ_WORKER_POOL)
 };
 
 namespace wq_configurations
 {
-static constexpr wq_config_t rate_ctrl{"wq:rate_ctrl", 1600, 0}; // PX4 inner loop highest priority
+static constexpr wq_config_t rate_ctrl{"wq:rate_ctrl", 1600, 0, 1}; // PX4 inner loop highest priority
 
-static constexpr wq_config_t SPI1{"wq:SPI1", 1400, -1};
-static constexpr wq_config_t SPI2{"wq:SPI2", 1400, -2};
-static constexpr wq_config_t SPI3{"wq:SPI3", 1400, -3};
-static constexpr wq_config_t SPI4{"wq:SPI4", 1400, -4};
-static constexpr wq_config_t SPI5{"wq:SPI5", 1400, -5};
-static constexpr wq_config_t SPI6{"wq:SPI6", 1400, -6};
+static constexpr wq_config_t SPI1{"wq:SPI1", 1400, -1, 1};
+static constexpr wq_config_t SPI2{"wq:SPI2", 1400, -2, 1};
+static constexpr wq_config_t SPI3{"wq:SPI3", 1400, -3, 1};
+static constexpr wq_config_t SPI4{"wq:SPI4", 1400, -4, 1};
+static constexpr wq_config_t SPI5{"wq:SPI5", 1400, -5, 1};
+static constexpr wq_config_t SPI6{"wq:SPI6", 1400, -6, 1};
 
-static constexpr wq_config_t I2C1{"wq:I2C1", 1250, -7};
-static constexpr wq_config_t I2C2{"wq:I2C2", 1250, -8};
-static constexpr wq_config_t I2C3{"wq:I2C3", 1250, -9};
-static constexpr wq_config_t I2C4{"wq:I2C4", 1250, -10};
+static constexpr wq_config_t I2C1{"wq:I2C1", 1250, -7, 1};
+static constexpr wq_config_t I2C2{"wq:I2C2", 1250, -8, 1};
+static constexpr wq_config_t I2C3{"wq:I2C3", 1250, -9, 1};
+static constexpr wq_config_t I2C4{"wq:I2C4", 1250, -10, 1};
 
-static constexpr wq_config_t att_pos_ctrl{"wq:att_pos_ctrl", 2000, -11}; // PX4 att/pos controllers, highest priority after sensors
+static constexpr wq_config_t att_pos_ctrl{"wq:att_pos_ctrl", 2000, -11, 1}; // PX4 att/pos controllers, highest priority after sensors
 
-static constexpr wq_config_t hp_default{"wq:hp_default", 1500, -12};
-static constexpr wq_config_t lp_default{"wq:lp_default", 1700, -50};
+static constexpr wq_config_t hp_default{"wq:hp_default", 1500, -12, 1};
+static constexpr wq_config_t lp_default{"wq:lp_default", 1700, -50, 1};
 
-static constexpr wq_config_t test1{"wq:test1", 800, 0};
-static constexpr wq_config_t test2{"wq:test2", 800, 0};
+static constexpr wq_config_t test1{"wq:test1", 800, 0, 1};
+static constexpr wq_config_t test2{"wq:test2", 800, 0, 1};
+static constexpr wq_config_t test_pool{"wq:test_pool", 800, 0, 4};
 
 } // namespace wq_configurations
 
+static constexpr unsigned WQ_ITEM_HIST_BUCKETS = 8;
+
+/**
+ * Run statistics of a single work item, accumulated by the work queue running it.
+ * Histogram bucket i counts durations in [4^i, 4^(i+1)) us, the last bucket is open ended.
+ */
+struct wq_item_stats_t {
+	uint32_t run_count;
+	uint32_t latency_max_us; // ScheduleNow() to Run()
+	uint32_t run_time_max_us;
+	uint64_t latency_sum_us;
+	uint64_t run_time_sum_us;
+	uint32_t latency_hist[WQ_ITEM_HIST_BUCKETS];
+	uint32_t run_time_hist[WQ_ITEM_HIST_BUCKETS];
+};
+
+struct wq_item_status_t {
+	const char *name;
+	const char *wq_name;
+	wq_item_stats_t stats;
+};
+
 /**
  * Start the work queue manager task.
  */
@@ -82,6 +111,27 @@ int WorkQueueManagerStart();
  */
 int WorkQueueManagerStop();
 
+/**
+ * Print the status of all work queues and the run statistics of their work items.
+ *
+ * @param verbose		Also print the latency and run time histograms.
+ */
+void WorkQueueManagerStatus(bool verbose = false);
+
+/**
+ * Reset the run statistics of all work items.
+ */
+void WorkQueueManagerResetStats();
+
+/**
+ * Get the run statistics of a work item.
+ *
+ * @param index		Index of the work item, counted across all work queues.
+ * @param status		Filled with the work item status on success.
+ * @return		false if there is no work item with this index.
+ */
+bool WorkQueueManagerItemStatus(unsigned index, wq_item_status_t &status);
+
 /**
  * Create (or find) a work queue with a particular configuration.
  *
@@ -42,7 +42,8 @@
 namespace px4
 {
 
-WorkItem::WorkItem(const wq_config_t &config)
+WorkItem::WorkItem(const wq_config_t &config, const char *name) :
+	_item_name(name)
 {
 	if (!Init(config)) {
 		PX4_ERR("init failed");
@@ -66,6 +67,7 @@ bool WorkItem::Init(const wq_config_t &config)
 
 	} else {
 		_wq = wq;
+		_wq->Attach(this);
 		return true;
 	}
 
@@ -81,6 +83,7 @@ void WorkItem::Deinit()
 		_wq = nullptr;
 
 		wq_temp->Remove(this);
+		wq_temp->Detach(this);
 	}
 }
 
@@ -36,9 +36,13 @@
 
 #include <string.h>
 
+#include <px4_posix.h>
 #include <px4_tasks.h>
 #include <px4_time.h>
 #include <drivers/drv_hrt.h>
+#include <lib/mathlib/mathlib.h>
+
+#include <limits.h>
 
 namespace px4
 {
@@ -59,6 +63,29 @@ WorkQueue::WorkQueue(const wq_config_t &config) :
 
 	px4_sem_init(&_process_lock, 0, 0);
 	px4_sem_setprotocol(&_process_lock, SEM_PRIO_NONE);
+
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_config.num_threads > 1) {
+		_num_workers = math::min((unsigned)_config.num_threads, MAX_THREADS);
+		_workers = new Worker[_num_workers];
+
+		if (_workers != nullptr) {
+			for (unsigned i = 0; i < _num_workers; i++) {
+				px4_sem_init(&_workers[i].lock, 0, 1);
+				_workers[i].wq = this;
+				_workers[i].running = nullptr;
+				_workers[i].running_removed = false;
+				_workers[i].index = i;
+			}
+
+		} else {
+			PX4_ERR("%s: worker allocation failed, using a single thread", _config.name);
+			_num_workers = 1;
+		}
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
 }
 
 WorkQueue::~WorkQueue()
@@ -70,13 +97,100 @@ WorkQueue::~WorkQueue()
 #ifndef __PX4_NUTTX
 	px4_sem_destroy(&_qlock);
 #endif /* __PX4_NUTTX */
+
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_workers != nullptr) {
+		for (unsigned i = 0; i < _num_workers; i++) {
+			px4_sem_destroy(&_workers[i].lock);
+		}
+
+		delete[] _workers;
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
+}
+
+void WorkQueue::request_stop()
+{
+	_should_exit.store(true);
+
+#ifdef PX4_WQ_WORKER_POOL
+
+	// wake up all workers so they can exit
+	for (unsigned i = 1; i < _num_workers; i++) {
+		px4_sem_post(&_process_lock);
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
+
+	px4_sem_post(&_process_lock);
 }
 
 void WorkQueue::Add(WorkItem *item)
 {
 	// TODO: prevent additions when shutting down
 
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_num_workers > 1) {
+		for (;;) {
+			int state = item->_pool_state.load();
+
+			if (state & WorkItem::POOL_QUEUED) {
+				// already queued, it will run
+				return;
+
+			} else if (state & WorkItem::POOL_RUNNING) {
+				// running on a worker, which will requeue it afterwards. The state only leaves this worker
+				// under its lock (end of the run), so it cannot change meanwhile if it still names the worker.
+				Worker &worker = _workers[state >> WorkItem::POOL_WORKER_SHIFT];
+				px4_sem_wait(&worker.lock);
+
+				if (item->_pool_state.load() != state) {
+					// the run ended before we got the lock, try again
+					px4_sem_post(&worker.lock);
+					continue;
+				}
+
+				if (worker.running == item) {
+					item->_pool_state.fetch_or(WorkItem::POOL_RESCHEDULE);
+					worker.running_removed = false;
+					px4_sem_post(&worker.lock);
+					return;
+				}
+
+				// removed while running and finished since, the worker left the state behind: queue it here
+				item->_schedule_time = hrt_absolute_time();
+				item->_pool_state.store(WorkItem::POOL_QUEUED);
+				worker.q.push(item);
+				px4_sem_post(&worker.lock);
+
+				px4_sem_post(&_process_lock);
+				return;
+
+			} else if (item->_pool_state.compare_exchange(&state, WorkItem::POOL_QUEUED)) {
+				item->_schedule_time = hrt_absolute_time();
+				PushWork(_next_worker.fetch_add(1) % _num_workers, item);
+
+				// Wake up a worker thread
+				px4_sem_post(&_process_lock);
+				return;
+			}
+		}
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
+
+	const hrt_abstime now = hrt_absolute_time();
+
 	work_lock();
+
+	// latency is measured from the first schedule request
+	if (item->_schedule_time == 0) {
+		item->_schedule_time = now;
+	}
+
 	_q.push(item);
 	work_unlock();
 
@@ -86,17 +200,70 @@ void WorkQueue::Add(WorkItem *item)
 
 void WorkQueue::Remove(WorkItem *item)
 {
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_num_workers > 1) {
+		// lock all workers (in index order, like PopWork()), so the item cannot move between them meanwhile
+		for (unsigned i = 0; i < _num_workers; i++) {
+			px4_sem_wait(&_workers[i].lock);
+		}
+
+		for (unsigned i = 0; i < _num_workers; i++) {
+			if (_workers[i].q.remove(item)) {
+				item->_pool_state.store(0);
+			}
+
+			if (_workers[i].running == item) {
+				// drop a pending reschedule, the worker does not access the item anymore after it ran
+				item->_pool_state.fetch_and(~WorkItem::POOL_RESCHEDULE);
+				_workers[i].running_removed = true;
+			}
+		}
+
+		for (unsigned i = 0; i < _num_workers; i++) {
+			px4_sem_post(&_workers[i].lock);
+		}
+
+		return;
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
+
 	work_lock();
 	_q.remove(item);
+	item->_schedule_time = 0;
+
+	if (_running == item) {
+		_running = nullptr;
+	}
+
 	work_unlock();
 }
 
 void WorkQueue::Clear()
 {
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_num_workers > 1) {
+		for (unsigned i = 0; i < _num_workers; i++) {
+			px4_sem_wait(&_workers[i].lock);
+
+			while (!_workers[i].q.empty()) {
+				_workers[i].q.pop()->_pool_state.store(0);
+			}
+
+			px4_sem_post(&_workers[i].lock);
+		}
+
+		return;
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
+
 	work_lock();
 
 	while (!_q.empty()) {
-		_q.pop();
+		_q.pop()->_schedule_time = 0;
 	}
 
 	work_unlock();
@@ -104,6 +271,15 @@ void WorkQueue::Clear()
 
 void WorkQueue::Run()
 {
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_num_workers > 1) {
+		RunPool();
+		return;
+	}
+
+#endif /* PX4_WQ_WORKER_POOL */
+
 	while (!should_exit()) {
 		px4_sem_wait(&_process_lock);
 
@@ -112,19 +288,266 @@ void WorkQueue::Run()
 		// process queued work
 		while (!_q.empty()) {
 			WorkItem *work = _q.pop();
+			const hrt_abstime scheduled = work->_schedule_time;
+			work->_schedule_time = 0;
+			_running = work;
 
 			work_unlock(); // unlock work queue to run (item may requeue itself)
+			const hrt_abstime start = hrt_absolute_time();
 			work->Run();
+			const hrt_abstime end = hrt_absolute_time();
 			work_lock(); // re-lock
+
+			// the item may have been removed (or deleted) while running
+			if (_running == work) {
+				work->record_run(scheduled, start, end);
+				_running = nullptr;
+			}
 		}
 
 		work_unlock();
 	}
 }
 
-void WorkQueue::print_status()
+#ifdef PX4_WQ_WORKER_POOL
+void *WorkQueue::WorkerThread(void *context)
+{
+	Worker *worker = static_cast<Worker *>(context);
+
+#ifdef __PX4_DARWIN
+	pthread_setname_np(worker->wq->get_name());
+#else
+	pthread_setname_np(pthread_self(), worker->wq->get_name());
+#endif
+
+	worker->wq->RunWorker(worker->index);
+
+	return nullptr;
+}
+
+void WorkQueue::RunPool()
 {
-	PX4_INFO("WorkQueue: %s running", get_name());
+	// this thread becomes worker 0, the others run with the same scheduling parameters
+	pthread_t threads[MAX_THREADS];
+	unsigned num_threads = 1;
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+
+	int policy = SCHED_FIFO;
+	sched_param param{};
+	pthread_getschedparam(pthread_self(), &policy, &param);
+
+	pthread_attr_setschedpolicy(&attr, policy);
+	pthread_attr_setschedparam(&attr, &param);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+
+	const size_t stacksize = math::max((size_t)PTHREAD_STACK_MIN, (size_t)PX4_STACK_ADJUSTED(_config.stacksize));
+	pthread_attr_setstacksize(&attr, stacksize);
+
+	for (unsigned i = 1; i < _num_workers; i++) {
+		int ret = pthread_create(&threads[num_threads], &attr, WorkerThread, &_workers[i]);
+
+		if (ret == 0) {
+			num_threads++;
+
+		} else {
+			// work queued to this worker is stolen by the others
+			PX4_ERR("%s: failed to create worker %u (%i)", get_name(), i, ret);
+		}
+	}
+
+	pthread_attr_destroy(&attr);
+
+	RunWorker(0);
+
+	for (unsigned i = 1; i < num_threads; i++) {
+		pthread_join(threads[i], nullptr);
+	}
+}
+
+void WorkQueue::RunWorker(unsigned index)
+{
+	while (!should_exit()) {
+		px4_sem_wait(&_process_lock);
+
+		// process own queued work first, then steal from the other workers
+		WorkItem *work;
+
+		while ((work = PopWork(index)) != nullptr) {
+			RunWorkItem(index, work);
+		}
+	}
+}
+
+void WorkQueue::RunWorkItem(unsigned index, WorkItem *item)
+{
+	Worker &worker = _workers[index];
+
+	// PopWork() marked the item as running on this worker
+	const hrt_abstime scheduled = item->_schedule_time;
+	const hrt_abstime start = hrt_absolute_time();
+	item->Run();
+	const hrt_abstime end = hrt_absolute_time();
+
+	bool requeued = false;
+
+	px4_sem_wait(&worker.lock);
+
+	// the item may have been removed (and deleted) while running
+	if (!worker.running_removed) {
+		item->record_run(scheduled, start, end);
+
+		int state = WorkItem::POOL_RUNNING | (index << WorkItem::POOL_WORKER_SHIFT);
+
+		if (!item->_pool_state.compare_exchange(&state, 0)) {
+			// scheduled again while running: requeue it now that it finished
+			item->_schedule_time = end;
+			item->_pool_state.store(WorkItem::POOL_QUEUED);
+			worker.q.push(item);
+			requeued = true;
+		}
+	}
+
+	worker.running = nullptr;
+	worker.running_removed = false;
+	px4_sem_post(&worker.lock);
+
+	if (requeued) {
+		px4_sem_post(&_process_lock);
+	}
+}
+
+void WorkQueue::PushWork(unsigned index, WorkItem *item)
+{
+	Worker &worker = _workers[index];
+
+	px4_sem_wait(&worker.lock);
+	worker.q.push(item);
+	px4_sem_post(&worker.lock);
+}
+
+WorkItem *WorkQueue::PopWork(unsigned index)
+{
+	Worker &worker = _workers[index];
+
+	for (unsigned i = 0; i < _num_workers; i++) {
+		Worker &victim = _workers[(index + i) % _num_workers];
+
+		// the item becomes visible as running at the same time as it leaves the queue, so Remove() always finds
+		// it. Locks are taken in index order.
+		Worker &first = (victim.index < index) ? victim : worker;
+		Worker &second = (victim.index < index) ? worker : victim;
+
+		px4_sem_wait(&first.lock);
+
+		if (&second != &first) {
+			px4_sem_wait(&second.lock);
+		}
+
+		WorkItem *item = victim.q.pop();
+
+		if (item != nullptr) {
+			// only this worker can be here for the item: it was queued exactly once
+			item->_pool_state.store(WorkItem::POOL_RUNNING | (index << WorkItem::POOL_WORKER_SHIFT));
+			worker.running = item;
+			worker.running_removed = false;
+		}
+
+		if (&second != &first) {
+			px4_sem_post(&second.lock);
+		}
+
+		px4_sem_post(&first.lock);
+
+		if (item != nullptr) {
+			return item;
+		}
+	}
+
+	return nullptr;
+}
+#endif /* PX4_WQ_WORKER_POOL */
+
+static void print_histogram(const char *label, const uint32_t (&hist)[WQ_ITEM_HIST_BUCKETS])
+{
+	PX4_INFO_RAW("       %-8s", label);
+
+	for (unsigned i = 0; i < WQ_ITEM_HIST_BUCKETS; i++) {
+		PX4_INFO_RAW(" %8u", (unsigned)hist[i]);
+	}
+
+	PX4_INFO_RAW("\n");
+}
+
+void WorkQueue::print_status(bool verbose)
+{
+#ifdef PX4_WQ_WORKER_POOL
+
+	if (_num_workers > 1) {
+		PX4_INFO("WorkQueue: %s running (%u threads)", get_name(), _num_workers);
+
+	} else
+#endif /* PX4_WQ_WORKER_POOL */
+	{
+		PX4_INFO("WorkQueue: %s running", get_name());
+	}
+
+	auto lg = _items.getLockGuard();
+
+	if (_items.empty()) {
+		return;
+	}
+
+	PX4_INFO_RAW("  %-24s %10s %10s %10s %10s %10s\n", "item", "runs", "lat avg", "lat max", "run avg", "run max");
+
+	for (WorkItem *item : _items) {
+		// statistics are read without locking, they may be slightly inconsistent
+		const wq_item_stats_t stats = item->run_stats();
+		const uint32_t runs = math::max(stats.run_count, (uint32_t)1);
+
+		PX4_INFO_RAW("  %-24s %10u %7u us %7u us %7u us %7u us\n", item->ItemName(), (unsigned)stats.run_count,
+			     (unsigned)(stats.latency_sum_us / runs), (unsigned)stats.latency_max_us,
+			     (unsigned)(stats.run_time_sum_us / runs), (unsigned)stats.run_time_max_us);
+
+		if (verbose) {
+			PX4_INFO_RAW("       %-8s", "us <");
+
+			for (unsigned i = 0; i < WQ_ITEM_HIST_BUCKETS - 1; i++) {
+				PX4_INFO_RAW(" %8u", 1u << (2 * (i + 1)));
+			}
+
+			PX4_INFO_RAW(" %8s\n", "inf");
+
+			print_histogram("latency", stats.latency_hist);
+			print_histogram("run", stats.run_time_hist);
+		}
+	}
+}
+
+bool WorkQueue::item_status(unsigned index, wq_item_status_t &status)
+{
+	auto lg = _items.getLockGuard();
+
+	for (WorkItem *item : _items) {
+		if (index-- == 0) {
+			status.name = item->ItemName();
+			status.wq_name = get_name();
+			status.stats = item->run_stats();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkQueue::reset_item_stats()
+{
+	auto lg = _items.getLockGuard();
+
+	for (WorkItem *item : _items) {
+		item->reset_run_stats();
+	}
 }
 
 } // namespace px4
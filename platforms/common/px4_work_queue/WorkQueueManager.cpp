@@ -116,6 +116,54 @@ WorkQueue *WorkQueueFindOrCreate(const wq_config_t &new_wq)
 	return wq;
 }
 
+void WorkQueueManagerStatus(bool verbose)
+{
+	if (_wq_manager_wqs_list == nullptr) {
+		PX4_INFO("not running");
+		return;
+	}
+
+	auto lg = _wq_manager_wqs_list->getLockGuard();
+
+	for (WorkQueue *wq : *_wq_manager_wqs_list) {
+		wq->print_status(verbose);
+	}
+}
+
+void WorkQueueManagerResetStats()
+{
+	if (_wq_manager_wqs_list == nullptr) {
+		return;
+	}
+
+	auto lg = _wq_manager_wqs_list->getLockGuard();
+
+	for (WorkQueue *wq : *_wq_manager_wqs_list) {
+		wq->reset_item_stats();
+	}
+}
+
+bool WorkQueueManagerItemStatus(unsigned index, wq_item_status_t &status)
+{
+	if (_wq_manager_wqs_list == nullptr) {
+		return false;
+	}
+
+	auto lg = _wq_manager_wqs_list->getLockGuard();
+
+	for (WorkQueue *wq : *_wq_manager_wqs_list) {
+		const unsigned count = wq->item_count();
+
+		if (index < count) {
+			return wq->item_status(index, status);
+		}
+
+		index -= count;
+	}
+
+	return false;
+}
+
 const wq_config_t &device_bus_to_wq(uint32_t device_id_int)
 {
 	union device::Device::DeviceId device_id;
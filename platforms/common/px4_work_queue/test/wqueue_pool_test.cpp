@@ -0,0 +1,189 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "wqueue_pool_test.h"
+
+#include <drivers/drv_hrt.h>
+#include <px4_log.h>
+#include <px4_time.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+using namespace px4;
+
+AppState WQueuePoolTest::appState;
+
+void WQueuePoolTest::Item::Run()
+{
+	if (running.fetch_add(1) != 0) {
+		test->concurrent_runs.fetch_add(1);
+	}
+
+	// some work, long enough for other workers to try to run the item again
+	volatile unsigned sum = 0;
+
+	for (unsigned i = 0; i < 1000; i++) {
+		sum += i;
+	}
+
+	runs++;
+	test->total_runs.fetch_add(1);
+
+	if (runs == RUNS_PER_ITEM) {
+		test->items_done.fetch_add(1);
+	}
+
+	if (runs < RUNS_PER_ITEM) {
+		// reschedule ourselves (while running) and a neighbor (possibly running on another worker)
+		ScheduleNow();
+		neighbor->ScheduleNow();
+	}
+
+	running.fetch_sub(1);
+}
+
+void WQueuePoolTest::SelfDeletingItem::Run()
+{
+	// scheduled again while running, then deleted: the worker must neither requeue nor access it
+	ScheduleNow();
+
+	if (++runs == RUNS_PER_ITEM / 10) {
+		test->items_deleted.fetch_add(1);
+		delete this;
+	}
+}
+
+void WQueuePoolTest::RemovingItem::Run()
+{
+	if (running.fetch_add(1) != 0) {
+		test->concurrent_runs.fetch_add(1);
+	}
+
+	volatile unsigned sum = 0;
+
+	for (unsigned i = 0; i < 1000; i++) {
+		sum += i;
+	}
+
+	// removed while running: the worker leaves the item alone, and it has to be scheduled again from scratch
+	if (++runs % 4 == 0) {
+		px4::WorkQueueFindOrCreate(px4::wq_configurations::test_pool)->Remove(this);
+	}
+
+	test->removing_runs.fetch_add(1);
+	running.fetch_sub(1);
+}
+
+void *WQueuePoolTest::scheduler_thread(void *context)
+{
+	WQueuePoolTest *test = static_cast<WQueuePoolTest *>(context);
+
+	for (int i = 0; !appState.exitRequested() && (test->removing_runs.load() < SCHEDULER_RUNS); i++) {
+		test->_removing_items[i % NUM_ITEMS].ScheduleNow();
+	}
+
+	return nullptr;
+}
+
+int WQueuePoolTest::main()
+{
+	appState.setRunning(true);
+
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		_items[i].test = this;
+		_items[i].neighbor = &_items[(i + 1) % NUM_ITEMS];
+	}
+
+	const hrt_abstime start = hrt_absolute_time();
+
+	// Put work in the work queue
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		_items[i].ScheduleNow();
+	}
+
+	// Wait for work to finish
+	while (!appState.exitRequested() && (items_done.load() < NUM_ITEMS)) {
+		px4_usleep(5000);
+	}
+
+	const hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+	const int runs = total_runs.load();
+
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		SelfDeletingItem *item = new SelfDeletingItem();
+		item->test = this;
+		item->ScheduleNow();
+	}
+
+	while (!appState.exitRequested() && (items_deleted.load() < NUM_ITEMS)) {
+		px4_usleep(5000);
+	}
+
+	// schedule from several threads at once, while the items remove themselves
+	for (int i = 0; i < NUM_ITEMS; i++) {
+		_removing_items[i].test = this;
+	}
+
+	pthread_t schedulers[NUM_SCHEDULERS];
+	int num_schedulers = 0;
+
+	for (int i = 0; i < NUM_SCHEDULERS; i++) {
+		if (pthread_create(&schedulers[num_schedulers], nullptr, scheduler_thread, this) == 0) {
+			num_schedulers++;
+		}
+	}
+
+	for (int i = 0; i < num_schedulers; i++) {
+		pthread_join(schedulers[i], nullptr);
+	}
+
+	PX4_INFO("WQueuePoolTest: %d runs in %.3f s (%.0f runs/s), %d runs scheduled from %d threads, %d concurrent runs of the same item",
+		 runs, (double)elapsed * 1e-6, runs / ((double)elapsed * 1e-6), removing_runs.load(), num_schedulers,
+		 concurrent_runs.load());
+
+	if (concurrent_runs.load() != 0) {
+		PX4_ERR("WQueuePoolTest FAILED");
+
+	} else {
+		PX4_INFO("WQueuePoolTest finished");
+	}
+
+	px4_sleep(2);
+
+	return concurrent_runs.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <px4_app.h>
+#include <px4_atomic.h>
+#include <px4_platform_common/px4_work_queue/WorkItem.hpp>
+#include <string.h>
+
+using namespace px4;
+
+/**
+ * Stress test for multi-threaded work queues: a set of items keep rescheduling
+ * themselves and each other, and check that no item ever runs concurrently with itself.
+ * Then items delete themselves while running and rescheduled, which must not be accessed anymore.
+ * Finally several threads schedule items that remove themselves from the queue while running.
+ */
+class WQueuePoolTest
+{
+public:
+	WQueuePoolTest() = default;
+	~WQueuePoolTest() = default;
+
+	int main();
+
+	static px4::AppState appState; /* track requests to terminate app */
+
+	static constexpr int NUM_ITEMS = 16;
+	static constexpr int RUNS_PER_ITEM = 5000;
+	static constexpr int NUM_SCHEDULERS = 4;
+	static constexpr int SCHEDULER_RUNS = 50000;
+
+	class Item : public px4::WorkItem
+	{
+	public:
+		Item() : px4::WorkItem(px4::wq_configurations::test_pool) {}
+		~Item() = default;
+
+		void Run() override;
+
+		WQueuePoolTest *test{nullptr};
+		Item *neighbor{nullptr};
+		px4::atomic_int running{0};
+		int runs{0};
+	};
+
+	class SelfDeletingItem : public px4::WorkItem
+	{
+	public:
+		SelfDeletingItem() : px4::WorkItem(px4::wq_configurations::test_pool) {}
+		~SelfDeletingItem() = default;
+
+		void Run() override;
+
+		WQueuePoolTest *test{nullptr};
+		int runs{0};
+	};
+
+	class RemovingItem : public px4::WorkItem
+	{
+	public:
+		RemovingItem() : px4::WorkItem(px4::wq_configurations::test_pool) {}
+		~RemovingItem() = default;
+
+		void Run() override;
+
+		WQueuePoolTest *test{nullptr};
+		px4::atomic_int running{0};
+		int runs{0};
+	};
+
+	static void *scheduler_thread(void *context);
+
+	px4::atomic_int concurrent_runs{0};
+	px4::atomic_int items_done{0};
+	px4::atomic_int total_runs{0};
+	px4::atomic_int items_deleted{0};
+	px4::atomic_int removing_runs{0};
+
+private:
+	Item _items[NUM_ITEMS];
+	RemovingItem _removing_items[NUM_ITEMS];
+};
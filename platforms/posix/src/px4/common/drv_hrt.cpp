@@ -47,6 +47,7 @@
 #include <time.h>
 #include <string.h>
 #include <errno.h>
+#include <stdlib.h>
 #include "hrt_work.h"
 
 #if defined(ENABLE_LOCKSTEP_SCHEDULER)
@@ -57,7 +58,15 @@
 static constexpr unsigned HRT_INTERVAL_MIN = 50;
 static constexpr unsigned HRT_INTERVAL_MAX = 50000000;
 
-static struct sq_queue_s	callout_queue;
+// Callouts are kept in a binary min-heap ordered by deadline, so that entering
+// and cancelling a callout is O(log n). The position of an entry in the heap
+// is stored in its (otherwise unused) link pointer.
+static constexpr unsigned CALLOUT_HEAP_INITIAL_SIZE = 128;
+
+static struct hrt_call	**callout_heap = nullptr;
+static unsigned		callout_heap_size = 0;
+static unsigned		callout_heap_capacity = 0;
+
 static px4_sem_t 	_hrt_lock;
 static struct work_s	_hrt_work;
 
@@ -224,6 +233,120 @@ hrt_abstime hrt_store_absolute_time(volatile hrt_abstime *now)
 }
 
 
+static unsigned callout_heap_index(struct hrt_call *entry)
+{
+	return (unsigned)(uintptr_t)entry->link.flink;
+}
+
+static void callout_heap_set(unsigned index, struct hrt_call *entry)
+{
+	callout_heap[index] = entry;
+	entry->link.flink = (struct sq_entry_s *)(uintptr_t)index;
+}
+
+/*
+ * Check if the entry is queued. This is safe for an uninitialised entry, its
+ * link is only trusted if the heap slot it points to refers back to the entry.
+ */
+static bool callout_heap_contains(struct hrt_call *entry)
+{
+	const unsigned index = callout_heap_index(entry);
+	return (index < callout_heap_size) && (callout_heap[index] == entry);
+}
+
+static void callout_heap_sift_up(unsigned index)
+{
+	struct hrt_call *entry = callout_heap[index];
+
+	while (index > 0) {
+		const unsigned parent = (index - 1) / 2;
+
+		if (callout_heap[parent]->deadline <= entry->deadline) {
+			break;
+		}
+
+		callout_heap_set(index, callout_heap[parent]);
+		index = parent;
+	}
+
+	callout_heap_set(index, entry);
+}
+
+static void callout_heap_sift_down(unsigned index)
+{
+	struct hrt_call *entry = callout_heap[index];
+
+	while (true) {
+		unsigned child = 2 * index + 1;
+
+		if (child >= callout_heap_size) {
+			break;
+		}
+
+		if ((child + 1 < callout_heap_size) && (callout_heap[child + 1]->deadline < callout_heap[child]->deadline)) {
+			child++;
+		}
+
+		if (entry->deadline <= callout_heap[child]->deadline) {
+			break;
+		}
+
+		callout_heap_set(index, callout_heap[child]);
+		index = child;
+	}
+
+	callout_heap_set(index, entry);
+}
+
+static bool callout_heap_insert(struct hrt_call *entry)
+{
+	if (callout_heap_size == callout_heap_capacity) {
+		const unsigned capacity = (callout_heap_capacity == 0) ? CALLOUT_HEAP_INITIAL_SIZE : 2 * callout_heap_capacity;
+		struct hrt_call **heap = (struct hrt_call **)realloc(callout_heap, capacity * sizeof(struct hrt_call *));
+
+		if (heap == nullptr) {
+			PX4_ERR("callout heap allocation failed (%u entries)", capacity);
+			return false;
+		}
+
+		callout_heap = heap;
+		callout_heap_capacity = capacity;
+	}
+
+	callout_heap[callout_heap_size] = entry;
+	callout_heap_sift_up(callout_heap_size++);
+	return true;
+}
+
+static void callout_heap_remove(struct hrt_call *entry)
+{
+	if (!callout_heap_contains(entry)) {
+		return;
+	}
+
+	const unsigned index = callout_heap_index(entry);
+	struct hrt_call *last = callout_heap[--callout_heap_size];
+
+	if (last != entry) {
+		// move the last entry into the hole and restore the heap order
+		callout_heap_set(index, last);
+
+		if ((index > 0) && (last->deadline < callout_heap[(index - 1) / 2]->deadline)) {
+			callout_heap_sift_up(index);
+
+		} else {
+			callout_heap_sift_down(index);
+		}
+	}
+
+	entry->link.flink = nullptr;
+}
+
+static struct hrt_call *callout_heap_peek()
+{
+	return (callout_heap_size > 0) ? callout_heap[0] : nullptr;
+}
+
 /*
  * If this returns true, the entry has been invoked and removed from the callout list,
  * or it has never been entered.
@@ -241,7 +364,7 @@ bool	hrt_called(struct hrt_call *entry)
 void	hrt_cancel(struct hrt_call *entry)
 {
 	hrt_lock();
-	sq_rem(&entry->link, &callout_queue);
+	callout_heap_remove(entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -277,8 +400,6 @@ void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay)
  */
 void	hrt_init()
 {
-	sq_init(&callout_queue);
-
 	int sem_ret = px4_sem_init(&_hrt_lock, 0, 1);
 
 	if (sem_ret) {
@@ -291,30 +412,18 @@ void	hrt_init()
 static void
 hrt_call_enter(struct hrt_call *entry)
 {
-	struct hrt_call	*call, *next;
+	// a periodic callout may have re-entered itself from its callback
+	callout_heap_remove(entry);
 
-	//PX4_INFO("hrt_call_enter");
-	call = (struct hrt_call *)sq_peek(&callout_queue);
+	if (!callout_heap_insert(entry)) {
+		entry->deadline = 0;
+		return;
+	}
 
-	if ((call == nullptr) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		//if (call != nullptr) PX4_INFO("call enter at head, reschedule (%lu %lu)", entry->deadline, call->deadline);
+	if (callout_heap_peek() == entry) {
 		/* we changed the next deadline, reschedule the timer event */
 		hrt_call_reschedule();
-
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
-
-			if ((next == nullptr) || (entry->deadline < next->deadline)) {
-				//lldbg("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != nullptr);
 	}
-
-	//PX4_INFO("scheduled");
 }
 
 /**
@@ -348,7 +457,7 @@ hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
 	hrt_abstime	delay = HRT_INTERVAL_MAX;
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = callout_heap_peek();
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 
 	//PX4_INFO("hrt_call_reschedule");
@@ -396,14 +505,12 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 	//PX4_INFO("hrt_call_internal after lock");
 	/* if the entry is currently queued, remove it */
 	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
+	   entry->link here, but it is safe as the heap index it
+	   holds is only used if the heap slot refers back to the
+	   entry.
 	*/
 	if (entry->deadline != 0) {
-		sq_rem(&entry->link, &callout_queue);
+		callout_heap_remove(entry);
 	}
 
 #if 1
@@ -480,7 +587,7 @@ hrt_call_invoke()
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = callout_heap_peek();
 
 		if (call == nullptr) {
 			break;
@@ -490,7 +597,7 @@ hrt_call_invoke()
 			break;
 		}
 
-		sq_rem(&call->link, &callout_queue);
+		callout_heap_remove(call);
 		//PX4_INFO("call pop");
 
 		/* save the intended deadline for periodic calls */
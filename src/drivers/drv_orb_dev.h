@@ -76,4 +76,7 @@
 /** Check whether the topic is published, sets *(unsigned long *)arg to 1 if published, 0 otherwise */
 #define ORBIOCISPUBLISHED	_ORBIOC(17)
 
+/** Enable in-place publication (loans) for the topic, must be set before the first publication */
+#define ORBIOCSETLOANABLE	_ORBIOC(18)
+
 #endif /* _DRV_UORB_H */
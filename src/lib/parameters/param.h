@@ -242,6 +242,25 @@ __EXPORT size_t		param_size(param_t param);
  */
 __EXPORT int		param_get(param_t param, void *val);
 
+/**
+ * Get the parameter change sequence.
+ *
+ * The sequence is incremented whenever a parameter value changes. Together with param_changed_since() it
+ * allows a module to determine which of its parameters changed since it last read them.
+ *
+ * @return		The current change sequence.
+ */
+__EXPORT uint32_t	param_change_seq(void);
+
+/**
+ * Check if a parameter value changed after a given change sequence.
+ *
+ * @param param		A handle returned by param_find or passed by param_foreach.
+ * @param seq		A change sequence previously returned by param_change_seq().
+ * @return		true if the parameter changed since seq (or if this cannot be determined), false otherwise.
+ */
+__EXPORT bool		param_changed_since(param_t param, uint32_t seq);
+
 /**
  * Set the value of a parameter.
  *
@@ -373,18 +392,26 @@ __EXPORT int 		param_set_default_file(const char *filename);
  */
 __EXPORT const char	*param_get_default_file(void);
 
+/**
+ * Suffix of the journal file of the default parameter file (see param_save_default()).
+ */
+#define PARAM_JOURNAL_SUFFIX	".journal"
+
 /**
  * Save parameters to the default file.
  * Note: this method requires a large amount of stack size!
  *
  * This function saves all parameters with non-default values.
+ * If the default file is on a file system, only the parameters changed since the last save are appended to
+ * a journal next to it (PARAM_JOURNAL_SUFFIX). The journal is compacted into the default file once it gets
+ * too large, or after a parameter reset.
  *
  * @return		Zero on success.
  */
 __EXPORT int 		param_save_default(void);
 
 /**
- * Load parameters from the default parameter file.
+ * Load parameters from the default parameter file, and apply its journal.
  *
  * @return		Zero on success.
  */
@@ -51,6 +51,7 @@
 
 #include <drivers/drv_hrt.h>
 #include <lib/perf/perf_counter.h>
+#include <px4_atomic.h>
 #include <px4_config.h>
 #include <px4_defines.h>
 #include <px4_posix.h>
@@ -58,6 +59,8 @@
 #include <px4_shutdown.h>
 #include <systemlib/uthash/utarray.h>
 
+#include <sys/stat.h>
+
 using namespace time_literals;
 
 //#define PARAM_NO_ORB ///< if defined, avoid uorb dependency. This disables publication of parameter_update on param change
@@ -88,6 +91,27 @@ static char *param_user_file = nullptr;
 #define PARAM_CLOSE	close
 #endif
 
+/*
+ * Parameter journal: a save appends the parameters changed since the last save to the journal file next to the
+ * parameter file (PARAM_JOURNAL_SUFFIX), as one BSON document per save. The next save after the journal grew beyond
+ * PARAM_JOURNAL_COMPACT_SIZE, or after a change the journal cannot represent (parameter reset), compacts it: the full
+ * parameter file is written and the journal truncated. On load the journal is applied on top of the parameter file.
+ * The parameter file and the journal are tagged with a generation (PARAM_JOURNAL_GENERATION), which compaction
+ * increments: a journal that does not match the file (e.g. power loss before it was truncated) is ignored.
+ * Changes are selected with the per-parameter change sequence (not the unsaved flag, which param_export() clears when
+ * exporting to another file). The journal state is protected by param_sem_save.
+ */
+static constexpr int PARAM_JOURNAL_COMPACT_SIZE = 4096; ///< [bytes]
+static char *param_journal_file = nullptr; ///< journal of the current parameter file (see param_get_journal_file())
+static bool param_journal_valid = false; ///< parameter file + journal hold all saved values & the journal can be appended
+static int param_journal_size = 0; ///< [bytes]
+static unsigned param_journal_compactions = 0;
+static uint32_t param_journal_resets = 0; ///< value of param_reset_counter when the journal was started
+static uint32_t param_journal_seq = 0; ///< param_change_seq() up to which all changes are in the file + journal
+static int32_t param_journal_generation = 0; ///< generation of the parameter file (0 if it has none)
+static constexpr char PARAM_JOURNAL_GENERATION[] = "_journal_gen"; ///< BSON element of the generation (not a parameter)
+static px4::atomic<uint32_t> param_reset_counter{0}; ///< incremented on every parameter reset
+
 #ifndef PARAM_NO_AUTOSAVE
 #include <px4_workqueue.h>
 /* autosaving variables */
@@ -144,6 +168,22 @@ UT_array *param_values{nullptr};
 /** array info for the modified parameters array */
 const UT_icd param_icd = {sizeof(param_wbuf_s), nullptr, nullptr, nullptr};
 
+/**
+ * Current value (changed or default) of all int32 and float parameters, indexed by param_t.
+ * param_get() reads it without taking a lock: each value is a single word, which the writers update atomically
+ * (with the writer lock held). The table is published once by param_init(), and it is nullptr before that or if the
+ * allocation failed. Struct parameters are not in the table, they always use the locked path.
+ */
+static px4::atomic<px4::atomic_int32_t *> param_value_table{nullptr};
+
+/**
+ * Change sequence of the parameter values, incremented on every value change (see param_change_seq()).
+ * param_change_table holds the sequence of the last change of each parameter (0 if it did not change since boot),
+ * indexed by param_t. Both are written with the writer lock held and read without locking.
+ */
+static px4::atomic<uint32_t> param_change_counter{0};
+static px4::atomic<px4::atomic<uint32_t> *> param_change_table{nullptr};
+
 #if !defined(PARAM_NO_ORB)
 /** parameter update topic handle */
 static orb_advert_t param_topic = nullptr;
@@ -152,6 +192,8 @@ static unsigned int param_instance = 0;
 
 static void param_set_used_internal(param_t param);
 
+static void param_value_table_init();
+
 static param_t param_find_internal(const char *name, bool notification);
 
 // the following implements an RW-lock using 2 semaphores (used as mutexes). It gives
@@ -235,6 +277,8 @@ param_init()
 	param_find_perf = perf_alloc(PC_ELAPSED, "param_find");
 	param_get_perf = perf_alloc(PC_ELAPSED, "param_get");
 	param_set_perf = perf_alloc(PC_ELAPSED, "param_set");
+
+	param_value_table_init();
 }
 
 /**
@@ -295,6 +339,70 @@ param_find_changed(param_t param)
 	return s;
 }
 
+/** store the current value of an int32 or float parameter in the value table (requires the writer lock) */
+static void
+param_value_table_update(param_t param, const union param_value_u *value)
+{
+	px4::atomic_int32_t *table = param_value_table.load();
+
+	if (table != nullptr) {
+		int32_t word;
+		memcpy(&word, value, sizeof(word));
+		table[param].store(word);
+	}
+}
+
+/** record a value change of a parameter (requires the writer lock) */
+static void
+param_mark_changed(param_t param)
+{
+	px4::atomic<uint32_t> *table = param_change_table.load();
+	const uint32_t seq = param_change_counter.load() + 1;
+
+	// store the parameter sequence first: whoever sees the new global sequence also sees the parameter as changed
+	if (table != nullptr) {
+		table[param].store(seq);
+	}
+
+	param_change_counter.store(seq);
+}
+
+/** allocate & publish the value and change tables, initialized to the current values */
+static void
+param_value_table_init()
+{
+	const unsigned count = get_param_info_count();
+
+	if (count == 0) {
+		return;
+	}
+
+	px4::atomic_int32_t *table = (px4::atomic_int32_t *)malloc(count * sizeof(px4::atomic_int32_t));
+	px4::atomic<uint32_t> *change_table = (px4::atomic<uint32_t> *)calloc(count, sizeof(px4::atomic<uint32_t>));
+
+	if (table == nullptr || change_table == nullptr) {
+		PX4_ERR("failed to allocate parameter value table");
+		free(table);
+		free(change_table);
+		return;
+	}
+
+	param_lock_writer();
+
+	for (param_t param = 0; param < count; param++) {
+		const param_wbuf_s *s = param_find_changed(param);
+		int32_t word;
+		memcpy(&word, s ? &s->val : &param_info_base[param].val, sizeof(word));
+		table[param].store(word);
+	}
+
+	// from now on the writers update them
+	param_value_table.store(table);
+	param_change_table.store(change_table);
+
+	param_unlock_writer();
+}
+
 static void
 _param_notify_changes()
 {
@@ -588,6 +696,17 @@ param_get(param_t param, void *val)
 {
 	int result = -1;
 
+	// fast path: int32 and float parameters are read from the value table without locking
+	px4::atomic_int32_t *table = param_value_table.load();
+
+	if (table != nullptr && val && handle_in_range(param) &&
+	    (param_type(param) == PARAM_TYPE_INT32 || param_type(param) == PARAM_TYPE_FLOAT)) {
+
+		const int32_t word = table[param].load();
+		memcpy(val, &word, sizeof(word));
+		return 0;
+	}
+
 	param_lock_reader();
 	perf_begin(param_get_perf);
 
@@ -604,6 +723,25 @@ param_get(param_t param, void *val)
 	return result;
 }
 
+uint32_t
+param_change_seq()
+{
+	return param_change_counter.load();
+}
+
+bool
+param_changed_since(param_t param, uint32_t seq)
+{
+	px4::atomic<uint32_t> *table = param_change_table.load();
+
+	if (table == nullptr || !handle_in_range(param)) {
+		return true;
+	}
+
+	// wrap-around safe comparison
+	return (int32_t)(table[param].load() - seq) > 0;
+}
+
 #ifndef PARAM_NO_AUTOSAVE
 /**
  * worker callback method to save the parameters
@@ -726,11 +864,13 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 		case PARAM_TYPE_INT32:
 			params_changed = params_changed || s->val.i != *(int32_t *)val;
 			s->val.i = *(int32_t *)val;
+			param_value_table_update(param, &s->val);
 			break;
 
 		case PARAM_TYPE_FLOAT:
 			params_changed = params_changed || fabsf(s->val.f - * (float *)val) > FLT_EPSILON;
 			s->val.f = *(float *)val;
+			param_value_table_update(param, &s->val);
 			break;
 
 		case PARAM_TYPE_STRUCT ... PARAM_TYPE_STRUCT_MAX:
@@ -758,6 +898,10 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 			goto out;
 		}
 
+		if (params_changed) {
+			param_mark_changed(param);
+		}
+
 		s->unsaved = !mark_saved;
 		result = 0;
 
@@ -853,6 +997,9 @@ param_reset(param_t param)
 		if (s != nullptr) {
 			int pos = utarray_eltidx(param_values, s);
 			utarray_erase(param_values, pos, 1);
+			param_value_table_update(param, &param_info_base[param].val);
+			param_mark_changed(param);
+			param_reset_counter.fetch_add(1);
 		}
 
 		param_found = true;
@@ -874,11 +1021,19 @@ param_reset_all_internal(bool auto_save)
 	param_lock_writer();
 
 	if (param_values != nullptr) {
+		param_wbuf_s *s = nullptr;
+
+		while ((s = (param_wbuf_s *)utarray_next(param_values, s)) != nullptr) {
+			param_value_table_update(s->param, &param_info_base[s->param].val);
+			param_mark_changed(s->param);
+		}
+
 		utarray_free(param_values);
 	}
 
 	/* mark as reset / deleted */
 	param_values = nullptr;
+	param_reset_counter.fetch_add(1);
 
 	if (auto_save) {
 		param_autosave();
@@ -942,6 +1097,14 @@ param_set_default_file(const char *filename)
 		param_user_file = strdup(filename);
 	}
 
+	// the journal belongs to the previous file
+	if (param_journal_file != nullptr) {
+		free(param_journal_file);
+		param_journal_file = nullptr;
+	}
+
+	param_journal_valid = false;
+
 #endif /* FLASH_BASED_PARAMS */
 
 	return 0;
@@ -953,32 +1116,270 @@ param_get_default_file()
 	return (param_user_file != nullptr) ? param_user_file : param_default_file;
 }
 
-int
-param_save_default()
+struct param_import_state {
+	bool mark_saved;
+	bool only_generation{false}; ///< only read PARAM_JOURNAL_GENERATION, skip the parameters
+	int32_t generation{0}; ///< PARAM_JOURNAL_GENERATION of the document (0 if it has none)
+};
+
+static int param_import_callback(bson_decoder_t decoder, void *priv, bson_node_t node);
+static int param_import_internal(int fd, bool mark_saved, int32_t *generation = nullptr);
+
+/** get the journal file of the current parameter file (nullptr if the parameters are stored in FLASH) */
+static const char *
+param_get_journal_file()
 {
-	int res = PX4_ERROR;
+	if (param_journal_file == nullptr) {
+		const char *filename = param_get_default_file();
 
-	const char *filename = param_get_default_file();
+		if (filename != nullptr) {
+			param_journal_file = (char *)malloc(strlen(filename) + sizeof(PARAM_JOURNAL_SUFFIX));
 
-	if (!filename) {
-		param_lock_writer();
-		res = flash_param_save(false);
-		param_unlock_writer();
-		return res;
+			if (param_journal_file != nullptr) {
+				strcpy(param_journal_file, filename);
+				strcat(param_journal_file, PARAM_JOURNAL_SUFFIX);
+			}
+		}
+	}
+
+	return param_journal_file;
+}
+
+/** append the value of a parameter to a BSON document (requires the reader lock) */
+static int
+param_encode(bson_encoder_t encoder, const param_wbuf_s *s)
+{
+	const char *name = param_name(s->param);
+	const size_t size = param_size(s->param);
+
+	/* append the appropriate BSON type object */
+	switch (param_type(s->param)) {
+
+	case PARAM_TYPE_INT32: {
+			const int32_t i = s->val.i;
+
+			PX4_DEBUG("exporting: %s (%d) size: %d val: %d", name, s->param, size, i);
+
+			if (bson_encoder_append_int(encoder, name, i)) {
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	case PARAM_TYPE_FLOAT: {
+			const double f = (double)s->val.f;
+
+			PX4_DEBUG("exporting: %s (%d) size: %d val: %.3f", name, s->param, size, (double)f);
+
+			if (bson_encoder_append_double(encoder, name, f)) {
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	case PARAM_TYPE_STRUCT ... PARAM_TYPE_STRUCT_MAX: {
+			const void *value_ptr = param_get_value_ptr(s->param);
+
+			/* lock as short as possible */
+			if (bson_encoder_append_binary(encoder,
+						       name,
+						       BSON_BIN_BINARY,
+						       size,
+						       value_ptr)) {
+
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	default:
+		PX4_ERR("unrecognized parameter type");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Export the parameters to a file (requires param_sem_save).
+ * @param generation journal generation to tag the file with (see param_journal_compact()), 0 for none
+ */
+static int
+param_export_internal(int fd, bool only_unsaved, int32_t generation = 0)
+{
+	int	result = -1;
+	perf_begin(param_export_perf);
+
+	param_wbuf_s *s = nullptr;
+	struct bson_encoder_s encoder;
+
+	param_lock_reader();
+
+	uint8_t bson_buffer[256];
+	bson_encoder_init_buf_file(&encoder, fd, &bson_buffer, sizeof(bson_buffer));
+
+	if (generation != 0 && bson_encoder_append_int(&encoder, PARAM_JOURNAL_GENERATION, generation) != 0) {
+		goto out;
+	}
+
+	/* no modified parameters -> we are done */
+	if (param_values == nullptr) {
+		result = 0;
+		goto out;
+	}
+
+	while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != nullptr) {
+		/*
+		 * If we are only saving values changed since last save, and this
+		 * one hasn't, then skip it
+		 */
+		if (only_unsaved && !s->unsaved) {
+			continue;
+		}
+
+		s->unsaved = false;
+
+		if (param_encode(&encoder, s) != 0) {
+			goto out;
+		}
+	}
+
+	result = 0;
+
+out:
+
+	if (result == 0) {
+		if (bson_encoder_fini(&encoder) != PX4_OK) {
+			PX4_ERR("bson encoder finish failed");
+		}
+	}
+
+	param_unlock_reader();
+
+	perf_end(param_export_perf);
+
+	return result;
+}
+
+/**
+ * Append the parameters changed since the last save to the journal (requires param_sem_save).
+ * The values are encoded into memory first, so that setting parameters is only blocked while encoding the changes,
+ * not while writing them.
+ * @return 0 on success, the journal is invalidated otherwise
+ */
+static int
+param_journal_append()
+{
+	const char *journal_file = param_get_journal_file();
+	struct bson_encoder_s encoder;
+	int result = PX4_OK;
+	int num_changed = 0;
+
+	if (journal_file == nullptr || bson_encoder_init_buf(&encoder, nullptr, 0) != 0) {
+		param_journal_valid = false;
+		return PX4_ERROR;
+	}
+
+	perf_begin(param_export_perf);
+	param_lock_reader();
+
+	// no change can happen while holding the reader lock
+	const uint32_t seq = param_change_seq();
+
+	if (param_values != nullptr) {
+		param_wbuf_s *s = nullptr;
+
+		while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != nullptr) {
+			if (!param_changed_since(s->param, param_journal_seq)) {
+				continue;
+			}
+
+			// if the write fails, the journal is invalidated and the next save writes all parameters
+			s->unsaved = false;
+
+			if (param_encode(&encoder, s) != 0) {
+				result = PX4_ERROR;
+				break;
+			}
+
+			num_changed++;
+		}
+	}
+
+	param_unlock_reader();
+
+	if (result == PX4_OK && num_changed > 0) {
+		result = PX4_ERROR;
+
+		if (bson_encoder_fini(&encoder) == PX4_OK) {
+			const int size = bson_encoder_buf_size(&encoder);
+			int fd = PARAM_OPEN(journal_file, O_WRONLY | O_CREAT | O_APPEND, PX4_O_MODE_666);
+
+			if (fd >= 0) {
+				if (write(fd, bson_encoder_buf_data(&encoder), size) == size && fsync(fd) == 0) {
+					param_journal_size += size;
+					param_journal_seq = seq;
+					result = PX4_OK;
+				}
+
+				PARAM_CLOSE(fd);
+			}
+		}
+	}
+
+	perf_end(param_export_perf);
+
+	free(bson_encoder_buf_data(&encoder));
+
+	if (result == PX4_OK && num_changed == 0) {
+		param_journal_seq = seq;
 	}
 
+	if (result != PX4_OK) {
+		PX4_ERR("failed to append to param journal: %s", journal_file);
+		param_journal_valid = false;
+	}
+
+	return result;
+}
+
+/**
+ * Write all parameters to the parameter file and start a new journal (requires param_sem_save).
+ */
+static int
+param_journal_compact(const char *filename)
+{
+	int res = PX4_ERROR;
+
+	// resets and changes after this are not contained in the parameter file
+	const uint32_t resets = param_reset_counter.load();
+	const uint32_t seq = param_change_seq();
+
 	/* write parameters to temp file */
 	int fd = PARAM_OPEN(filename, O_WRONLY | O_CREAT, PX4_O_MODE_666);
 
 	if (fd < 0) {
 		PX4_ERR("failed to open param file: %s", filename);
+		param_journal_valid = false;
 		return PX4_ERROR;
 	}
 
+	// only journal to a regular file system (the parameter file might be a device, e.g. /fs/mtd_params)
+	const char *journal_file = param_get_journal_file();
+	struct stat st;
+	const bool journal = journal_file != nullptr && stat(filename, &st) == 0 && S_ISREG(st.st_mode);
+
+	// the existing journal belongs to the previous file from now on, and is ignored with the new file if a power loss
+	// happens before it is replaced
+	const int32_t generation = journal ? ((param_journal_generation == INT32_MAX) ? 1 : param_journal_generation + 1) : 0;
+
 	int attempts = 5;
 
 	while (res != OK && attempts > 0) {
-		res = param_export(fd, false);
+		res = param_export_internal(fd, false, generation);
 		attempts--;
 
 		if (res != PX4_OK) {
@@ -987,11 +1388,204 @@ param_save_default()
 		}
 	}
 
+	PARAM_CLOSE(fd);
+
+	param_journal_valid = false;
+
 	if (res != OK) {
 		PX4_ERR("failed to write parameters to file: %s", filename);
+		return res;
 	}
 
-	PARAM_CLOSE(fd);
+	param_journal_generation = generation;
+
+	// start the new journal with its generation
+	struct bson_encoder_s encoder;
+
+	if (journal && bson_encoder_init_buf(&encoder, nullptr, 0) == 0) {
+		if (bson_encoder_append_int(&encoder, PARAM_JOURNAL_GENERATION, generation) == 0
+		    && bson_encoder_fini(&encoder) == PX4_OK) {
+			const int size = bson_encoder_buf_size(&encoder);
+			int journal_fd = PARAM_OPEN(journal_file, O_WRONLY | O_CREAT | O_TRUNC, PX4_O_MODE_666);
+
+			if (journal_fd >= 0) {
+				if (write(journal_fd, bson_encoder_buf_data(&encoder), size) == size && fsync(journal_fd) == 0) {
+					param_journal_valid = true;
+					param_journal_size = size;
+					param_journal_resets = resets;
+					param_journal_seq = seq;
+					param_journal_compactions++;
+				}
+
+				PARAM_CLOSE(journal_fd);
+			}
+		}
+
+		free(bson_encoder_buf_data(&encoder));
+	}
+
+	return res;
+}
+
+/**
+ * Decode one journal document.
+ * @return true if the whole document was decoded
+ */
+static bool
+param_journal_decode(uint8_t *buf, int size, param_import_state *state)
+{
+	bson_decoder_s decoder;
+
+	if (bson_decoder_init_buf(&decoder, buf, size, param_import_callback, state) != 0) {
+		return false;
+	}
+
+	int result;
+
+	do {
+		result = bson_decoder_next(&decoder);
+	} while (result > 0);
+
+	return result == 0;
+}
+
+/**
+ * Apply the journal on top of the parameters loaded from the parameter file.
+ * A truncated document at the end of the journal (e.g. power loss during a save) is ignored, as is a journal of
+ * another generation than the parameter file.
+ */
+static void
+param_journal_load()
+{
+	do {} while (px4_sem_wait(&param_sem_save) != 0);
+
+	// only journal to a regular file system (see param_journal_compact())
+	const char *filename = param_get_default_file();
+	const char *journal_file = param_get_journal_file();
+	struct stat st;
+
+	if (filename == nullptr || stat(filename, &st) != 0 || !S_ISREG(st.st_mode)) {
+		journal_file = nullptr;
+	}
+
+	int fd = (journal_file != nullptr) ? PARAM_OPEN(journal_file, O_RDONLY) : -1;
+	const off_t file_size = (fd >= 0) ? lseek(fd, 0, SEEK_END) : 0;
+	off_t offset = 0;
+	int num_documents = 0;
+	bool complete = (fd >= 0) || (journal_file != nullptr && errno == ENOENT); // no journal is ok
+	bool mismatch = false;
+
+	if (fd >= 0 && lseek(fd, 0, SEEK_SET) != 0) {
+		complete = false;
+	}
+
+	while (complete && offset < file_size) {
+		// a document consists of its size, the elements and a terminating EOO
+		int32_t size = 0;
+
+		if (read(fd, &size, sizeof(size)) != sizeof(size) || size <= (int32_t)sizeof(size) || size > file_size - offset) {
+			complete = false;
+			break;
+		}
+
+		uint8_t *buf = (uint8_t *)malloc(size);
+
+		if (buf == nullptr) {
+			complete = false;
+			break;
+		}
+
+		memcpy(buf, &size, sizeof(size));
+
+		const int data_size = size - sizeof(size);
+		param_import_state state;
+		state.mark_saved = true;
+
+		if (read(fd, buf + sizeof(size), data_size) != data_size || buf[size - 1] != BSON_EOO) {
+			complete = false;
+
+		} else if (num_documents == 0) {
+			// the journal must belong to the loaded parameter file, check before applying anything
+			state.only_generation = true;
+			complete = param_journal_decode(buf, size, &state);
+
+			if (complete && state.generation != param_journal_generation) {
+				PX4_WARN("ignoring param journal of another parameter file (generation %i, file %i)",
+					 (int)state.generation, (int)param_journal_generation);
+				complete = false;
+				mismatch = true;
+			}
+
+			state.only_generation = false;
+		}
+
+		if (complete) {
+			complete = param_journal_decode(buf, size, &state);
+		}
+
+		free(buf);
+
+		if (complete) {
+			offset += size;
+			num_documents++;
+		}
+	}
+
+	if (fd >= 0) {
+		PARAM_CLOSE(fd);
+	}
+
+	if (!complete && fd >= 0 && !mismatch) {
+		PX4_WARN("ignoring param journal after %i saves (%i bytes)", num_documents, (int)offset);
+	}
+
+	// the next save compacts if the journal is not intact
+	param_journal_valid = complete;
+	param_journal_size = offset;
+	param_journal_resets = param_reset_counter.load();
+	param_journal_seq = param_change_seq();
+
+	px4_sem_post(&param_sem_save);
+}
+
+int
+param_save_default()
+{
+	int res = PX4_ERROR;
+
+	const char *filename = param_get_default_file();
+
+	if (!filename) {
+		param_lock_writer();
+		res = flash_param_save(false);
+		param_unlock_writer();
+		return res;
+	}
+
+	int shutdown_lock_ret = px4_shutdown_lock();
+
+	if (shutdown_lock_ret) {
+		PX4_ERR("px4_shutdown_lock() failed (%i)", shutdown_lock_ret);
+	}
+
+	// take the file lock
+	do {} while (px4_sem_wait(&param_sem_save) != 0);
+
+	// append the changes to the journal, unless it needs to be compacted
+	if (param_journal_valid && param_journal_size < PARAM_JOURNAL_COMPACT_SIZE
+	    && param_journal_resets == param_reset_counter.load()) {
+		res = param_journal_append();
+	}
+
+	if (res != PX4_OK) {
+		res = param_journal_compact(filename);
+	}
+
+	px4_sem_post(&param_sem_save);
+
+	if (shutdown_lock_ret == 0) {
+		px4_shutdown_unlock();
+	}
 
 	return res;
 }
@@ -1021,7 +1615,10 @@ param_load_default()
 		return 1;
 	}
 
-	int result = param_load(fd_load);
+	// like param_load(), but keep the journal generation of the file
+	param_reset_all_internal(false);
+	int32_t generation = 0;
+	int result = param_import_internal(fd_load, true, &generation);
 	PARAM_CLOSE(fd_load);
 
 	if (result != 0) {
@@ -1029,6 +1626,9 @@ param_load_default()
 		return -2;
 	}
 
+	param_journal_generation = generation;
+	param_journal_load();
+
 	return res;
 }
 
@@ -1036,9 +1636,9 @@ int
 param_export(int fd, bool only_unsaved)
 {
 	int	result = -1;
-	perf_begin(param_export_perf);
 
 	if (fd < 0) {
+		perf_begin(param_export_perf);
 		param_lock_writer();
 		// flash_param_save() will take the shutdown lock
 		result = flash_param_save(only_unsaved);
@@ -1047,9 +1647,6 @@ param_export(int fd, bool only_unsaved)
 		return result;
 	}
 
-	param_wbuf_s *s = nullptr;
-	struct bson_encoder_s encoder;
-
 	int shutdown_lock_ret = px4_shutdown_lock();
 
 	if (shutdown_lock_ret) {
@@ -1059,91 +1656,7 @@ param_export(int fd, bool only_unsaved)
 	// take the file lock
 	do {} while (px4_sem_wait(&param_sem_save) != 0);
 
-	param_lock_reader();
-
-	uint8_t bson_buffer[256];
-	bson_encoder_init_buf_file(&encoder, fd, &bson_buffer, sizeof(bson_buffer));
-
-	/* no modified parameters -> we are done */
-	if (param_values == nullptr) {
-		result = 0;
-		goto out;
-	}
-
-	while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != nullptr) {
-		/*
-		 * If we are only saving values changed since last save, and this
-		 * one hasn't, then skip it
-		 */
-		if (only_unsaved && !s->unsaved) {
-			continue;
-		}
-
-		s->unsaved = false;
-
-		const char *name = param_name(s->param);
-		const size_t size = param_size(s->param);
-
-		/* append the appropriate BSON type object */
-		switch (param_type(s->param)) {
-
-		case PARAM_TYPE_INT32: {
-				const int32_t i = s->val.i;
-
-				PX4_DEBUG("exporting: %s (%d) size: %d val: %d", name, s->param, size, i);
-
-				if (bson_encoder_append_int(&encoder, name, i)) {
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		case PARAM_TYPE_FLOAT: {
-				const double f = (double)s->val.f;
-
-				PX4_DEBUG("exporting: %s (%d) size: %d val: %.3f", name, s->param, size, (double)f);
-
-				if (bson_encoder_append_double(&encoder, name, f)) {
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		case PARAM_TYPE_STRUCT ... PARAM_TYPE_STRUCT_MAX: {
-				const void *value_ptr = param_get_value_ptr(s->param);
-
-				/* lock as short as possible */
-				if (bson_encoder_append_binary(&encoder,
-							       name,
-							       BSON_BIN_BINARY,
-							       size,
-							       value_ptr)) {
-
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		default:
-			PX4_ERR("unrecognized parameter type");
-			goto out;
-		}
-	}
-
-	result = 0;
-
-out:
-
-	if (result == 0) {
-		if (bson_encoder_fini(&encoder) != PX4_OK) {
-			PX4_ERR("bson encoder finish failed");
-		}
-	}
-
-	param_unlock_reader();
+	result = param_export_internal(fd, only_unsaved);
 
 	px4_sem_post(&param_sem_save);
 
@@ -1151,15 +1664,9 @@ out:
 		px4_shutdown_unlock();
 	}
 
-	perf_end(param_export_perf);
-
 	return result;
 }
 
-struct param_import_state {
-	bool mark_saved;
-};
-
 static int
 param_import_callback(bson_decoder_t decoder, void *priv, bson_node_t node)
 {
@@ -1179,6 +1686,19 @@ param_import_callback(bson_decoder_t decoder, void *priv, bson_node_t node)
 		return 0;
 	}
 
+	// not a parameter (see param_journal_compact())
+	if (strcmp(node->name, PARAM_JOURNAL_GENERATION) == 0) {
+		if (node->type == BSON_INT32) {
+			state->generation = node->i;
+		}
+
+		return 1;
+	}
+
+	if (state->only_generation) {
+		return 1;
+	}
+
 	/*
 	 * Find the parameter this node represents.  If we don't know it,
 	 * ignore the node.
@@ -1288,7 +1808,7 @@ out:
 }
 
 static int
-param_import_internal(int fd, bool mark_saved)
+param_import_internal(int fd, bool mark_saved, int32_t *generation)
 {
 	bson_decoder_s decoder;
 	param_import_state state;
@@ -1306,6 +1826,10 @@ param_import_internal(int fd, bool mark_saved)
 
 	} while (result > 0);
 
+	if (generation) {
+		*generation = state.generation;
+	}
+
 	return result;
 }
 
@@ -1382,6 +1906,8 @@ void param_print_status()
 
 	if (filename != nullptr) {
 		PX4_INFO("file: %s", param_get_default_file());
+		PX4_INFO("journal: %s, %d bytes, %u compactions", param_journal_valid ? "active" : "inactive",
+			 param_journal_size, param_journal_compactions);
 	}
 
 #endif /* FLASH_BASED_PARAMS */
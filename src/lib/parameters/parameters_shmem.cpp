@@ -50,6 +50,7 @@
 #include <math.h>
 
 #include <drivers/drv_hrt.h>
+#include <px4_atomic.h>
 #include <px4_config.h>
 #include <px4_defines.h>
 #include <px4_posix.h>
@@ -663,6 +664,21 @@ param_get(param_t param, void *val)
 	return result;
 }
 
+uint32_t
+param_change_seq()
+{
+	// values are updated from the shared memory on access, so changes cannot be tracked here:
+	// return a new sequence on every call, and report all parameters as changed
+	static px4::atomic<uint32_t> change_seq{0};
+	return change_seq.fetch_add(1) + 1;
+}
+
+bool
+param_changed_since(param_t param, uint32_t seq)
+{
+	return true;
+}
+
 #ifndef PARAM_NO_AUTOSAVE
 /**
  * worker callback method to save the parameters
@@ -59,6 +59,50 @@ __EXPORT uint32_t	latency_counters[LATENCY_BUCKET_COUNT + 1];
 #define dprintf(_fd, _text, ...) ((_fd) == 1 ? PX4_INFO((_text), ##__VA_ARGS__) : (void)(_fd))
 #endif
 
+/**
+ * Latency histogram with log-scale buckets: values below 4us have their own bucket, above that each power of 2
+ * is split into 4 buckets, up to 2^24us (16.7s). Larger values go to a separate overflow bucket.
+ */
+struct perf_histogram {
+	static constexpr int sub_bucket_bits = 2;
+	static constexpr int sub_bucket_count = 1 << sub_bucket_bits;
+	static constexpr int max_exponent = 23;
+	static constexpr int overflow_bucket = (max_exponent - sub_bucket_bits + 2) * sub_bucket_count;
+	static constexpr int bucket_count = overflow_bucket + 1;
+
+	uint32_t		counts[bucket_count] {};
+
+	static int bucket(uint32_t value)
+	{
+		if (value < sub_bucket_count) {
+			return value;
+		}
+
+		const int exponent = 31 - __builtin_clz(value);
+
+		if (exponent > max_exponent) {
+			return overflow_bucket;
+		}
+
+		return ((exponent - sub_bucket_bits + 1) << sub_bucket_bits)
+		       + ((value >> (exponent - sub_bucket_bits)) & (sub_bucket_count - 1));
+	}
+
+	/** largest value of a bucket */
+	static uint32_t bucket_max(int index)
+	{
+		if (index < sub_bucket_count) {
+			return index;
+		}
+
+		const int shift = (index >> sub_bucket_bits) - 1;
+		const uint32_t lower = (uint32_t)(sub_bucket_count + (index & (sub_bucket_count - 1))) << shift;
+		return lower + (1u << shift) - 1;
+	}
+
+	void add(uint32_t value) { counts[bucket(value)]++; }
+};
+
 /**
  * Header common to all counters.
  */
@@ -86,6 +130,7 @@ struct perf_ctr_elapsed : public perf_ctr_header {
 	uint32_t		time_most{0};
 	float			mean{0.0f};
 	float			M2{0.0f};
+	perf_histogram		*histogram{nullptr};
 };
 
 /**
@@ -100,6 +145,7 @@ struct perf_ctr_interval : public perf_ctr_header {
 	uint32_t		time_most{0};
 	float			mean{0.0f};
 	float			M2{0.0f};
+	perf_histogram		*histogram{nullptr};
 };
 
 /**
@@ -118,6 +164,9 @@ pthread_mutex_t perf_counters_mutex = PTHREAD_MUTEX_INITIALIZER;
 // The same holds for shared perf counters (perf_alloc_once), that can be updated
 // concurrently (this affects the 'ctrl_latency' counter).
 
+static perf_histogram *perf_get_histogram(perf_counter_t handle);
+static int perf_print_percentiles_buffer(char *buffer, int length, perf_counter_t handle);
+
 
 perf_counter_t
 perf_alloc(enum perf_counter_type type, const char *name)
@@ -192,6 +241,7 @@ perf_free(perf_counter_t handle)
 	sq_rem(&handle->link, &perf_counters);
 	pthread_mutex_unlock(&perf_counters_mutex);
 
+	delete perf_get_histogram(handle);
 	delete handle;
 }
 
@@ -221,6 +271,11 @@ perf_count(perf_counter_t handle)
 				pci->time_most = (uint32_t)(now - pci->time_last);
 				pci->mean = pci->time_least / 1e6f;
 				pci->M2 = 0;
+
+				if (pci->histogram) {
+					pci->histogram->add(pci->time_least);
+				}
+
 				break;
 
 			default: {
@@ -240,6 +295,11 @@ perf_count(perf_counter_t handle)
 					float delta_intvl = dt - pci->mean;
 					pci->mean += delta_intvl / pci->event_count;
 					pci->M2 += delta_intvl * (dt - pci->mean);
+
+					if (pci->histogram) {
+						pci->histogram->add((uint32_t)interval);
+					}
+
 					break;
 				}
 			}
@@ -305,6 +365,10 @@ perf_end(perf_counter_t handle)
 					pce->mean += delta_intvl / pce->event_count;
 					pce->M2 += delta_intvl * (dt - pce->mean);
 
+					if (pce->histogram) {
+						pce->histogram->add((uint32_t)elapsed);
+					}
+
 					pce->time_start = 0;
 				}
 			}
@@ -347,6 +411,10 @@ perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 				pce->mean += delta_intvl / pce->event_count;
 				pce->M2 += delta_intvl * (dt - pce->mean);
 
+				if (pce->histogram) {
+					pce->histogram->add((uint32_t)elapsed);
+				}
+
 				pce->time_start = 0;
 			}
 		}
@@ -376,6 +444,119 @@ perf_set_count(perf_counter_t handle, uint64_t count)
 
 }
 
+static perf_histogram *
+perf_get_histogram(perf_counter_t handle)
+{
+	switch (handle->type) {
+	case PC_ELAPSED:
+		return ((struct perf_ctr_elapsed *)handle)->histogram;
+
+	case PC_INTERVAL:
+		return ((struct perf_ctr_interval *)handle)->histogram;
+
+	default:
+		return nullptr;
+	}
+}
+
+int
+perf_histogram_enable(perf_counter_t handle)
+{
+	if (handle == nullptr) {
+		return -1;
+	}
+
+	perf_histogram **histogram;
+
+	switch (handle->type) {
+	case PC_ELAPSED:
+		histogram = &((struct perf_ctr_elapsed *)handle)->histogram;
+		break;
+
+	case PC_INTERVAL:
+		histogram = &((struct perf_ctr_interval *)handle)->histogram;
+		break;
+
+	default:
+		return -1;
+	}
+
+	if (*histogram == nullptr) {
+		*histogram = new perf_histogram();
+	}
+
+	return *histogram ? 0 : -1;
+}
+
+uint32_t
+perf_percentile(perf_counter_t handle, float percentile)
+{
+	if (handle == nullptr) {
+		return 0;
+	}
+
+	const perf_histogram *histogram = perf_get_histogram(handle);
+
+	if (histogram == nullptr) {
+		return 0;
+	}
+
+	uint32_t time_most = (handle->type == PC_ELAPSED) ? ((struct perf_ctr_elapsed *)handle)->time_most :
+			     ((struct perf_ctr_interval *)handle)->time_most;
+	uint64_t total = 0;
+
+	for (int i = 0; i < perf_histogram::bucket_count; i++) {
+		total += histogram->counts[i];
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	// rank of the event at the percentile (1-based)
+	uint64_t rank = (uint64_t)ceilf(percentile / 100.f * total);
+
+	if (rank < 1) {
+		rank = 1;
+
+	} else if (rank > total) {
+		rank = total;
+	}
+
+	uint64_t count = 0;
+
+	for (int i = 0; i < perf_histogram::bucket_count; i++) {
+		count += histogram->counts[i];
+
+		if (count >= rank) {
+			if (i == perf_histogram::overflow_bucket) {
+				return time_most;
+			}
+
+			uint32_t value = perf_histogram::bucket_max(i);
+			return value < time_most ? value : time_most;
+		}
+	}
+
+	return time_most;
+}
+
+static int
+perf_print_percentiles_buffer(char *buffer, int length, perf_counter_t handle)
+{
+	if (length <= 0 || perf_get_histogram(handle) == nullptr) {
+		return 0;
+	}
+
+	int num_written = snprintf(buffer, length, ", p50 %uus p90 %uus p99 %uus p99.9 %uus",
+				   (unsigned)perf_percentile(handle, 50.f),
+				   (unsigned)perf_percentile(handle, 90.f),
+				   (unsigned)perf_percentile(handle, 99.f),
+				   (unsigned)perf_percentile(handle, 99.9f));
+
+	return num_written < length ? num_written : length - 1;
+}
+
 void
 perf_cancel(perf_counter_t handle)
 {
@@ -417,6 +598,11 @@ perf_reset(perf_counter_t handle)
 			pce->time_total = 0;
 			pce->time_least = 0;
 			pce->time_most = 0;
+
+			if (pce->histogram) {
+				memset(pce->histogram->counts, 0, sizeof(pce->histogram->counts));
+			}
+
 			break;
 		}
 
@@ -428,6 +614,11 @@ perf_reset(perf_counter_t handle)
 			pci->time_last = 0;
 			pci->time_least = 0;
 			pci->time_most = 0;
+
+			if (pci->histogram) {
+				memset(pci->histogram->counts, 0, sizeof(pci->histogram->counts));
+			}
+
 			break;
 		}
 	}
@@ -450,6 +641,10 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 		return;
 	}
 
+	char percentiles[64];
+	percentiles[0] = '\0';
+	perf_print_percentiles_buffer(percentiles, sizeof(percentiles), handle);
+
 	switch (handle->type) {
 	case PC_COUNT:
 		dprintf(fd, "%s: %llu events\n",
@@ -460,14 +655,15 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 	case PC_ELAPSED: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			float rms = sqrtf(pce->M2 / (pce->event_count - 1));
-			dprintf(fd, "%s: %llu events, %lluus elapsed, %.2fus avg, min %lluus max %lluus %5.3fus rms\n",
+			dprintf(fd, "%s: %llu events, %lluus elapsed, %.2fus avg, min %lluus max %lluus %5.3fus rms%s\n",
 				handle->name,
 				(unsigned long long)pce->event_count,
 				(unsigned long long)pce->time_total,
 				(pce->event_count == 0) ? 0 : (double)pce->time_total / (double)pce->event_count,
 				(unsigned long long)pce->time_least,
 				(unsigned long long)pce->time_most,
-				(double)(1e6f * rms));
+				(double)(1e6f * rms),
+				percentiles);
 			break;
 		}
 
@@ -475,13 +671,14 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
 			float rms = sqrtf(pci->M2 / (pci->event_count - 1));
 
-			dprintf(fd, "%s: %llu events, %.2fus avg, min %lluus max %lluus %5.3fus rms\n",
+			dprintf(fd, "%s: %llu events, %.2fus avg, min %lluus max %lluus %5.3fus rms%s\n",
 				handle->name,
 				(unsigned long long)pci->event_count,
 				(pci->event_count == 0) ? 0 : (double)(pci->time_last - pci->time_first) / (double)pci->event_count,
 				(unsigned long long)pci->time_least,
 				(unsigned long long)pci->time_most,
-				(double)(1e6f * rms));
+				(double)(1e6f * rms),
+				percentiles);
 			break;
 		}
 
@@ -539,6 +736,10 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 		break;
 	}
 
+	if (num_written >= 0 && num_written < length) {
+		num_written += perf_print_percentiles_buffer(buffer + num_written, length - num_written, handle);
+	}
+
 	buffer[length - 1] = 0; // ensure 0-termination
 	return num_written;
 }
@@ -612,6 +813,29 @@ perf_print_latency(int fd)
 	dprintf(fd, " >%4i : %i\n", latency_buckets[latency_bucket_count - 1], latency_counters[latency_bucket_count]);
 }
 
+int
+perf_histogram_enable_all(const char *name)
+{
+	int num_enabled = 0;
+
+	pthread_mutex_lock(&perf_counters_mutex);
+	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+
+	while (handle != nullptr) {
+		if ((handle->type == PC_ELAPSED || handle->type == PC_INTERVAL)
+		    && (name == nullptr || strstr(handle->name, name) != nullptr)
+		    && perf_histogram_enable(handle) == 0) {
+			++num_enabled;
+		}
+
+		handle = (perf_counter_t)sq_next(&handle->link);
+	}
+
+	pthread_mutex_unlock(&perf_counters_mutex);
+
+	return num_enabled;
+}
+
 void
 perf_reset_all(void)
 {
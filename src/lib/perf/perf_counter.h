@@ -142,6 +142,37 @@ __EXPORT extern void		perf_set_elapsed(perf_counter_t handle, int64_t elapsed);
  */
 __EXPORT extern void		perf_set_count(perf_counter_t handle, uint64_t count);
 
+/**
+ * Enable the latency histogram of a counter.
+ *
+ * This call applies to counters of type PC_ELAPSED and PC_INTERVAL. It allocates a fixed-size histogram
+ * with log-scale buckets (each bucket is at most 25% wide). Updates are constant-time and do not use floating
+ * point, so the histogram can be left enabled in flight. Once enabled, percentiles are added to the printed
+ * (and logged) counter output. A histogram cannot be disabled again, it is freed with the counter.
+ *
+ * @param handle		The handle returned from perf_alloc.
+ * @return			0 on success (or if already enabled), -1 on wrong counter type or allocation failure
+ */
+__EXPORT extern int		perf_histogram_enable(perf_counter_t handle);
+
+/**
+ * Enable the latency histogram of all PC_ELAPSED and PC_INTERVAL counters (see perf_histogram_enable).
+ *
+ * @param name			Only enable counters whose name contains this string, or NULL for all.
+ * @return			The number of counters with an enabled histogram.
+ */
+__EXPORT extern int		perf_histogram_enable_all(const char *name);
+
+/**
+ * Get a percentile of the elapsed times or intervals of a counter with histogram.
+ *
+ * @param handle		The handle returned from perf_alloc.
+ * @param percentile		The percentile, in [0, 100].
+ * @return			Upper bound of the histogram bucket containing the percentile (limited to the
+ *				maximum) in us, or 0 if the counter has no histogram or no events.
+ */
+__EXPORT extern uint32_t	perf_percentile(perf_counter_t handle, float percentile);
+
 /**
  * Cancel a performance event.
  *
@@ -80,6 +80,8 @@ static int  _file_clear(dm_item_t item);
 static int  _file_restart(dm_reset_reason reason);
 static int _file_initialize(unsigned max_offset);
 static void _file_shutdown();
+static int _file_wait(px4_sem_t *sem);
+static int _file_flush();
 
 /* Private Ram based Operations */
 static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
@@ -102,6 +104,7 @@ static int  _ram_flash_restart(dm_reset_reason reason);
 static int _ram_flash_initialize(unsigned max_offset);
 static void _ram_flash_shutdown();
 static int _ram_flash_wait(px4_sem_t *sem);
+static int _ram_flash_flush();
 #endif
 
 typedef struct dm_operations_t {
@@ -112,6 +115,7 @@ typedef struct dm_operations_t {
 	int (*initialize)(unsigned max_offset);
 	void (*shutdown)();
 	int (*wait)(px4_sem_t *sem);
+	int (*flush)();
 } dm_operations_t;
 
 static constexpr dm_operations_t dm_file_operations = {
@@ -121,7 +125,8 @@ static constexpr dm_operations_t dm_file_operations = {
 	.restart = _file_restart,
 	.initialize = _file_initialize,
 	.shutdown = _file_shutdown,
-	.wait = px4_sem_wait,
+	.wait = _file_wait,
+	.flush = _file_flush,
 };
 
 static constexpr dm_operations_t dm_ram_operations = {
@@ -132,6 +137,7 @@ static constexpr dm_operations_t dm_ram_operations = {
 	.initialize = _ram_initialize,
 	.shutdown = _ram_shutdown,
 	.wait = px4_sem_wait,
+	.flush = nullptr,
 };
 
 #if defined(FLASH_BASED_DATAMAN)
@@ -143,15 +149,35 @@ static constexpr dm_operations_t dm_ram_flash_operations = {
 	.initialize = _ram_flash_initialize,
 	.shutdown = _ram_flash_shutdown,
 	.wait = _ram_flash_wait,
+	.flush = _ram_flash_flush,
 };
 #endif
 
 static const dm_operations_t *g_dm_ops;
 
+/* File backend: maximum time a write stays in the write-back cache */
+#define FILE_FLUSH_TIMEOUT_USEC 200000
+
+/* File backend: number of items in the write-back cache */
+#if defined(MEMORY_CONSTRAINED_SYSTEM)
+static constexpr int k_file_cache_entries = 8;
+#elif defined(__PX4_NUTTX)
+static constexpr int k_file_cache_entries = 32;
+#else
+static constexpr int k_file_cache_entries = 256;
+#endif
+
+typedef struct dm_file_cache_entry_t dm_file_cache_entry_t;
+
 static struct {
 	union {
 		struct {
 			int fd;
+			dm_file_cache_entry_t *cache; /* pending writes, sorted by offset (nullptr: write-through) */
+			int cache_count;
+			hrt_abstime flush_timeout_usec; /* 0 if nothing pending */
+			unsigned syncs;
+			unsigned checksum_errors;
 		} file;
 		struct {
 			uint8_t *data;
@@ -175,6 +201,9 @@ typedef enum {
 	dm_read_func,
 	dm_clear_func,
 	dm_restart_func,
+	dm_flush_func,
+	dm_write_range_func,
+	dm_read_range_func,
 	dm_number_of_funcs
 } dm_function_t;
 
@@ -205,6 +234,21 @@ typedef struct {
 		struct {
 			dm_reset_reason reason;
 		} restart_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			dm_persitence_t persistence;
+			const void *buf;
+			size_t item_size;
+			unsigned count;
+		} write_range_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			void *buf;
+			size_t item_size;
+			unsigned count;
+		} read_range_params;
 	};
 } work_q_item_t;
 
@@ -237,6 +281,19 @@ static constexpr size_t g_per_item_size[DM_KEY_NUM_KEYS] = {
 	sizeof(struct dataman_compat_s) + DM_SECTOR_HDR_SIZE
 };
 
+/* Largest item (including the header) */
+static constexpr size_t max_item_size(unsigned i = 0)
+{
+	return i >= DM_KEY_NUM_KEYS ? 0 :
+	       (g_per_item_size[i] > max_item_size(i + 1) ? g_per_item_size[i] : max_item_size(i + 1));
+}
+
+struct dm_file_cache_entry_t {
+	int offset;
+	uint8_t size; /* header + data */
+	uint8_t data[max_item_size()];
+};
+
 /* Table of offset for index 0 of each item type */
 static unsigned int g_key_offsets[DM_KEY_NUM_KEYS];
 
@@ -445,13 +502,32 @@ calculate_offset(dm_item_t item, unsigned index)
  *
  * byte 0: Length of user data item
  * byte 1: Persistence of this data item
- * byte 2: Unused (for future use)
- * byte 3: Unused (for future use)
+ * byte 2: Checksum (file backend, low byte), unused otherwise
+ * byte 3: Checksum (file backend, high byte), unused otherwise
  * byte DM_SECTOR_HDR_SIZE... : data item value
  *
  * The total size must not exceed g_per_item_max_index[item]
  */
 
+/* Fletcher-16 checksum over the header (without the checksum) and the data of an item. It detects items that were
+ * only partially written to the file (e.g. power loss during a write). */
+static uint16_t
+item_checksum(const uint8_t *buffer)
+{
+	uint16_t sum1 = 0xff, sum2 = 0xff;
+
+	for (unsigned i = 0; i < DM_SECTOR_HDR_SIZE + (unsigned)buffer[0]; i++) {
+		if (i == 2 || i == 3) {
+			continue; /* the checksum itself */
+		}
+
+		sum1 = (sum1 + buffer[i]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+
+	return (sum2 << 8) | sum1;
+}
+
 /* write to the data manager RAM buffer  */
 static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
 			  size_t count)
@@ -490,6 +566,128 @@ static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persis
 	return count;
 }
 
+/* Items that reference other items (mission state, fence and safe point counts) are commit records: they are
+ * written through, after all pending writes are on the media. So after a power loss the stored state is always
+ * consistent, even though the other writes are cached. */
+static bool
+is_commit_record(dm_item_t item, unsigned index)
+{
+	return item == DM_KEY_MISSION_STATE || item == DM_KEY_COMPAT ||
+	       ((item == DM_KEY_FENCE_POINTS || item == DM_KEY_SAFE_POINTS) && index == 0);
+}
+
+/* find the position of an offset in the write-back cache (or where to insert it) */
+static int
+_file_cache_position(int offset)
+{
+	int low = 0;
+	int high = dm_operations_data.file.cache_count;
+
+	while (low < high) {
+		const int mid = (low + high) / 2;
+
+		if (dm_operations_data.file.cache[mid].offset < offset) {
+			low = mid + 1;
+
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+static const dm_file_cache_entry_t *
+_file_cache_find(int offset)
+{
+	if (!dm_operations_data.file.cache) {
+		return nullptr;
+	}
+
+	const int pos = _file_cache_position(offset);
+
+	if (pos < dm_operations_data.file.cache_count && dm_operations_data.file.cache[pos].offset == offset) {
+		return &dm_operations_data.file.cache[pos];
+	}
+
+	return nullptr;
+}
+
+/* add a write to the cache, replacing a pending write of the same item. Returns false if not cached */
+static bool
+_file_cache_put(int offset, const uint8_t *buffer, size_t size)
+{
+	if (!dm_operations_data.file.cache) {
+		return false;
+	}
+
+	int pos = _file_cache_position(offset);
+	dm_file_cache_entry_t *cache = dm_operations_data.file.cache;
+
+	if (pos >= dm_operations_data.file.cache_count || cache[pos].offset != offset) {
+		if (dm_operations_data.file.cache_count == k_file_cache_entries) {
+			if (_file_flush() != 0) {
+				return false;
+			}
+
+			pos = 0;
+		}
+
+		memmove(&cache[pos + 1], &cache[pos], (dm_operations_data.file.cache_count - pos) * sizeof(cache[0]));
+		++dm_operations_data.file.cache_count;
+	}
+
+	cache[pos].offset = offset;
+	cache[pos].size = size;
+	memcpy(cache[pos].data, buffer, size);
+
+	if (dm_operations_data.file.flush_timeout_usec == 0) {
+		dm_operations_data.file.flush_timeout_usec = hrt_absolute_time() + FILE_FLUSH_TIMEOUT_USEC;
+	}
+
+	return true;
+}
+
+/* write all pending items (in file order) and sync the file */
+static int
+_file_flush()
+{
+	int result = 0;
+	int file_pos = -1;
+
+	for (int i = 0; i < dm_operations_data.file.cache_count; i++) {
+		const dm_file_cache_entry_t &entry = dm_operations_data.file.cache[i];
+
+		/* consecutive items do not need a seek */
+		if (file_pos != entry.offset && lseek(dm_operations_data.file.fd, entry.offset, SEEK_SET) != entry.offset) {
+			result = -1;
+			break;
+		}
+
+		if (write(dm_operations_data.file.fd, entry.data, entry.size) != entry.size) {
+			result = -1;
+			break;
+		}
+
+		file_pos = entry.offset + entry.size;
+	}
+
+	if (result != 0) {
+		PX4_ERR("flush failed, %i items lost", dm_operations_data.file.cache_count);
+	}
+
+	const bool had_pending = dm_operations_data.file.cache_count > 0;
+	dm_operations_data.file.cache_count = 0;
+	dm_operations_data.file.flush_timeout_usec = 0;
+
+	if (had_pending) {
+		fsync(dm_operations_data.file.fd);
+		++dm_operations_data.file.syncs;
+	}
+
+	return result;
+}
+
 /* write to the data manager file */
 static ssize_t
 _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
@@ -519,8 +717,21 @@ _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const v
 		memcpy(buffer + DM_SECTOR_HDR_SIZE, buf, count);
 	}
 
+	const uint16_t checksum = item_checksum(buffer);
+	buffer[2] = checksum & 0xff;
+	buffer[3] = checksum >> 8;
+
 	count += DM_SECTOR_HDR_SIZE;
 
+	if (!is_commit_record(item, index) && _file_cache_put(offset, buffer, count)) {
+		return count - DM_SECTOR_HDR_SIZE;
+	}
+
+	/* All pending writes must be on the media before a commit record */
+	if (_file_flush() != 0) {
+		return -1;
+	}
+
 	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
 		return -1;
 	}
@@ -531,6 +742,7 @@ _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const v
 
 	/* Make sure data is written to physical media */
 	fsync(dm_operations_data.file.fd);
+	++dm_operations_data.file.syncs;
 
 	/* All is well... return the number of user data written */
 	return count - DM_SECTOR_HDR_SIZE;
@@ -622,10 +834,15 @@ _file_read(dm_item_t item, unsigned index, void *buf, size_t count)
 		return -E2BIG;
 	}
 
-	/* Read the prefix and data */
+	/* Read the prefix and data, from the pending writes first */
 	int len = -1;
+	const dm_file_cache_entry_t *entry = _file_cache_find(offset);
+
+	if (entry) {
+		len = entry->size < count + DM_SECTOR_HDR_SIZE ? entry->size : count + DM_SECTOR_HDR_SIZE;
+		memcpy(buffer, entry->data, len);
 
-	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) == offset) {
+	} else if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) == offset) {
 		len = read(dm_operations_data.file.fd, buffer, count + DM_SECTOR_HDR_SIZE);
 	}
 
@@ -646,6 +863,12 @@ _file_read(dm_item_t item, unsigned index, void *buf, size_t count)
 			return -1;
 		}
 
+		/* Incomplete write (e.g. power loss) */
+		if (len < buffer[0] + DM_SECTOR_HDR_SIZE || item_checksum(buffer) != (buffer[2] | (buffer[3] << 8))) {
+			++dm_operations_data.file.checksum_errors;
+			return -1;
+		}
+
 		/* Looks good, copy it to the caller's buffer */
 		memcpy(buf, buffer + DM_SECTOR_HDR_SIZE, buffer[0]);
 	}
@@ -704,6 +927,11 @@ _file_clear(dm_item_t item)
 		return -1;
 	}
 
+	/* Pending writes would overwrite the cleared items later */
+	if (_file_flush() != 0) {
+		result = -1;
+	}
+
 	/* Clear all items of this type */
 	for (i = 0; (unsigned)i < g_per_item_max_index[item]; i++) {
 		char buf[1];
@@ -738,6 +966,7 @@ _file_clear(dm_item_t item)
 
 	/* Make sure data is actually written to physical media */
 	fsync(dm_operations_data.file.fd);
+	++dm_operations_data.file.syncs;
 	return result;
 }
 
@@ -800,7 +1029,7 @@ static int
 _file_restart(dm_reset_reason reason)
 {
 	int offset = 0;
-	int result = 0;
+	int result = _file_flush();
 	/* We need to scan the entire file and invalidate and data that should not persist after the last reset */
 
 	/* Loop through all of the data segments and delete those that are not persistent */
@@ -863,6 +1092,7 @@ _file_restart(dm_reset_reason reason)
 	}
 
 	fsync(dm_operations_data.file.fd);
+	++dm_operations_data.file.syncs;
 
 	/* tell the caller how it went */
 	return result;
@@ -879,6 +1109,12 @@ _ram_flash_restart(dm_reset_reason reason)
 static int
 _file_initialize(unsigned max_offset)
 {
+	dm_operations_data.file.cache = nullptr;
+	dm_operations_data.file.cache_count = 0;
+	dm_operations_data.file.flush_timeout_usec = 0;
+	dm_operations_data.file.syncs = 0;
+	dm_operations_data.file.checksum_errors = 0;
+
 	/* See if the data manage file exists and is a multiple of the sector size */
 	dm_operations_data.file.fd = open(k_data_manager_device_path, O_RDONLY | O_BINARY);
 
@@ -928,6 +1164,14 @@ _file_initialize(unsigned max_offset)
 	}
 
 	fsync(dm_operations_data.file.fd);
+
+	/* Without the cache, all writes are written through */
+	dm_operations_data.file.cache = (dm_file_cache_entry_t *)malloc(k_file_cache_entries * sizeof(dm_file_cache_entry_t));
+
+	if (dm_operations_data.file.cache == nullptr) {
+		PX4_WARN("Could not allocate the write cache");
+	}
+
 	dm_operations_data.running = true;
 
 	return 0;
@@ -993,10 +1237,49 @@ _ram_flash_initialize(unsigned max_offset)
 static void
 _file_shutdown()
 {
+	_file_flush();
+	free(dm_operations_data.file.cache);
+	dm_operations_data.file.cache = nullptr;
 	close(dm_operations_data.file.fd);
 	dm_operations_data.running = false;
 }
 
+static int
+_file_wait(px4_sem_t *sem)
+{
+	if (!dm_operations_data.file.flush_timeout_usec) {
+		px4_sem_wait(sem);
+		return 0;
+	}
+
+	const uint64_t now = hrt_absolute_time();
+
+	if (now >= dm_operations_data.file.flush_timeout_usec) {
+		_file_flush();
+		return 0;
+	}
+
+	/* wait until new work is queued or the pending writes are due */
+	struct timespec abstime;
+#if defined(__PX4_NUTTX)
+	px4_clock_gettime(CLOCK_REALTIME, &abstime);
+#else
+	px4_clock_gettime(CLOCK_MONOTONIC, &abstime); /* the clock of px4_sem_timedwait() */
+#endif
+	const unsigned billion = (1000 * 1000 * 1000);
+	const uint64_t abstime_nsec = abstime.tv_nsec + (dm_operations_data.file.flush_timeout_usec - now) * 1000;
+	abstime.tv_sec += abstime_nsec / billion;
+	abstime.tv_nsec = abstime_nsec % billion;
+
+	px4_sem_timedwait(sem, &abstime);
+
+	if (hrt_absolute_time() >= dm_operations_data.file.flush_timeout_usec) {
+		_file_flush();
+	}
+
+	return 0;
+}
+
 static void
 _ram_shutdown()
 {
@@ -1005,7 +1288,7 @@ _ram_shutdown()
 }
 
 #if defined(FLASH_BASED_DATAMAN)
-static void
+static int
 _ram_flash_flush()
 {
 	/*
@@ -1019,7 +1302,7 @@ _ram_flash_flush()
 
 	if (ret < 0) {
 		PX4_WARN("Error erasing flash sector %u", k_dataman_flash_sector->page);
-		return;
+		return -1;
 	}
 
 	const ssize_t len = (dm_operations_data.ram_flash.data_end - dm_operations_data.ram_flash.data) + 1;
@@ -1027,8 +1310,10 @@ _ram_flash_flush()
 
 	if (ret < len) {
 		PX4_WARN("Error writing to flash sector %u, error: %i", k_dataman_flash_sector->page, ret);
-		return;
+		return -1;
 	}
+
+	return 0;
 }
 
 static void
@@ -1127,6 +1412,62 @@ dm_read(dm_item_t item, unsigned index, void *buf, size_t count)
 	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
 }
 
+/** Write consecutive items to the data manager file */
+__EXPORT ssize_t
+dm_write_range(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t item_size,
+	       unsigned count)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	/* get a work item and queue up a write request */
+	if ((work = create_work_item()) == nullptr) {
+		return -1;
+	}
+
+	work->func = dm_write_range_func;
+	work->write_range_params.item = item;
+	work->write_range_params.index = index;
+	work->write_range_params.persistence = persistence;
+	work->write_range_params.buf = buf;
+	work->write_range_params.item_size = item_size;
+	work->write_range_params.count = count;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
+}
+
+/** Retrieve consecutive items from the data manager file */
+__EXPORT ssize_t
+dm_read_range(dm_item_t item, unsigned index, void *buf, size_t item_size, unsigned count)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	/* get a work item and queue up a read request */
+	if ((work = create_work_item()) == nullptr) {
+		return -1;
+	}
+
+	work->func = dm_read_range_func;
+	work->read_range_params.item = item;
+	work->read_range_params.index = index;
+	work->read_range_params.buf = buf;
+	work->read_range_params.item_size = item_size;
+	work->read_range_params.count = count;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
+}
+
 /** Clear a data Item */
 __EXPORT int
 dm_clear(dm_item_t item)
@@ -1235,6 +1576,28 @@ dm_restart(dm_reset_reason reason)
 	return enqueue_work_item_and_wait_for_result(work);
 }
 
+/** Write all pending items to the storage */
+__EXPORT int
+dm_flush()
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	/* get a work item and queue up a flush request */
+	if ((work = create_work_item()) == nullptr) {
+		return -1;
+	}
+
+	work->func = dm_flush_func;
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return enqueue_work_item_and_wait_for_result(work);
+}
+
 #if defined(FLASH_BASED_DATAMAN)
 __EXPORT int
 dm_flash_sector_description_set(const dm_sector_descriptor_t *description)
@@ -1244,6 +1607,49 @@ dm_flash_sector_description_set(const dm_sector_descriptor_t *description)
 }
 #endif
 
+/* write the items of a range request, stops at the first failure. Returns the number of items written */
+static ssize_t
+write_range(work_q_item_t *work)
+{
+	const uint8_t *buf = (const uint8_t *)work->write_range_params.buf;
+	const size_t item_size = work->write_range_params.item_size;
+	unsigned i;
+
+	for (i = 0; i < work->write_range_params.count; i++) {
+		if (g_dm_ops->write(work->write_range_params.item, work->write_range_params.index + i,
+				    work->write_range_params.persistence, buf + i * item_size, item_size) != (ssize_t)item_size) {
+			break;
+		}
+	}
+
+	return (i == 0 && work->write_range_params.count > 0) ? -1 : i;
+}
+
+/* read the items of a range request, stops at the first item that is not item_size long (e.g. an empty item).
+ * Returns the number of items read */
+static ssize_t
+read_range(work_q_item_t *work)
+{
+	uint8_t *buf = (uint8_t *)work->read_range_params.buf;
+	const size_t item_size = work->read_range_params.item_size;
+	unsigned i;
+
+	for (i = 0; i < work->read_range_params.count; i++) {
+		const ssize_t ret = g_dm_ops->read(work->read_range_params.item, work->read_range_params.index + i,
+						   buf + i * item_size, item_size);
+
+		if (ret < 0 && i == 0) {
+			return ret;
+		}
+
+		if (ret != (ssize_t)item_size) {
+			break;
+		}
+	}
+
+	return i;
+}
+
 static int
 task_main(int argc, char *argv[])
 {
@@ -1397,6 +1803,21 @@ task_main(int argc, char *argv[])
 				work->result = g_dm_ops->restart(work->restart_params.reason);
 				break;
 
+			case dm_flush_func:
+				g_func_counts[dm_flush_func]++;
+				work->result = g_dm_ops->flush ? g_dm_ops->flush() : 0;
+				break;
+
+			case dm_write_range_func:
+				g_func_counts[dm_write_range_func]++;
+				work->result = write_range(work);
+				break;
+
+			case dm_read_range_func:
+				g_func_counts[dm_read_range_func]++;
+				work->result = read_range(work);
+				break;
+
 			default: /* should never happen */
 				work->result = -1;
 				break;
@@ -1469,6 +1890,13 @@ status()
 	PX4_INFO("Reads    %d", g_func_counts[dm_read_func]);
 	PX4_INFO("Clears   %d", g_func_counts[dm_clear_func]);
 	PX4_INFO("Restarts %d", g_func_counts[dm_restart_func]);
+	PX4_INFO("Flushes  %d", g_func_counts[dm_flush_func]);
+	PX4_INFO("Range writes %d, reads %d", g_func_counts[dm_write_range_func], g_func_counts[dm_read_range_func]);
+
+	if (g_dm_ops == &dm_file_operations) {
+		PX4_INFO("Syncs    %d, checksum errors %d", dm_operations_data.file.syncs, dm_operations_data.file.checksum_errors);
+	}
+
 	PX4_INFO("Max Q lengths work %d, free %d", g_work_q.max_size, g_free_q.max_size);
 }
 
@@ -1505,6 +1933,14 @@ which stores the number of items for these types. These items are always updated
 the mavlink mission manager). During that time, navigator will try to acquire the geofence item lock, fail, and will not
 check for geofence violations.
 
+The file backend caches writes for up to 200ms and writes them in one batch, followed by a single sync. Mission state,
+compat and the first item of fence and safe points are commit records: they are written through, after all pending
+writes, so that the stored state is consistent after a power loss. Each item has a checksum to detect incomplete writes.
+`dm_flush` writes all pending items immediately.
+
+`dm_read_range` and `dm_write_range` transfer consecutive items of a type in a single request to the worker thread,
+which avoids the thread switch per item for large missions.
+
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("dataman", "system");
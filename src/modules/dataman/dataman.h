@@ -99,7 +99,7 @@ struct dataman_compat_s {
 };
 
 /* increment this define whenever a binary incompatible change is performed */
-#define DM_COMPAT_VERSION	2ULL
+#define DM_COMPAT_VERSION	3ULL
 
 #define DM_COMPAT_KEY ((DM_COMPAT_VERSION << 32) + (sizeof(struct mission_item_s) << 24) + \
 		       (sizeof(struct mission_s) << 16) + (sizeof(struct mission_stats_entry_s) << 12) + \
@@ -125,6 +125,35 @@ dm_write(
 	size_t buflen			/* Length in bytes of data to retrieve */
 );
 
+/**
+ * Retrieve consecutive items of a type in a single request.
+ * Reading stops at the first item that does not have a length of item_size (e.g. an empty item).
+ * @return the number of items read, -1 (or -errno) if the first item could not be read
+ */
+__EXPORT ssize_t
+dm_read_range(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned index,			/* The index of the first item */
+	void *buffer,			/* Pointer to caller data buffer (an array of count items) */
+	size_t item_size,		/* Length in bytes of each item */
+	unsigned count			/* Number of items to retrieve */
+);
+
+/**
+ * Write consecutive items of a type in a single request.
+ * Writing stops at the first failure.
+ * @return the number of items written, -1 if the first item could not be written
+ */
+__EXPORT ssize_t
+dm_write_range(
+	dm_item_t item,			/* The item type to store */
+	unsigned index,			/* The index of the first item */
+	dm_persitence_t persistence,	/* The persistence level of the items */
+	const void *buffer,		/* Pointer to caller data buffer (an array of count items) */
+	size_t item_size,		/* Length in bytes of each item */
+	unsigned count			/* Number of items to store */
+);
+
 /**
  * Lock all items of a type. Can be used for atomic updates of multiple items (single items are always updated
  * atomically).
@@ -163,6 +192,14 @@ dm_restart(
 	dm_reset_reason restart_type	/* The last reset type */
 );
 
+/**
+ * Write all pending (cached) items to the storage and wait until they are synced.
+ * Writes are otherwise synced within 200ms.
+ * @return 0 on success, -1 otherwise
+ */
+__EXPORT int
+dm_flush(void);
+
 #if defined(FLASH_BASED_DATAMAN)
 typedef struct dm_sector_descriptor_t {
 	uint8_t       page;
@@ -40,6 +40,7 @@
  */
 
 #include <drivers/drv_hrt.h>
+#include <lib/mathlib/mathlib.h>
 #include <lib/perf/perf_counter.h>
 #include <px4_config.h>
 #include <px4_defines.h>
@@ -51,6 +52,9 @@
 #include <uORB/PublicationQueued.hpp>
 #include <uORB/topics/cpuload.h>
 #include <uORB/topics/task_stack_info.h>
+#include <uORB/topics/work_item_status.h>
+
+#include <string.h>
 
 #if defined(__PX4_NUTTX) && !defined(CONFIG_SCHED_INSTRUMENTATION)
 #  error load_mon support requires CONFIG_SCHED_INSTRUMENTATION
@@ -101,6 +105,12 @@ private:
 	/** Calculate the memory usage */
 	float _ram_used();
 
+	/** Publish the run statistics of the next work items */
+	void _work_item_status();
+
+	unsigned _work_item_index{0};
+	uORB::PublicationQueued<work_item_status_s> _work_item_status_pub{ORB_ID(work_item_status)};
+
 #ifdef __PX4_NUTTX
 	/* Calculate stack usage */
 	void _stack_usage();
@@ -162,6 +172,7 @@ LoadMon::start()
 void LoadMon::Run()
 {
 	_cpuload();
+	_work_item_status();
 
 #ifdef __PX4_NUTTX
 
@@ -224,6 +235,42 @@ float LoadMon::_ram_used()
 #endif
 }
 
+void LoadMon::_work_item_status()
+{
+	/* Publish maximum num_items_per_cycle work items to stay within the queue length. */
+	const unsigned num_items_per_cycle = work_item_status_s::ORB_QUEUE_LENGTH;
+
+	for (unsigned i = 0; i < num_items_per_cycle; i++) {
+		px4::wq_item_status_t item{};
+
+		if (!px4::WorkQueueManagerItemStatus(_work_item_index, item)) {
+			/* Past the last work item, start over next cycle. */
+			_work_item_index = 0;
+			break;
+		}
+
+		_work_item_index++;
+
+		work_item_status_s status{};
+		strncpy(status.name, item.name, sizeof(status.name) - 1);
+		strncpy(status.work_queue, item.wq_name, sizeof(status.work_queue) - 1);
+
+		const uint32_t runs = math::max(item.stats.run_count, (uint32_t)1);
+		status.run_count = item.stats.run_count;
+		status.latency_avg_us = item.stats.latency_sum_us / runs;
+		status.latency_max_us = item.stats.latency_max_us;
+		status.run_time_avg_us = item.stats.run_time_sum_us / runs;
+		status.run_time_max_us = item.stats.run_time_max_us;
+
+		static_assert(sizeof(status.latency_hist) == sizeof(item.stats.latency_hist), "histogram size mismatch");
+		memcpy(status.latency_hist, item.stats.latency_hist, sizeof(status.latency_hist));
+		memcpy(status.run_time_hist, item.stats.run_time_hist, sizeof(status.run_time_hist));
+
+		status.timestamp = hrt_absolute_time();
+		_work_item_status_pub.publish(status);
+	}
+}
+
 #ifdef __PX4_NUTTX
 void LoadMon::_stack_usage()
 {
@@ -326,7 +373,8 @@ int LoadMon::print_usage(const char *reason)
 		R"DESCR_STR(
 ### Description
 Background process running periodically with 1 Hz on the LP work queue to calculate the CPU load and RAM
-usage and publish the `cpuload` topic.
+usage and publish the `cpuload` topic. It also publishes the run statistics of all work items, a few per cycle,
+in the `work_item_status` topic.
 
 On NuttX it also checks the stack usage of each process and if it falls below 300 bytes, a warning is output,
 which will also appear in the log file.
@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file data_delta.h
+ * Delta encoding of ULog data messages (ULOG_INCOMPAT_FLAG0_DATA_DELTA_MASK).
+ *
+ * A DATA_DELTA message replaces a DATA message of the same msg_id. Its payload is a bitmap of the changed bytes
+ * (bit i & 7 of byte i / 8 is set if byte i changed), followed by the XOR of each changed byte with the previous
+ * sample of that msg_id. The decoder therefore needs the previous DATA or DATA_DELTA message of the same msg_id,
+ * which also defines the data size.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Encode a data message payload against the previous sample.
+ * @param reference previous sample
+ * @param data new sample
+ * @param size size of the samples
+ * @param out output buffer, at least size bytes
+ * @return encoded size, or 0 if the encoding is not smaller than the sample (write a full DATA message instead)
+ */
+static inline size_t ulog_data_delta_encode(const uint8_t *reference, const uint8_t *data, size_t size, uint8_t *out)
+{
+	const size_t bitmap_size = (size + 7) / 8;
+
+	if (bitmap_size >= size) {
+		return 0;
+	}
+
+	memset(out, 0, bitmap_size);
+	size_t out_size = bitmap_size;
+
+	for (size_t i = 0; i < size; ++i) {
+		const uint8_t x = data[i] ^ reference[i];
+
+		if (x != 0) {
+			if (out_size + 1 >= size) {
+				return 0;
+			}
+
+			out[i / 8] |= 1 << (i & 7);
+			out[out_size++] = x;
+		}
+	}
+
+	return out_size;
+}
+
+/**
+ * Decode a DATA_DELTA payload in place.
+ * @param reference previous sample, updated to the new sample
+ * @param size size of the samples
+ * @param in encoded payload
+ * @param in_size size of the encoded payload
+ * @return false if the payload does not match the sample size
+ */
+static inline bool ulog_data_delta_decode(uint8_t *reference, size_t size, const uint8_t *in, size_t in_size)
+{
+	const size_t bitmap_size = (size + 7) / 8;
+
+	if (in_size < bitmap_size) {
+		return false;
+	}
+
+	size_t in_pos = bitmap_size;
+
+	for (size_t i = 0; i < size; ++i) {
+		if (in[i / 8] & (1 << (i & 7))) {
+			if (in_pos >= in_size) {
+				return false;
+			}
+
+			reference[i] ^= in[in_pos++];
+		}
+	}
+
+	return in_pos == in_size;
+}
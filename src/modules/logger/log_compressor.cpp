@@ -0,0 +1,217 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "log_compressor.h"
+
+#include <string.h>
+
+namespace px4
+{
+namespace logger
+{
+
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t LAST_LITERALS = 5; ///< the last bytes of a block are always literals (LZ4 format)
+static constexpr size_t MATCH_FIND_LIMIT = 12; ///< the last match must start at least this many bytes before the end
+static constexpr size_t MAX_OFFSET = 65535;
+
+static inline uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/** worst case size of LZ4 compressed data */
+static constexpr size_t compress_bound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+LogCompressor::~LogCompressor()
+{
+	delete[] _hash_table;
+	delete[] _output;
+}
+
+bool LogCompressor::init(size_t max_block_size)
+{
+	if (max_block_size > 65536) {
+		return false;
+	}
+
+	if (_output) {
+		return _max_block_size == max_block_size;
+	}
+
+	_hash_table = new uint16_t[1 << _hash_bits];
+	_output = new uint8_t[sizeof(ulog_compressed_block_header_s) + compress_bound(max_block_size)];
+
+	if (!_hash_table || !_output) {
+		delete[] _hash_table;
+		delete[] _output;
+		_hash_table = nullptr;
+		_output = nullptr;
+		return false;
+	}
+
+	_max_block_size = max_block_size;
+	return true;
+}
+
+void LogCompressor::file_header(ulog_compressed_file_header_s &header) const
+{
+	const uint8_t magic[] = {'U', 'L', 'o', 'g', 'Z', 0x01, 0x12, 0x35};
+	memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = ULOG_COMPRESSED_VERSION;
+	header.codec = ULOG_COMPRESSED_CODEC_LZ4_BLOCK;
+	header.reserved = 0;
+	header.max_block_size = _max_block_size;
+}
+
+size_t LogCompressor::compress(const uint8_t *src, size_t size, const uint8_t **block)
+{
+	ulog_compressed_block_header_s header;
+	header.magic[0] = 'Z';
+	header.magic[1] = 'B';
+	header.flags = 0;
+	header.reserved = 0;
+	header.raw_size = size;
+
+	uint8_t *data = _output + sizeof(header);
+	size_t data_size = compress_lz4(src, size, data);
+
+	if (data_size >= size) {
+		// incompressible: store it as is
+		memcpy(data, src, size);
+		data_size = size;
+		header.flags |= ULOG_COMPRESSED_BLOCK_FLAG_STORED;
+	}
+
+	header.data_size = data_size;
+	memcpy(_output, &header, sizeof(header));
+
+	*block = _output;
+	return sizeof(header) + data_size;
+}
+
+/** write a length that did not fit into the token nibble */
+static inline uint8_t *write_length(uint8_t *op, size_t length)
+{
+	for (; length >= 255; length -= 255) {
+		*op++ = 255;
+	}
+
+	*op++ = (uint8_t)length;
+	return op;
+}
+
+static inline uint8_t *write_literals(uint8_t *op, uint8_t *token, const uint8_t *literals, size_t length)
+{
+	if (length >= 15) {
+		*token = 15 << 4;
+		op = write_length(op, length - 15);
+
+	} else {
+		*token = length << 4;
+	}
+
+	memcpy(op, literals, length);
+	return op + length;
+}
+
+size_t LogCompressor::compress_lz4(const uint8_t *src, size_t size, uint8_t *dst)
+{
+	uint8_t *op = dst;
+	size_t anchor = 0; // start of the pending literals
+
+	if (size >= MATCH_FIND_LIMIT + 1) {
+		memset(_hash_table, 0, sizeof(_hash_table[0]) << _hash_bits);
+
+		const size_t match_find_end = size - MATCH_FIND_LIMIT;
+		const size_t match_end = size - LAST_LITERALS;
+		size_t ip = 0;
+
+		while (ip <= match_find_end) {
+			const uint32_t sequence = read32(src + ip);
+			const uint32_t hash = (sequence * 2654435761u) >> (32 - _hash_bits);
+			size_t ref = _hash_table[hash];
+			_hash_table[hash] = ip;
+
+			if (ref >= ip || ip - ref > MAX_OFFSET || read32(src + ref) != sequence) {
+				// skip faster through data that does not compress
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			// extend the match backwards into the pending literals
+			while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+				--ip;
+				--ref;
+			}
+
+			size_t length = MIN_MATCH;
+
+			while (ip + length < match_end && src[ref + length] == src[ip + length]) {
+				++length;
+			}
+
+			uint8_t *token = op++;
+			op = write_literals(op, token, src + anchor, ip - anchor);
+
+			const size_t offset = ip - ref;
+			*op++ = offset & 0xff;
+			*op++ = offset >> 8;
+
+			if (length - MIN_MATCH >= 15) {
+				*token |= 15;
+				op = write_length(op, length - MIN_MATCH - 15);
+
+			} else {
+				*token |= length - MIN_MATCH;
+			}
+
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	uint8_t *token = op++;
+	op = write_literals(op, token, src + anchor, size - anchor);
+
+	return op - dst;
+}
+
+} // namespace logger
+} // namespace px4
@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace px4
+{
+namespace logger
+{
+
+/* compressed ULog container (.ulgz): the file header, followed by blocks. Decompressing all blocks in order and
+ * concatenating them gives the standard ULog file. See Tools/ulog_decompress.py. */
+
+#pragma pack(push, 1)
+
+struct ulog_compressed_file_header_s {
+	uint8_t magic[8]; ///< 'U', 'L', 'o', 'g', 'Z', 0x01, 0x12, 0x35
+	uint8_t version; ///< container version
+	uint8_t codec; ///< @see ULOG_COMPRESSED_CODEC_*
+	uint16_t reserved;
+	uint32_t max_block_size; ///< maximum uncompressed size of a block
+};
+
+struct ulog_compressed_block_header_s {
+	uint8_t magic[2]; ///< 'Z', 'B'
+	uint8_t flags; ///< @see ULOG_COMPRESSED_BLOCK_FLAG_*
+	uint8_t reserved;
+	uint32_t raw_size; ///< uncompressed size
+	uint32_t data_size; ///< size of the data following this header
+};
+
+#pragma pack(pop)
+
+#define ULOG_COMPRESSED_VERSION 1
+#define ULOG_COMPRESSED_CODEC_LZ4_BLOCK 1 ///< LZ4 block format, independent blocks
+#define ULOG_COMPRESSED_BLOCK_FLAG_STORED (1<<0) ///< data is not compressed (incompressible block)
+
+/**
+ * @class LogCompressor
+ * Fast LZ4 block format compressor for the ULog writer thread, with a fixed memory footprint.
+ * Blocks are compressed independently, so a truncated file can be decompressed up to the last complete block.
+ */
+class LogCompressor
+{
+public:
+	LogCompressor() = default;
+	~LogCompressor();
+
+	/**
+	 * allocate the buffers
+	 * @param max_block_size maximum uncompressed block size (at most 64 KiB)
+	 * @return true on success
+	 */
+	bool init(size_t max_block_size);
+
+	size_t max_block_size() const { return _max_block_size; }
+
+	/**
+	 * fill in the header for the beginning of the file
+	 */
+	void file_header(ulog_compressed_file_header_s &header) const;
+
+	/**
+	 * Compress a block. The result (including the block header) is valid until the next call.
+	 * @param src data
+	 * @param size data size, at most max_block_size()
+	 * @param block set to the compressed block
+	 * @return size of the compressed block, including the header
+	 */
+	size_t compress(const uint8_t *src, size_t size, const uint8_t **block);
+
+private:
+	size_t compress_lz4(const uint8_t *src, size_t size, uint8_t *dst);
+
+	static constexpr int _hash_bits = 12;
+
+	uint16_t *_hash_table{nullptr}; ///< last position of each hashed 4-byte sequence
+	uint8_t *_output{nullptr}; ///< block header + compressed data
+	size_t _max_block_size{0};
+};
+
+} // namespace logger
+} // namespace px4
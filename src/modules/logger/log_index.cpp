@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "log_index.h"
+
+#include <string.h>
+
+namespace px4
+{
+namespace logger
+{
+
+LogIndex::~LogIndex()
+{
+	delete[] _time_entries;
+	delete[] _first_data;
+	delete[] _additional;
+}
+
+bool LogIndex::init(int max_topics)
+{
+	if (!_time_entries) {
+		_time_entries = new TimeEntry[_max_time_entries];
+	}
+
+	if (!_first_data) {
+		_first_data = new DataEntry[max_topics];
+		_max_topics = _first_data ? max_topics : 0;
+	}
+
+	if (!_additional) {
+		_additional = new uint64_t[_max_additional_entries];
+	}
+
+	reset();
+	return _time_entries && _first_data && _additional;
+}
+
+void LogIndex::reset()
+{
+	_time_count = 0;
+	_time_interval = 1;
+	_time_skipped = 0;
+	_additional_count = 0;
+	_additional_overflow = false;
+
+	if (_first_data) {
+		memset(_first_data, 0, _max_topics * sizeof(DataEntry));
+	}
+}
+
+void LogIndex::add_time(uint64_t timestamp, uint64_t offset)
+{
+	if (!_time_entries) {
+		return;
+	}
+
+	if (++_time_skipped < _time_interval) {
+		return;
+	}
+
+	_time_skipped = 0;
+
+	if (_time_count == _max_time_entries) {
+		// table full: keep every other entry and halve the recording rate
+		for (int i = 0; i < _time_count / 2; ++i) {
+			_time_entries[i] = _time_entries[2 * i];
+		}
+
+		_time_count /= 2;
+		_time_interval *= 2;
+	}
+
+	_time_entries[_time_count].timestamp = timestamp;
+	_time_entries[_time_count].offset = offset;
+	++_time_count;
+}
+
+void LogIndex::add_additional(uint64_t offset)
+{
+	if (!_additional || (_additional_count > 0 && _additional[_additional_count - 1] == offset)) {
+		return;
+	}
+
+	if (_additional_count == _max_additional_entries) {
+		// unlike the time table, entries cannot be dropped
+		_additional_overflow = true;
+		return;
+	}
+
+	_additional[_additional_count++] = offset;
+}
+
+bool LogIndex::first_data(int topic_index, uint16_t &msg_id, uint64_t &offset) const
+{
+	if (!_first_data || topic_index >= _max_topics || _first_data[topic_index].offset == 0) {
+		return false;
+	}
+
+	msg_id = _first_data[topic_index].msg_id;
+	offset = _first_data[topic_index].offset;
+	return true;
+}
+
+} // namespace logger
+} // namespace px4
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace px4
+{
+namespace logger
+{
+
+/**
+ * @class LogIndex
+ * Collects file offsets while a full log is written, so that an index can be appended to the file when it is closed
+ * (@see ULOG_INDEX_KEY). Readers use it to seek to a point in time or to the first sample of a topic without parsing
+ * the whole file.
+ * The memory footprint is fixed: when the time table is full, every other entry is dropped and the recording
+ * interval is doubled, so that the entries stay evenly spread over the whole log.
+ */
+class LogIndex
+{
+public:
+	struct TimeEntry {
+		uint64_t timestamp;
+		uint64_t offset;
+	};
+
+	LogIndex() = default;
+	~LogIndex();
+
+	/**
+	 * allocate the tables (once)
+	 * @param max_topics maximum number of logged topics
+	 * @return true on success
+	 */
+	bool init(int max_topics);
+
+	/**
+	 * clear the index for a new log file
+	 */
+	void reset();
+
+	/**
+	 * record a time entry. Called periodically (e.g. with each SYNC message).
+	 */
+	void add_time(uint64_t timestamp, uint64_t offset);
+
+	/**
+	 * @return true if the offset of the first data message of a topic is still needed
+	 */
+	bool needs_first_data(int topic_index) const
+	{
+		return _first_data && topic_index < _max_topics && _first_data[topic_index].offset == 0;
+	}
+
+	void set_first_data(int topic_index, uint16_t msg_id, uint64_t offset)
+	{
+		if (needs_first_data(topic_index)) {
+			_first_data[topic_index].offset = offset;
+			_first_data[topic_index].msg_id = msg_id;
+		}
+	}
+
+	const TimeEntry *time_entries() const { return _time_entries; }
+	int time_entries_count() const { return _time_count; }
+
+	/**
+	 * get the first data entry of a topic
+	 * @return false if the topic has no data
+	 */
+	bool first_data(int topic_index, uint16_t &msg_id, uint64_t &offset) const;
+
+	int max_topics() const { return _max_topics; }
+
+	/**
+	 * record the offset of a message without timestamp that readers handle in file order (a parameter change, a
+	 * dropout or a topic added during logging). Consecutive such messages only need the offset of the first.
+	 */
+	void add_additional(uint64_t offset);
+
+	const uint64_t *additional_entries() const { return _additional; }
+	int additional_count() const { return _additional_count; }
+
+	/**
+	 * @return true if all recorded messages fit into the table, so that readers can rely on it
+	 */
+	bool additional_complete() const { return _additional && !_additional_overflow; }
+
+private:
+	struct DataEntry {
+		uint64_t offset; ///< 0 if not set (the file header is always at the beginning)
+		uint16_t msg_id;
+	};
+
+#ifdef __PX4_NUTTX
+	static constexpr int _max_time_entries = 128;
+	static constexpr int _max_additional_entries = 128;
+#else
+	static constexpr int _max_time_entries = 4096;
+	static constexpr int _max_additional_entries = 4096;
+#endif
+
+	TimeEntry *_time_entries{nullptr};
+	int _time_count{0};
+	int _time_interval{1}; ///< record every n-th call to add_time()
+	int _time_skipped{0};
+
+	DataEntry *_first_data{nullptr};
+	int _max_topics{0};
+
+	uint64_t *_additional{nullptr};
+	int _additional_count{0};
+	bool _additional_overflow{false};
+};
+
+} // namespace logger
+} // namespace px4
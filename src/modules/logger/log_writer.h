@@ -102,6 +102,20 @@ public:
 
 	/* file logging methods */
 
+	/** @see LogWriterFile::set_write_mode() */
+	void set_file_write_mode(WriteMode mode)
+	{
+		if (_log_writer_file) { _log_writer_file->set_write_mode(mode); }
+	}
+
+	/** @see LogWriterFile::set_compression() */
+	bool set_file_compression(bool enable)
+	{
+		if (_log_writer_file) { return _log_writer_file->set_compression(enable); }
+
+		return false;
+	}
+
 	void lock()
 	{
 		if (_log_writer_file) { _log_writer_file->lock(); }
@@ -124,6 +138,13 @@ public:
 		return 0;
 	}
 
+	size_t get_total_written_compressed_file(LogType type) const
+	{
+		if (_log_writer_file) { return _log_writer_file->get_total_written_compressed(type); }
+
+		return 0;
+	}
+
 	size_t get_buffer_size_file(LogType type) const
 	{
 		if (_log_writer_file) { return _log_writer_file->get_buffer_size(type); }
@@ -37,6 +37,7 @@
 #include <fcntl.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 
 #include <mathlib/mathlib.h>
 #include <px4_posix.h>
@@ -52,18 +53,30 @@ namespace px4
 namespace logger
 {
 constexpr size_t LogWriterFile::_min_write_chunk;
+constexpr size_t LogWriterFile::_compress_block_size;
+constexpr size_t LogWriterFile::_preallocate_size;
+constexpr hrt_abstime LogWriterFile::_sync_interval;
+constexpr hrt_abstime LogWriterFile::_sync_interval_max;
+
+/** round up to a multiple of the write chunk, so that chunks never wrap around the end of the buffer */
+static constexpr size_t round_up_to_chunk(size_t size, size_t chunk)
+{
+	return (size + chunk - 1) / chunk * chunk;
+}
 
 LogWriterFile::LogWriterFile(size_t buffer_size)
 	: _buffers{
 	//We always write larger chunks (orb messages) to the buffer, so the buffer
 	//needs to be larger than the minimum write chunk (300 is somewhat arbitrary)
 	{
-		math::max(buffer_size, _min_write_chunk + 300),
-		perf_alloc(PC_ELAPSED, "logger_sd_write"), perf_alloc(PC_ELAPSED, "logger_sd_fsync")},
+		round_up_to_chunk(math::max(buffer_size, _min_write_chunk + 300), _min_write_chunk),
+		perf_alloc(PC_ELAPSED, "logger_sd_write"), perf_alloc(PC_ELAPSED, "logger_sd_fsync"),
+		perf_alloc(PC_ELAPSED, "logger_compress")},
 
 	{
 		300, // buffer size for the mission log (can be kept fairly small)
-		perf_alloc(PC_ELAPSED, "logger_sd_write_mission"), perf_alloc(PC_ELAPSED, "logger_sd_fsync_mission")}
+		perf_alloc(PC_ELAPSED, "logger_sd_write_mission"), perf_alloc(PC_ELAPSED, "logger_sd_fsync_mission"),
+		nullptr}
 }
 {
 	pthread_mutex_init(&_mtx, nullptr);
@@ -247,11 +260,23 @@ void LogWriterFile::run()
 				LogFileBuffer &buffer = _buffers[i];
 				size_t available = buffer.get_read_ptr(&read_ptr, &is_part);
 
+				/* in aligned mode, only write whole chunks (unless terminating), so that the file offset
+				 * stays block-aligned. A wrapped part always ends on a chunk boundary, because the buffer
+				 * size is a multiple of the chunk size. */
+				size_t write_size = available;
+
+				if (buffer.aligned() && buffer._should_run && !is_part) {
+					write_size -= available % _min_write_chunk;
+				}
+
+				/* aligned mode syncs on its own cadence, which avoids stalling on sync during write bursts */
+				const bool call_sync = buffer.aligned() ? buffer.sync_due(now) : call_fsync;
+
 				/* if sufficient data available or partial read or terminating, write data */
-				if (available >= min_available[i] || is_part || (!buffer._should_run && available > 0)) {
+				if (write_size >= min_available[i] || is_part || (!buffer._should_run && available > 0)) {
 					pthread_mutex_unlock(&_mtx);
 
-					written = buffer.write_to_file(read_ptr, available, call_fsync);
+					written = buffer.write_to_file(read_ptr, write_size, call_sync);
 
 					/* buffer.mark_read() requires _mtx to be locked */
 					pthread_mutex_lock(&_mtx);
@@ -271,7 +296,7 @@ void LogWriterFile::run()
 						buffer.close_file();
 					}
 
-				} else if (call_fsync && buffer._should_run) {
+				} else if (call_sync && buffer._should_run) {
 					pthread_mutex_unlock(&_mtx);
 					buffer.fsync();
 					pthread_mutex_lock(&_mtx);
@@ -386,8 +411,8 @@ const char *log_type_str(LogType type)
 }
 
 LogWriterFile::LogFileBuffer::LogFileBuffer(size_t log_buffer_size, perf_counter_t perf_write,
-		perf_counter_t perf_fsync)
-	: _buffer_size(log_buffer_size), _perf_write(perf_write), _perf_fsync(perf_fsync)
+		perf_counter_t perf_fsync, perf_counter_t perf_compress)
+	: _buffer_size(log_buffer_size), _perf_write(perf_write), _perf_fsync(perf_fsync), _perf_compress(perf_compress)
 {
 }
 
@@ -397,10 +422,12 @@ LogWriterFile::LogFileBuffer::~LogFileBuffer()
 		close(_fd);
 	}
 
-	delete[] _buffer;
+	delete[] _buffer_alloc;
+	delete _compressor;
 
 	perf_free(_perf_write);
 	perf_free(_perf_fsync);
+	perf_free(_perf_compress);
 }
 
 void LogWriterFile::LogFileBuffer::write_no_check(void *ptr, size_t size)
@@ -445,7 +472,34 @@ size_t LogWriterFile::LogFileBuffer::get_read_ptr(void **ptr, bool *is_part)
 
 bool LogWriterFile::LogFileBuffer::start_log(const char *filename)
 {
-	_fd = ::open(filename, O_CREAT | O_WRONLY, PX4_O_MODE_666);
+	_aligned = _write_mode != WriteMode::Stream;
+	_direct = false;
+
+#if defined(__PX4_LINUX)
+
+	if (_write_mode == WriteMode::Direct && _compressor) {
+		PX4_WARN("O_DIRECT not supported with compression, using aligned writes");
+
+	} else if (_write_mode == WriteMode::Direct) {
+		_fd = ::open(filename, O_CREAT | O_WRONLY | O_DIRECT, PX4_O_MODE_666);
+		_direct = _fd >= 0;
+
+		if (!_direct) {
+			PX4_WARN("O_DIRECT not supported (%i), using aligned writes", errno);
+		}
+	}
+
+#else
+
+	if (_write_mode == WriteMode::Direct) {
+		PX4_WARN("O_DIRECT not supported, using aligned writes");
+	}
+
+#endif /* __PX4_LINUX */
+
+	if (_fd < 0) {
+		_fd = ::open(filename, O_CREAT | O_WRONLY, PX4_O_MODE_666);
+	}
 
 	if (_fd < 0) {
 		PX4_ERR("Can't open log file %s, errno: %d", filename, errno);
@@ -453,38 +507,160 @@ bool LogWriterFile::LogFileBuffer::start_log(const char *filename)
 	}
 
 	if (_buffer == nullptr) {
-		_buffer = new uint8_t[_buffer_size];
+		// O_DIRECT needs the memory to be aligned as well
+		const size_t alignment = _write_mode == WriteMode::Direct ? _min_write_chunk : 1;
+		_buffer_alloc = new uint8_t[_buffer_size + alignment - 1];
 
-		if (_buffer == nullptr) {
+		if (_buffer_alloc == nullptr) {
 			PX4_ERR("Can't create log buffer");
 			::close(_fd);
 			_fd = -1;
 			return false;
 		}
+
+		_buffer = (uint8_t *)(((uintptr_t)_buffer_alloc + alignment - 1) & ~(uintptr_t)(alignment - 1));
 	}
 
 	// Clear buffer and counters
 	_head = 0;
 	_count = 0;
 	_total_written = 0;
+	_file_written = 0;
+	_preallocated = 0;
+	_last_sync = hrt_absolute_time();
+
+	if (_compressor) {
+		ulog_compressed_file_header_s header;
+		_compressor->file_header(header);
+
+		if (write_all(&header, sizeof(header)) != 0) {
+			PX4_ERR("Can't write log file header, errno: %d", errno);
+			::close(_fd);
+			_fd = -1;
+			return false;
+		}
+
+		_file_written = sizeof(header);
+	}
+
+	if (_aligned) {
+		preallocate(_preallocate_size);
+	}
 
 	_should_run = true;
 
 	return true;
 }
 
-void LogWriterFile::LogFileBuffer::fsync() const
+bool LogWriterFile::LogFileBuffer::set_compression(bool enable)
+{
+	if (!enable) {
+		delete _compressor;
+		_compressor = nullptr;
+		return false;
+	}
+
+	if (_compressor == nullptr) {
+		_compressor = new LogCompressor();
+
+		if (_compressor == nullptr || !_compressor->init(_compress_block_size)) {
+			PX4_ERR("compressor allocation failed");
+			delete _compressor;
+			_compressor = nullptr;
+		}
+	}
+
+	return _compressor != nullptr;
+}
+
+void LogWriterFile::LogFileBuffer::preallocate(size_t end)
+{
+#if defined(__PX4_LINUX)
+
+	if (_preallocated >= end) {
+		return;
+	}
+
+	// keep the file size, so that the file is consistent even if it is not closed properly
+	if (fallocate(_fd, FALLOC_FL_KEEP_SIZE, _preallocated, end - _preallocated) == 0) {
+		_preallocated = end;
+
+	} else if (_preallocated == 0) {
+		PX4_WARN("file preallocation not supported (%i)", errno);
+	}
+
+#endif /* __PX4_LINUX */
+}
+
+bool LogWriterFile::LogFileBuffer::sync_due(hrt_abstime now) const
+{
+	// prefer to sync when the buffer is drained, but don't postpone it forever
+	return (now - _last_sync > _sync_interval && _count < _min_write_chunk) || now - _last_sync > _sync_interval_max;
+}
+
+void LogWriterFile::LogFileBuffer::fsync()
 {
 	perf_begin(_perf_fsync);
+#if defined(__PX4_NUTTX) || defined(__PX4_DARWIN)
+	// no fdatasync()
 	::fsync(_fd);
+#else
+
+	if (_aligned) {
+		// the file size only changes together with the data, so the metadata can be skipped
+		::fdatasync(_fd);
+
+	} else {
+		::fsync(_fd);
+	}
+
+#endif /* __PX4_NUTTX || __PX4_DARWIN */
+	_last_sync = hrt_absolute_time();
 	perf_end(_perf_fsync);
 }
 
-ssize_t LogWriterFile::LogFileBuffer::write_to_file(const void *buffer, size_t size, bool call_fsync) const
+ssize_t LogWriterFile::LogFileBuffer::write_to_file(const void *buffer, size_t size, bool call_fsync)
 {
-	perf_begin(_perf_write);
-	ssize_t ret = ::write(_fd, buffer, size);
-	perf_end(_perf_write);
+	if (_aligned) {
+		if (_preallocated > 0 && _file_written + size > _preallocated) {
+			preallocate(_preallocated + _preallocate_size);
+		}
+
+#if defined(__PX4_LINUX)
+
+		if (_direct && size % _min_write_chunk != 0) {
+			// the last write of a file is not a whole chunk, which O_DIRECT does not allow
+			fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+			_direct = false;
+		}
+
+#endif /* __PX4_LINUX */
+	}
+
+	ssize_t ret;
+
+	if (_compressor) {
+		ret = write_compressed((const uint8_t *)buffer, size);
+
+	} else if (_aligned) {
+		// a partial write would leave the file offset unaligned, so always write the whole chunk
+		perf_begin(_perf_write);
+		ret = (write_all(buffer, size) == 0) ? size : -1;
+		perf_end(_perf_write);
+
+		if (ret > 0) {
+			_file_written += ret;
+		}
+
+	} else {
+		perf_begin(_perf_write);
+		ret = ::write(_fd, buffer, size);
+		perf_end(_perf_write);
+
+		if (ret > 0) {
+			_file_written += ret;
+		}
+	}
 
 	if (call_fsync) {
 		fsync();
@@ -493,12 +669,75 @@ ssize_t LogWriterFile::LogFileBuffer::write_to_file(const void *buffer, size_t s
 	return ret;
 }
 
+int LogWriterFile::LogFileBuffer::write_all(const void *buffer, size_t size)
+{
+	const uint8_t *ptr = (const uint8_t *)buffer;
+
+	while (size > 0) {
+		ssize_t ret = ::write(_fd, ptr, size);
+
+		if (ret <= 0) {
+			return -1;
+		}
+
+		ptr += ret;
+		size -= ret;
+
+#if defined(__PX4_LINUX)
+
+		if (_direct && size > 0) {
+			// the rest is not block-aligned anymore, which O_DIRECT does not allow
+			fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+			_direct = false;
+		}
+
+#endif /* __PX4_LINUX */
+	}
+
+	return 0;
+}
+
+ssize_t LogWriterFile::LogFileBuffer::write_compressed(const uint8_t *buffer, size_t size)
+{
+	size_t consumed = 0;
+
+	while (consumed < size) {
+		const size_t raw_size = math::min(size - consumed, _compressor->max_block_size());
+		const uint8_t *block;
+
+		perf_begin(_perf_compress);
+		const size_t block_size = _compressor->compress(buffer + consumed, raw_size, &block);
+		perf_end(_perf_compress);
+
+		// a block must be written completely, otherwise the rest of the file cannot be decoded
+		perf_begin(_perf_write);
+		const int ret = write_all(block, block_size);
+		perf_end(_perf_write);
+
+		if (ret != 0) {
+			return -1;
+		}
+
+		_file_written += block_size;
+		consumed += raw_size;
+	}
+
+	return consumed;
+}
+
 void LogWriterFile::LogFileBuffer::close_file()
 {
 	_head = 0;
 	_count = 0;
 
 	if (_fd >= 0) {
+		if (_preallocated > _file_written) {
+			// release the reserved space beyond the end of the file
+			if (ftruncate(_fd, _file_written) != 0) {
+				PX4_WARN("truncating log file failed (%i)", errno);
+			}
+		}
+
 		int res = close(_fd);
 		_fd = -1;
 
@@ -507,6 +746,10 @@ void LogWriterFile::LogFileBuffer::close_file()
 
 		} else {
 			PX4_INFO("closed logfile, bytes written: %zu", _total_written);
+
+			if (_compressor && _file_written > 0) {
+				PX4_INFO("compressed to %zu bytes (ratio %.2f)", _file_written, (double)_total_written / _file_written);
+			}
 		}
 	}
 }
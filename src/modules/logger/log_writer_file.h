@@ -39,6 +39,8 @@
 #include <drivers/drv_hrt.h>
 #include <perf/perf_counter.h>
 
+#include "log_compressor.h"
+
 namespace px4
 {
 namespace logger
@@ -57,6 +59,16 @@ enum class LogType {
 
 const char *log_type_str(LogType type);
 
+/**
+ * @enum WriteMode
+ * Defines how the writer thread writes the full log to the file
+ */
+enum class WriteMode : int32_t {
+	Stream = 0, //!< write whatever is in the buffer, fsync periodically
+	Aligned,    //!< preallocated file, block-aligned chunk writes, fdatasync on a separate cadence
+	Direct,     //!< like Aligned, but bypass the page cache with O_DIRECT (Linux only)
+};
+
 /**
  * @class LogWriterFile
  * Writes logging data to a file
@@ -69,6 +81,18 @@ public:
 
 	bool init();
 
+	/**
+	 * Select the write strategy of the full log (the mission log is always streamed).
+	 * Must be called before the first log is started.
+	 */
+	void set_write_mode(WriteMode mode) { _buffers[(int)LogType::Full].set_write_mode(mode); }
+
+	/**
+	 * Enable compression of the full log (@see LogCompressor). Must be called before the first log is started.
+	 * @return true if compression is enabled (false if the allocation failed)
+	 */
+	bool set_compression(bool enable) { return _buffers[(int)LogType::Full].set_compression(enable); }
+
 	/**
 	 * start the thread
 	 * @return 0 on success, error number otherwise (@see pthread_create)
@@ -106,6 +130,12 @@ public:
 		return _buffers[(int)type].total_written();
 	}
 
+	/** number of bytes written to the compressed file, 0 if not compressing */
+	size_t get_total_written_compressed(LogType type) const
+	{
+		return _buffers[(int)type].compressed() ? _buffers[(int)type].file_written() : 0;
+	}
+
 	size_t get_buffer_size(LogType type) const
 	{
 		return _buffers[(int)type].buffer_size();
@@ -149,10 +179,25 @@ private:
 	/* 512 didn't seem to work properly, 4096 should match the FAT cluster size */
 	static constexpr size_t	_min_write_chunk = 4096;
 
+	/* maximum uncompressed size of a compressed block */
+#if defined(__PX4_NUTTX)
+	static constexpr size_t	_compress_block_size = 8 * 1024;
+#else
+	static constexpr size_t	_compress_block_size = 32 * 1024;
+#endif
+
+	/* aligned write mode: extend the file reservation in steps of this size (Linux only) */
+	static constexpr size_t	_preallocate_size = 16 * 1024 * 1024;
+
+	/* aligned write mode: fdatasync at most this often, unless the buffer is busy (then up to _sync_interval_max) */
+	static constexpr hrt_abstime _sync_interval = 1000000;
+	static constexpr hrt_abstime _sync_interval_max = 5000000;
+
 	class LogFileBuffer
 	{
 	public:
-		LogFileBuffer(size_t log_buffer_size, perf_counter_t perf_write, perf_counter_t perf_fsync);
+		LogFileBuffer(size_t log_buffer_size, perf_counter_t perf_write, perf_counter_t perf_fsync,
+			      perf_counter_t perf_compress);
 
 		~LogFileBuffer();
 
@@ -171,27 +216,66 @@ private:
 
 		int fd() const { return _fd; }
 
-		inline ssize_t write_to_file(const void *buffer, size_t size, bool call_fsync) const;
+		void set_write_mode(WriteMode mode) { _write_mode = mode; }
+
+		bool set_compression(bool enable);
+
+		bool compressed() const { return _compressor != nullptr; }
+
+		/** true if the currently open file is written in block-aligned chunks */
+		bool aligned() const { return _aligned; }
 
-		inline void fsync() const;
+		/** aligned mode: whether it's time for an fdatasync */
+		bool sync_due(hrt_abstime now) const;
+
+		inline ssize_t write_to_file(const void *buffer, size_t size, bool call_fsync);
+
+		inline void fsync();
 
 		void mark_read(size_t n) { _count -= n; _total_written += n; }
 
 		size_t total_written() const { return _total_written; }
+		size_t file_written() const { return _file_written; }
 		size_t buffer_size() const { return _buffer_size; }
 		size_t count() const { return _count; }
 
 		bool _should_run = false;
 
 	private:
+		/**
+		 * aligned mode: reserve file space ahead of the write position (Linux only)
+		 */
+		void preallocate(size_t end);
+
+		/**
+		 * write all data, retrying on partial writes (which end O_DIRECT, as the rest is unaligned)
+		 * @return 0 on success, -1 on error (errno is set)
+		 */
+		int write_all(const void *buffer, size_t size);
+
+		/**
+		 * compress the data into blocks and write them
+		 * @return size (the number of uncompressed bytes consumed), or -1 on error
+		 */
+		ssize_t write_compressed(const uint8_t *buffer, size_t size);
+
 		const size_t _buffer_size;
 		int	_fd = -1;
+		uint8_t *_buffer_alloc = nullptr; ///< allocation of _buffer, which might be offset for alignment
 		uint8_t *_buffer = nullptr;
+		WriteMode _write_mode = WriteMode::Stream;
+		bool _aligned = false;
+		bool _direct = false; ///< file opened with O_DIRECT
+		size_t _preallocated = 0; ///< file space reserved so far, 0 if not supported
+		hrt_abstime _last_sync = 0;
 		size_t _head = 0; ///< next position to write to
 		size_t _count = 0; ///< number of bytes in _buffer to be written
 		size_t _total_written = 0;
+		size_t _file_written = 0; ///< bytes written to the file (differs from _total_written if compressed)
+		LogCompressor *_compressor = nullptr; ///< set if compression is enabled
 		perf_counter_t _perf_write;
 		perf_counter_t _perf_fsync;
+		perf_counter_t _perf_compress;
 	};
 
 	LogFileBuffer _buffers[(int)LogType::Count];
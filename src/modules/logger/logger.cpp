@@ -34,6 +34,7 @@
 #include <px4_config.h>
 #include <px4_console_buffer.h>
 #include "logger.h"
+#include "data_delta.h"
 #include "messages.h"
 #include "watchdog.h"
 
@@ -198,6 +199,18 @@ int Logger::print_status()
 		PX4_INFO("Not logging");
 	}
 
+	if (_drain_queues && _drained_samples_start != 0) {
+		float seconds = ((float)(hrt_absolute_time() - _drained_samples_start)) / 1000000.0f;
+		PX4_INFO("Drained samples: %u (%.1f/s)", (unsigned)_drained_samples,
+			 (double)(seconds > 0.f ? _drained_samples / seconds : 0.f));
+
+		for (const LoggerSubscription &sub : _subscriptions) {
+			if (sub.lost_messages > 0) {
+				PX4_INFO("  %s %i: %u lost", sub.get_topic()->o_name, sub.get_instance(), (unsigned)sub.lost_messages);
+			}
+		}
+	}
+
 	return 0;
 }
 
@@ -223,6 +236,13 @@ void Logger::print_statistics(LogType type)
 		PX4_INFO("Wrote %4.2f MiB (avg %5.2f KiB/s)", (double)mebibytes, (double)(kibibytes / seconds));
 	}
 
+	const size_t compressed = _writer.get_total_written_compressed_file(type);
+
+	if (compressed > 0) {
+		PX4_INFO("Compressed to %4.2f KiB (ratio %.2f)", (double)(compressed / 1024.0f),
+			 (double)(_writer.get_total_written_file(type) / (float)compressed));
+	}
+
 	PX4_INFO("Since last status: dropouts: %zu (max len: %.3f s), max used buffer: %zu / %zu B",
 		 stats.write_dropouts, (double)stats.max_dropout_duration, stats.high_water, _writer.get_buffer_size_file(type));
 	stats.high_water = 0;
@@ -241,12 +261,13 @@ Logger *Logger::instantiate(int argc, char *argv[])
 	bool log_name_timestamp = false;
 	LogWriter::Backend backend = LogWriter::BackendAll;
 	const char *poll_topic = nullptr;
+	bool drain_queues = false;
 
 	int myoptind = 1;
 	int ch;
 	const char *myoptarg = nullptr;
 
-	while ((ch = px4_getopt(argc, argv, "r:b:etfm:p:x", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "r:b:etfm:p:qx", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'r': {
 				unsigned long r = strtoul(myoptarg, nullptr, 10);
@@ -308,6 +329,10 @@ Logger *Logger::instantiate(int argc, char *argv[])
 			poll_topic = myoptarg;
 			break;
 
+		case 'q':
+			drain_queues = true;
+			break;
+
 		case '?':
 			error_flag = true;
 			break;
@@ -328,11 +353,17 @@ Logger *Logger::instantiate(int argc, char *argv[])
 		}
 	}
 
+	if (drain_queues && poll_topic) {
+		PX4_ERR("-q and -p are mutually exclusive");
+		error_flag = true;
+	}
+
 	if (error_flag) {
 		return nullptr;
 	}
 
-	Logger *logger = new Logger(backend, log_buffer_size, log_interval, poll_topic, log_mode, log_name_timestamp);
+	Logger *logger = new Logger(backend, log_buffer_size, log_interval, poll_topic, log_mode, log_name_timestamp,
+				    drain_queues);
 
 #if defined(DBGPRINT) && defined(__PX4_NUTTX)
 	struct mallinfo alloc_info = mallinfo();
@@ -361,17 +392,44 @@ Logger *Logger::instantiate(int argc, char *argv[])
 
 
 Logger::Logger(LogWriter::Backend backend, size_t buffer_size, uint32_t log_interval, const char *poll_topic_name,
-	       LogMode log_mode, bool log_name_timestamp) :
+	       LogMode log_mode, bool log_name_timestamp, bool drain_queues) :
 	_log_mode(log_mode),
 	_log_name_timestamp(log_name_timestamp),
 	_writer(backend, buffer_size),
-	_log_interval(log_interval)
+	_log_interval(log_interval),
+	_drain_queues(drain_queues)
 {
 	_log_utc_offset = param_find("SDLOG_UTC_OFFSET");
 	_log_dirs_max = param_find("SDLOG_DIRS_MAX");
 	_sdlog_profile_handle = param_find("SDLOG_PROFILE");
 	_mission_log = param_find("SDLOG_MISSION");
 
+	param_t write_mode_param = param_find("SDLOG_WR_MODE");
+	int32_t write_mode = 0;
+
+	if (write_mode_param != PARAM_INVALID && param_get(write_mode_param, &write_mode) == 0
+	    && write_mode >= (int32_t)WriteMode::Stream && write_mode <= (int32_t)WriteMode::Direct) {
+		_writer.set_file_write_mode((WriteMode)write_mode);
+	}
+
+	param_t delta_param = param_find("SDLOG_DELTA");
+	int32_t delta = 0;
+
+	if (delta_param != PARAM_INVALID && param_get(delta_param, &delta) == 0 && delta != 0) {
+		_delta_references = new DeltaReference[MAX_TOPICS_NUM];
+
+		if (!_delta_references) {
+			PX4_ERR("failed to alloc delta references");
+		}
+	}
+
+	param_t compress_param = param_find("SDLOG_COMPRESS");
+	int32_t compress = 0;
+
+	if (compress_param != PARAM_INVALID && param_get(compress_param, &compress) == 0 && compress != 0) {
+		_compress_log = _writer.set_file_compression(true);
+	}
+
 	if (poll_topic_name) {
 		const orb_metadata *const *topics = orb_get_topics();
 
@@ -397,6 +455,16 @@ Logger::~Logger()
 	if (_msg_buffer) {
 		delete[](_msg_buffer);
 	}
+
+	if (_delta_references) {
+		for (size_t i = 0; i < MAX_TOPICS_NUM; ++i) {
+			delete[] _delta_references[i].data;
+		}
+
+		delete[] _delta_references;
+	}
+
+	delete[] _delta_buffer;
 }
 
 bool Logger::request_stop_static()
@@ -492,8 +560,16 @@ bool Logger::copy_if_updated(int sub_idx, void *buffer, bool try_to_subscribe)
 
 	} else if (try_to_subscribe) {
 		if (sub.subscribe()) {
+			// topics subscribed during logging are listed in the index, so that readers seeking past them still add them
+			const bool index_add_logged = _writer.is_started(LogType::Full, LogWriter::BackendFile);
+			const uint64_t offset = index_add_logged ? full_log_file_offset() : 0;
+
 			write_add_logged_msg(LogType::Full, sub);
 
+			if (index_add_logged && full_log_file_offset() != offset) {
+				_log_index.add_additional(offset);
+			}
+
 			if (sub_idx < _num_mission_subs) {
 				write_add_logged_msg(LogType::Mission, sub);
 			}
@@ -506,6 +582,124 @@ bool Logger::copy_if_updated(int sub_idx, void *buffer, bool try_to_subscribe)
 	return updated;
 }
 
+void Logger::update_drain_callbacks(bool enable, px4_sem_t *semaphore)
+{
+	for (int sub_idx = 0; sub_idx < (int)_subscriptions.size(); ++sub_idx) {
+		LoggerSubscription &sub = _subscriptions[sub_idx];
+
+		// with a single element queue there is nothing to drain beyond the latest sample
+		if (!sub.full_rate() || !sub.valid() || sub.get_queue_size() <= 1) {
+			continue;
+		}
+
+		if (_drain_callbacks[sub_idx] == nullptr) {
+			_drain_callbacks[sub_idx] = new LoggerDrainCallback(sub, semaphore);
+
+			if (_drain_callbacks[sub_idx] == nullptr) {
+				continue;
+			}
+		}
+
+		LoggerDrainCallback *callback = _drain_callbacks[sub_idx];
+
+		if (enable && !callback->registered) {
+			callback->registered = callback->register_callback_if_exists();
+
+		} else if (!enable && callback->registered) {
+			callback->unregister_callback();
+			callback->registered = false;
+		}
+	}
+}
+
+void Logger::write_lost_messages(LogType type)
+{
+	int count = 0;
+
+	for (const LoggerSubscription &sub : _subscriptions) {
+		if (sub.lost_messages > 0) {
+			char buffer[64];
+			snprintf(buffer, sizeof(buffer), "%s %i: %u", sub.get_topic()->o_name, sub.get_instance(),
+				 (unsigned)sub.lost_messages);
+			write_info_multiple(type, "lost_messages", buffer, count != 0);
+			++count;
+		}
+	}
+}
+
+void Logger::write_index()
+{
+	const int time_count = _log_index.time_entries_count();
+
+	if (time_count == 0) {
+		return;
+	}
+
+	// the offsets are only valid for the file (a MAVLink stream has different offsets)
+	_writer.select_write_backend(LogWriter::BackendFile);
+
+	_writer.lock();
+	const uint64_t index_offset = full_log_file_offset();
+	_writer.unlock();
+
+	static constexpr int max_values = 16; // values per message
+	uint64_t values[max_values];
+	int num_values = 0;
+	bool is_continued = false;
+
+	const LogIndex::TimeEntry *time_entries = _log_index.time_entries();
+
+	for (int i = 0; i < time_count; ++i) {
+		values[num_values++] = time_entries[i].timestamp;
+		values[num_values++] = time_entries[i].offset;
+
+		if (num_values == max_values || i == time_count - 1) {
+			write_info_multiple(LogType::Full, ULOG_INDEX_TIME_KEY, values, num_values, is_continued);
+			is_continued = true;
+			num_values = 0;
+		}
+	}
+
+	is_continued = false;
+
+	for (int i = 0; i < _log_index.max_topics(); ++i) {
+		uint16_t msg_id;
+		uint64_t offset;
+
+		if (_log_index.first_data(i, msg_id, offset)) {
+			values[num_values++] = msg_id;
+			values[num_values++] = offset;
+		}
+
+		if (num_values == max_values || (i == _log_index.max_topics() - 1 && num_values > 0)) {
+			write_info_multiple(LogType::Full, ULOG_INDEX_DATA_KEY, values, num_values, is_continued);
+			is_continued = true;
+			num_values = 0;
+		}
+	}
+
+	// readers rely on it instead of parsing the file for parameter changes, so it's only written if complete
+	if (_log_index.additional_complete()) {
+		const uint64_t *additional = _log_index.additional_entries();
+		const int additional_count = _log_index.additional_count();
+		int i = 0;
+
+		do {
+			num_values = math::min(additional_count - i, max_values);
+			write_info_multiple(LogType::Full, ULOG_INDEX_ADDITIONAL_KEY, additional + i, num_values, i > 0);
+			i += num_values;
+		} while (i < additional_count);
+
+	} else {
+		PX4_WARN("too many parameter changes, dropouts and added topics for the log index");
+	}
+
+	// fixed-size footer, so that readers can find the index from the end of the file
+	write_info_template<uint64_t>(LogType::Full, "ulog_index", index_offset, "uint64_t");
+
+	_writer.unselect_write_backend();
+}
+
 void Logger::add_default_topics()
 {
 	add_topic("actuator_controls_0", 100);
@@ -549,6 +743,7 @@ void Logger::add_default_topics()
 	add_topic("vehicle_status", 200);
 	add_topic("vehicle_status_flags");
 	add_topic("vtol_vehicle_status", 200);
+	add_topic("work_item_status");
 
 	add_topic_multi("actuator_outputs", 100);
 	add_topic_multi("battery_status", 500);
@@ -884,6 +1079,17 @@ void Logger::run()
 			PX4_ERR("failed to alloc message buffer");
 			return;
 		}
+
+		if (_delta_references) {
+			// a DATA_DELTA message is always smaller than the DATA message
+			delete[] _delta_buffer;
+			_delta_buffer = new uint8_t[_msg_buffer_len];
+
+			if (!_delta_buffer) {
+				PX4_ERR("failed to alloc message buffer");
+				return;
+			}
+		}
 	}
 
 
@@ -962,6 +1168,10 @@ void Logger::run()
 
 		if (_writer.is_started(LogType::Full)) { // mission log only runs when full log is also started
 
+			if (_drain_queues) {
+				update_drain_callbacks(true, &timer_callback_data.semaphore);
+			}
+
 			/* check if we need to output the process load */
 			if (_next_load_print != 0 && loop_time >= _next_load_print) {
 				_next_load_print = 0;
@@ -994,7 +1204,28 @@ void Logger::run()
 				 */
 				const bool try_to_subscribe = (sub_idx == next_subscribe_topic_index);
 
-				if (copy_if_updated(sub_idx, _msg_buffer + sizeof(ulog_message_data_header_s), try_to_subscribe)) {
+				/* in drain mode, write every sample still in the queue of full rate topics (oldest first),
+				 * otherwise only the latest one
+				 */
+				unsigned max_samples = 1;
+
+				if (_drain_queues && sub.full_rate() && sub.valid()) {
+					const unsigned unread = sub.unread_count();
+					const unsigned queue_size = sub.get_queue_size();
+
+					if (unread > queue_size) {
+						sub.lost_messages += unread - queue_size;
+					}
+
+					max_samples = math::max(queue_size, 1u);
+				}
+
+				for (unsigned sample = 0; sample < max_samples
+				     && copy_if_updated(sub_idx, _msg_buffer + sizeof(ulog_message_data_header_s), try_to_subscribe); ++sample) {
+					if (_drain_queues) {
+						++_drained_samples;
+					}
+
 					// each message consists of a header followed by an orb data object
 					const size_t msg_size = sizeof(ulog_message_data_header_s) + sub.get_topic()->o_size_no_padding;
 					const uint16_t write_msg_size = static_cast<uint16_t>(msg_size - ULOG_MSG_HEADER_LEN);
@@ -1010,7 +1241,15 @@ void Logger::run()
 					// PX4_INFO("topic: %s, size = %zu, out_size = %zu", sub.get_topic()->o_name, sub.get_topic()->o_size, msg_size);
 
 					// full log
-					if (write_message(LogType::Full, _msg_buffer, msg_size)) {
+					const bool index_first_data = _log_index.needs_first_data(sub_idx)
+								      && _writer.is_started(LogType::Full, LogWriter::BackendFile);
+					const uint64_t data_offset = index_first_data ? full_log_file_offset() : 0;
+
+					if (write_data_message(sub_idx, msg_size)) {
+
+						if (index_first_data) {
+							_log_index.set_first_data(sub_idx, sub.msg_id, data_offset);
+						}
 
 #ifdef DBGPRINT
 						total_bytes += msg_size;
@@ -1074,7 +1313,13 @@ void Logger::run()
 				_msg_buffer[9] = 0xBB;
 				_msg_buffer[10] = 0x12;
 
-				write_message(LogType::Full, _msg_buffer, write_msg_size + ULOG_MSG_HEADER_LEN);
+				const bool index_time = _writer.is_started(LogType::Full, LogWriter::BackendFile);
+				const uint64_t sync_offset = index_time ? full_log_file_offset() : 0;
+
+				if (write_message(LogType::Full, _msg_buffer, write_msg_size + ULOG_MSG_HEADER_LEN) && index_time) {
+					_log_index.add_time(loop_time, sync_offset);
+				}
+
 				_last_sync_time = loop_time;
 			}
 
@@ -1106,6 +1351,10 @@ void Logger::run()
 
 		} else { // not logging
 
+			if (_drain_queues) {
+				update_drain_callbacks(false, nullptr);
+			}
+
 			// try to subscribe to new topics, even if we don't log, so that:
 			// - we avoid subscribing to many topics at once, when logging starts
 			// - we'll get the data immediately once we start logging (no need to wait for the next subscribe timeout)
@@ -1157,6 +1406,12 @@ void Logger::run()
 	stop_log_file(LogType::Mission);
 
 	hrt_cancel(&timer_call);
+
+	for (LoggerDrainCallback *&callback : _drain_callbacks) {
+		delete callback; // unregisters itself
+		callback = nullptr;
+	}
+
 	px4_sem_destroy(&timer_callback_data.semaphore);
 
 	// stop the writer thread
@@ -1295,11 +1550,92 @@ void Logger::handle_vehicle_command_update()
 	}
 }
 
-bool Logger::write_message(LogType type, void *ptr, size_t size)
+bool Logger::write_data_message(int sub_idx, size_t msg_size)
+{
+	if (!_delta_references) {
+		return write_message(LogType::Full, _msg_buffer, msg_size);
+	}
+
+	DeltaReference &reference = _delta_references[sub_idx];
+	const size_t data_size = msg_size - sizeof(ulog_message_data_header_s);
+	const uint8_t *data = _msg_buffer + sizeof(ulog_message_data_header_s);
+
+	if (!reference.data) {
+		reference.data = new uint8_t[data_size];
+
+		if (!reference.data) {
+			return write_message(LogType::Full, _msg_buffer, msg_size);
+		}
+	}
+
+	size_t delta_size = 0;
+
+	if (reference.valid && reference.samples_since_keyframe < DELTA_KEYFRAME_INTERVAL) {
+		delta_size = ulog_data_delta_encode(reference.data, data, data_size,
+						    _delta_buffer + sizeof(ulog_message_data_header_s));
+	}
+
+	bool written;
+	bool complete = false;
+
+	if (delta_size > 0) {
+		const uint16_t write_msg_size = static_cast<uint16_t>(sizeof(ulog_message_data_header_s) + delta_size -
+						ULOG_MSG_HEADER_LEN);
+		_delta_buffer[0] = (uint8_t)write_msg_size;
+		_delta_buffer[1] = (uint8_t)(write_msg_size >> 8);
+		_delta_buffer[2] = static_cast<uint8_t>(ULogMessageType::DATA_DELTA);
+		_delta_buffer[3] = _msg_buffer[3]; // msg_id
+		_delta_buffer[4] = _msg_buffer[4];
+		written = write_message(LogType::Full, _delta_buffer, sizeof(ulog_message_data_header_s) + delta_size, &complete);
+
+	} else {
+		written = write_message(LogType::Full, _msg_buffer, msg_size, &complete);
+	}
+
+	// each reader only sees the messages written to its backend. If any backend dropped the message, the readers'
+	// references differ, so the next sample is written in full.
+	if (complete) {
+		memcpy(reference.data, data, data_size);
+		reference.samples_since_keyframe = delta_size > 0 ? reference.samples_since_keyframe + 1 : 0;
+		reference.valid = true;
+
+	} else {
+		reference.valid = false;
+	}
+
+	return written;
+}
+
+void Logger::reset_delta_references()
+{
+	if (_delta_references) {
+		for (size_t i = 0; i < MAX_TOPICS_NUM; ++i) {
+			_delta_references[i].valid = false;
+		}
+	}
+}
+
+bool Logger::write_message(LogType type, void *ptr, size_t size, bool *complete)
 {
 	Statistics &stats = _statistics[(int)type];
 
-	if (_writer.write_message(type, ptr, size, stats.dropout_start) != -1) {
+	// the writer puts a dropout message in front of the message. It has no timestamp, so it's listed in the index.
+	const bool index_dropout = stats.dropout_start && type == LogType::Full
+				   && _writer.is_started(LogType::Full, LogWriter::BackendFile);
+	const uint64_t dropout_offset = index_dropout ? full_log_file_offset() : 0;
+
+	const int ret = _writer.write_message(type, ptr, size, stats.dropout_start);
+
+	// the return value also reflects the MAVLink backend, the file offset only changes if the file got the message
+	if (index_dropout && full_log_file_offset() != dropout_offset) {
+		_log_index.add_additional(dropout_offset);
+	}
+
+	if (complete) {
+		*complete = (ret == 0);
+	}
+
+	if (ret != -1) {
 
 		if (stats.dropout_start) {
 			float dropout_duration = (float)(hrt_elapsed_time(&stats.dropout_start) / 1000) / 1.e3f;
@@ -1408,6 +1744,9 @@ int Logger::get_log_file_name(LogType type, char *file_name, size_t file_name_si
 
 	char *log_file_name = _file_name[(int)type].log_file_name;
 
+	// compressed ULog container, see Tools/ulog_decompress.py (only the full log is compressed)
+	const char *extension = (type == LogType::Full && _compress_log) ? "ulgz" : "ulg";
+
 	if (time_ok) {
 		int n = create_log_dir(type, &tt, file_name, file_name_size);
 
@@ -1417,7 +1756,8 @@ int Logger::get_log_file_name(LogType type, char *file_name, size_t file_name_si
 
 		char log_file_name_time[16] = "";
 		strftime(log_file_name_time, sizeof(log_file_name_time), "%H_%M_%S", &tt);
-		snprintf(log_file_name, sizeof(LogFileName::log_file_name), "%s%s.ulg", log_file_name_time, replay_suffix);
+		snprintf(log_file_name, sizeof(LogFileName::log_file_name), "%s%s.%s", log_file_name_time, replay_suffix,
+			 extension);
 		snprintf(file_name + n, file_name_size - n, "/%s", log_file_name);
 
 	} else {
@@ -1432,7 +1772,8 @@ int Logger::get_log_file_name(LogType type, char *file_name, size_t file_name_si
 		/* look for the next file that does not exist */
 		while (file_number <= MAX_NO_LOGFILE) {
 			/* format log file path: e.g. /fs/microsd/log/sess001/log001.ulg */
-			snprintf(log_file_name, sizeof(LogFileName::log_file_name), "log%03u%s.ulg", file_number, replay_suffix);
+			snprintf(log_file_name, sizeof(LogFileName::log_file_name), "log%03u%s.%s", file_number, replay_suffix,
+				 extension);
 			snprintf(file_name + n, file_name_size - n, "/%s", log_file_name);
 
 			if (!util::file_exist(file_name)) {
@@ -1480,6 +1821,14 @@ void Logger::start_log_file(LogType type)
 		mavlink_log_info(&_mavlink_log_pub, "[logger] file: %s", file_name);
 	}
 
+	if (type == LogType::Full) {
+		reset_delta_references();
+
+		if (!_log_index.init(MAX_TOPICS_NUM)) {
+			PX4_WARN("failed to alloc log index");
+		}
+	}
+
 	_writer.start_log_file(type, file_name);
 	_writer.select_write_backend(LogWriter::BackendFile);
 	_writer.set_need_reliable_transfer(true);
@@ -1502,6 +1851,13 @@ void Logger::start_log_file(LogType type)
 		/* reset performance counters to get in-flight min and max values in post flight log */
 		perf_reset_all();
 
+		for (LoggerSubscription &sub : _subscriptions) {
+			sub.lost_messages = 0;
+		}
+
+		_drained_samples = 0;
+		_drained_samples_start = hrt_absolute_time();
+
 		initialize_load_output(PrintLoadReason::Preflight);
 	}
 
@@ -1517,7 +1873,9 @@ void Logger::stop_log_file(LogType type)
 
 	if (type == LogType::Full) {
 		_writer.set_need_reliable_transfer(true);
+		write_lost_messages(type);
 		write_perf_data(false);
+		write_index();
 		_writer.set_need_reliable_transfer(false);
 	}
 
@@ -1534,6 +1892,7 @@ void Logger::start_log_mavlink()
 
 	_writer.start_log_mavlink();
 	_writer.select_write_backend(LogWriter::BackendMavlink);
+	reset_delta_references();
 	_writer.set_need_reliable_transfer(true);
 	write_header(LogType::Full);
 	write_version(LogType::Full);
@@ -1913,6 +2272,35 @@ void Logger::write_info_multiple(LogType type, const char *name, const char *val
 	_writer.unlock();
 }
 
+void Logger::write_info_multiple(LogType type, const char *name, const uint64_t *values, int count,
+				 bool is_continued)
+{
+	_writer.lock();
+	ulog_message_info_multiple_header_s msg;
+	uint8_t *buffer = reinterpret_cast<uint8_t *>(&msg);
+	msg.msg_type = static_cast<uint8_t>(ULogMessageType::INFO_MULTIPLE);
+	msg.is_continued = is_continued;
+
+	/* construct format key (type and name) */
+	msg.key_len = snprintf(msg.key, sizeof(msg.key), "uint64_t[%i] %s", count, name);
+	size_t msg_size = sizeof(msg) - sizeof(msg.key) + msg.key_len;
+	const size_t vlen = count * sizeof(uint64_t);
+
+	if (vlen <= (sizeof(msg) - msg_size)) {
+		memcpy(&buffer[msg_size], values, vlen);
+		msg_size += vlen;
+
+		msg.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
+
+		write_message(type, buffer, msg_size);
+
+	} else {
+		PX4_ERR("info_multiple array too long (%i), key=%s", count, msg.key);
+	}
+
+	_writer.unlock();
+}
+
 void Logger::write_info(LogType type, const char *name, int32_t value)
 {
 	write_info_template<int32_t>(type, name, value, "int32_t");
@@ -1968,6 +2356,10 @@ void Logger::write_header(LogType type)
 	flag_bits.msg_size = sizeof(flag_bits) - ULOG_MSG_HEADER_LEN;
 	flag_bits.msg_type = static_cast<uint8_t>(ULogMessageType::FLAG_BITS);
 
+	if (type == LogType::Full && _delta_references) {
+		flag_bits.incompat_flags[0] |= ULOG_INCOMPAT_FLAG0_DATA_DELTA_MASK;
+	}
+
 	write_message(type, &flag_bits, sizeof(flag_bits));
 
 	_writer.unlock();
@@ -2135,6 +2527,9 @@ void Logger::write_changed_parameters(LogType type)
 	int param_idx = 0;
 	param_t param = 0;
 
+	// parameter changes have no timestamp, so they are listed in the index
+	const bool index_params = type == LogType::Full && _writer.is_started(LogType::Full, LogWriter::BackendFile);
+
 	do {
 		// skip over all parameters which are not invalid and not used
 		do {
@@ -2188,7 +2583,13 @@ void Logger::write_changed_parameters(LogType type)
 			// msg_size is now 1 (msg_type) + 2 (msg_size) + 1 (key_len) + key_len + value_size
 			msg.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
 
+			const uint64_t offset = index_params ? full_log_file_offset() : 0;
+
 			write_message(type, buffer, msg_size);
+
+			if (index_params && full_log_file_offset() != offset) {
+				_log_index.add_additional(offset);
+			}
 		}
 	} while ((param != PARAM_INVALID) && (param_idx < (int) param_count()));
 
@@ -2236,7 +2637,8 @@ The normal log is always a superset of the mission log.
 ### Implementation
 The implementation uses two threads:
 - The main thread, running at a fixed rate (or polling on a topic if started with -p) and checking for
-  data updates
+  data updates. With -q, every sample still queued on a full-rate topic is written (oldest first) instead
+  of only the latest one, and a topic queue filling up wakes the thread before the next period.
 - The writer thread, writing data to the file
 
 In between there is a write buffer with configurable size (and another fixed-size buffer for
@@ -2261,6 +2663,7 @@ $ logger on
 	PRINT_MODULE_USAGE_PARAM_INT('b', 12, 4, 10000, "Log buffer size in KiB", true);
 	PRINT_MODULE_USAGE_PARAM_STRING('p', nullptr, "<topic_name>",
 					 "Poll on a topic instead of running with fixed rate (Log rate and topic intervals are ignored if this is set)", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('q', "Drain the queues of full-rate topics (log every queued sample, not only the latest)", true);
 	PRINT_MODULE_USAGE_COMMAND_DESCR("on", "start logging now, override arming (logger must be running)");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("off", "stop logging now, override arming (logger must be running)");
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
@@ -33,6 +33,7 @@
 
 #pragma once
 
+#include "log_index.h"
 #include "log_writer.h"
 #include "messages.h"
 #include <containers/Array.hpp>
@@ -44,7 +45,9 @@
 #include <systemlib/printload.h>
 #include <px4_module.h>
 
+#include <px4_sem.h>
 #include <uORB/Subscription.hpp>
+#include <uORB/SubscriptionCallback.hpp>
 #include <uORB/SubscriptionInterval.hpp>
 #include <uORB/topics/log_message.h>
 #include <uORB/topics/manual_control_setpoint.h>
@@ -89,11 +92,58 @@ struct LoggerSubscription : public uORB::SubscriptionInterval {
 
 	uint8_t msg_id{MSG_ID_INVALID};
 
+	uint32_t lost_messages{0}; ///< samples overwritten in the queue before they were logged (drain mode only)
+
 	LoggerSubscription() = default;
 
 	LoggerSubscription(const orb_metadata *meta, uint32_t interval_ms = 0, uint8_t instance = 0) :
 		uORB::SubscriptionInterval(meta, interval_ms * 1000, instance)
 	{}
+
+	/** true if every sample is logged, i.e. the topic is not rate limited */
+	bool full_rate() const { return _interval_us == 0; }
+
+	unsigned unread_count() const { return _subscription.unread_count(); }
+	uint8_t get_queue_size() const { return _subscription.get_queue_size(); }
+};
+
+/**
+ * In drain mode, wakes up the logger before the queue of a full rate topic overflows.
+ */
+class LoggerDrainCallback : public uORB::SubscriptionCallback
+{
+public:
+	LoggerDrainCallback(const LoggerSubscription &subscription, px4_sem_t *semaphore) :
+		uORB::SubscriptionCallback(subscription.get_topic(), 0, subscription.get_instance()),
+		_logger_subscription(subscription),
+		_semaphore(semaphore)
+	{}
+
+	virtual ~LoggerDrainCallback() = default;
+
+	/** called from the publisher context */
+	void call() override
+	{
+		const unsigned queue_size = _logger_subscription.get_queue_size();
+
+		// wake up once half of the queue is unread, which leaves the other half as margin
+		if (_logger_subscription.unread_count() >= ((queue_size > 1) ? queue_size / 2 : 1)) {
+			int value;
+
+			// same as the timer callback: don't let the count grow unbounded
+			if (px4_sem_getvalue(_semaphore, &value) == 0 && value > 0) {
+				return;
+			}
+
+			px4_sem_post(_semaphore);
+		}
+	}
+
+	bool registered{false};
+
+private:
+	const LoggerSubscription &_logger_subscription;
+	px4_sem_t *_semaphore;
 };
 
 class Logger : public ModuleBase<Logger>
@@ -107,7 +157,7 @@ public:
 	};
 
 	Logger(LogWriter::Backend backend, size_t buffer_size, uint32_t log_interval, const char *poll_topic_name,
-	       LogMode log_mode, bool log_name_timestamp);
+	       LogMode log_mode, bool log_name_timestamp, bool drain_queues);
 
 	~Logger();
 
@@ -281,6 +331,7 @@ private:
 
 	void write_info(LogType type, const char *name, const char *value);
 	void write_info_multiple(LogType type, const char *name, const char *value, bool is_continued);
+	void write_info_multiple(LogType type, const char *name, const uint64_t *values, int count, bool is_continued);
 	void write_info(LogType type, const char *name, int32_t value);
 	void write_info(LogType type, const char *name, uint32_t value);
 
@@ -294,12 +345,51 @@ private:
 
 	inline bool copy_if_updated(int sub_idx, void *buffer, bool try_to_subscribe);
 
+	/**
+	 * Drain mode: register or unregister the wakeup callbacks of all full rate topics with a queue.
+	 * Topics that are not advertised yet are retried on the next call.
+	 */
+	void update_drain_callbacks(bool enable, px4_sem_t *semaphore);
+
+	/**
+	 * Drain mode: write the number of lost samples of each topic to the log
+	 */
+	void write_lost_messages(LogType type);
+
+	/**
+	 * Append the index collected in _log_index to the full log file. It must be the last thing written to the file.
+	 */
+	void write_index();
+
+	/**
+	 * @return the file offset at which the next message will be written to the full log file (including the data
+	 * still in the buffer). Must be called with _writer.lock() held.
+	 */
+	uint64_t full_log_file_offset() const
+	{
+		return _writer.get_total_written_file(LogType::Full) + _writer.get_buffer_fill_count_file(LogType::Full);
+	}
+
+	/**
+	 * Write the data message in _msg_buffer to the full log, as DATA_DELTA message if delta encoding is enabled
+	 * and a reference sample is available.
+	 * @return true on success
+	 */
+	bool write_data_message(int sub_idx, size_t msg_size);
+
+	/**
+	 * Delta encoding: forget all reference samples, so that the next sample of each topic is written in full.
+	 * Must be called whenever a new log (file or MAVLink stream) is started.
+	 */
+	void reset_delta_references();
+
 	/**
 	 * Write exactly one ulog message to the logger and handle dropouts.
 	 * Must be called with _writer.lock() held.
+	 * @param complete optional, set to true if all backends (file and MAVLink) wrote the message
 	 * @return true if data written, false otherwise (on overflow)
 	 */
-	bool write_message(LogType type, void *ptr, size_t size);
+	bool write_message(LogType type, void *ptr, size_t size, bool *complete = nullptr);
 
 	/**
 	 * Parse a file containing a list of uORB topics to log, calling add_topic for each
@@ -370,6 +460,22 @@ private:
 	uint8_t						*_msg_buffer{nullptr};
 	int						_msg_buffer_len{0};
 
+	/** delta encoding: last sample written to the full log, per subscription */
+	struct DeltaReference {
+		uint8_t *data{nullptr};
+		uint8_t samples_since_keyframe{0};
+		bool valid{false};
+	};
+
+	/* write a full sample at least this often, so that a lost DATA_DELTA message (e.g. MAVLink) does not
+	 * corrupt the topic for the rest of the log */
+	static constexpr uint8_t DELTA_KEYFRAME_INTERVAL = 50;
+
+	DeltaReference					*_delta_references{nullptr}; ///< MAX_TOPICS_NUM entries, if delta encoding is enabled
+	uint8_t						*_delta_buffer{nullptr}; ///< encoded DATA_DELTA message
+
+	LogIndex					_log_index; ///< seek index of the full log file
+
 	LogFileName					_file_name[(int)LogType::Count];
 
 	bool						_prev_state{false}; ///< previous state depending on logging mode (arming or aux1 state)
@@ -388,6 +494,11 @@ private:
 	LogWriter					_writer;
 	uint32_t					_log_interval{0};
 	const orb_metadata				*_polling_topic_meta{nullptr}; ///< if non-null, poll on this topic instead of sleeping
+	const bool					_drain_queues; ///< log every queued sample of full rate topics
+	bool						_compress_log{false}; ///< the full log file is compressed (.ulgz)
+	LoggerDrainCallback				*_drain_callbacks[MAX_TOPICS_NUM] {}; ///< drain mode wakeups, per subscription
+	uint32_t					_drained_samples{0}; ///< samples written in drain mode, for the status output
+	hrt_abstime					_drained_samples_start{0};
 	orb_advert_t					_mavlink_log_pub{nullptr};
 	uint8_t						_next_topic_id{0}; ///< id of next subscribed ulog topic
 	char						*_replay_file_name{nullptr};
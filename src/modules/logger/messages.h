@@ -46,6 +46,7 @@ enum class ULogMessageType : uint8_t {
 	LOGGING = 'L',
 	LOGGING_TAGGED = 'C',
 	FLAG_BITS = 'B',
+	DATA_DELTA = 'd', ///< @see data_delta.h
 };
 
 
@@ -154,6 +155,7 @@ struct ulog_message_parameter_header_s {
 
 
 #define ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK (1<<0)
+#define ULOG_INCOMPAT_FLAG0_DATA_DELTA_MASK (1<<1) ///< the log contains DATA_DELTA messages
 
 struct ulog_message_flag_bits_s {
 	uint16_t msg_size;
@@ -165,3 +167,20 @@ struct ulog_message_flag_bits_s {
 };
 
 #pragma pack(pop)
+
+/* index appended to the end of a full log file when it is closed (see log_index.h). All offsets are file offsets of
+ * the (uncompressed) ULog file:
+ * - INFO_MULTIPLE "uint64_t[N] ulog_index_time": pairs of (timestamp, offset of a message written at that time)
+ * - INFO_MULTIPLE "uint64_t[N] ulog_index_data": pairs of (msg_id, offset of the first DATA message of msg_id)
+ * - INFO_MULTIPLE "uint64_t[N] ulog_index_additional" (optional): ascending offsets of the PARAMETER and DROPOUT
+ *   messages in the data section, and of the ADD_LOGGED_MSG messages of topics subscribed after the start of the data
+ *   section. A listed message can be followed by more of these without an entry of their own.
+ *   It is only written if it lists all of them (it might be empty).
+ * - the last message of the file: INFO "uint64_t ulog_index", containing the offset of the first index message
+ */
+#define ULOG_INDEX_TIME_KEY "ulog_index_time"
+#define ULOG_INDEX_DATA_KEY "ulog_index_data"
+#define ULOG_INDEX_ADDITIONAL_KEY "ulog_index_additional"
+#define ULOG_INDEX_KEY "uint64_t ulog_index"
+#define ULOG_INDEX_FOOTER_SIZE (ULOG_MSG_HEADER_LEN + 1 + sizeof(ULOG_INDEX_KEY) - 1 + sizeof(uint64_t))
+
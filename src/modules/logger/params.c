@@ -145,6 +145,64 @@ PARAM_DEFINE_INT32(SDLOG_PROFILE, 3);
  */
 PARAM_DEFINE_INT32(SDLOG_DIRS_MAX, 0);
 
+/**
+ * Log file write strategy
+ *
+ * Selects how the full log is written to the SD card / disk.
+ *
+ * Stream writes whatever is in the log buffer and calls fsync about once per second.
+ *
+ * Aligned writes in fixed, block-aligned chunks, and calls fdatasync on its own cadence,
+ * preferably when the buffer is drained. On Linux the file is preallocated as well, which
+ * reduces file system metadata updates and write amplification.
+ *
+ * Direct is the same as Aligned, but additionally bypasses the page cache (O_DIRECT), which is
+ * only supported on Linux (otherwise it falls back to Aligned).
+ *
+ * Use the sd_bench command to compare the strategies on a given storage device.
+ *
+ * @value 0 Stream
+ * @value 1 Aligned
+ * @value 2 Direct
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_WR_MODE, 0);
+
+/**
+ * Compress the log file
+ *
+ * If enabled, the full log is compressed (LZ4 block format) on the file writer thread and
+ * written as .ulgz file, which can be converted back to a standard ULog file with
+ * Tools/ulog_decompress.py. This reduces the size of high-rate logs at the cost of CPU time
+ * on the writer thread (see the logger_compress perf counter).
+ *
+ * The mission log and the MAVLink log streaming are not compressed.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_COMPRESS, 0);
+
+/**
+ * Delta encoding of logged topics
+ *
+ * If enabled, a logged topic sample is written as the difference to the previous
+ * sample of the same topic (a bitmap of the changed bytes plus the changed bytes), if
+ * that is smaller. This typically reduces the log bandwidth considerably, which is
+ * mostly useful for MAVLink log streaming over low bandwidth links.
+ *
+ * The log is marked with an incompatible ULog flag, so that parsers without support
+ * refuse it. Replay supports it, and Tools/ulog_decompress.py converts such a log
+ * back into a standard ULog file. Only the full log is affected.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_DELTA, 0);
+
 /**
  * Log UUID
  *
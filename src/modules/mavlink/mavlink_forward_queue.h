@@ -0,0 +1,178 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_forward_queue.h
+ * Lock-free single producer, single consumer queue of raw MAVLink frames,
+ * used to pass forwarded messages to another mavlink instance.
+ *
+ * Frames are stored back to back in a byte ring, each prefixed by its
+ * length. A frame never wraps around the end of the buffer: if it does
+ * not fit, the rest of the buffer is skipped with a wrap marker, so the
+ * consumer can send every frame straight out of the ring.
+ */
+
+#pragma once
+
+#include <px4_atomic.h>
+#include <stdint.h>
+#include <string.h>
+
+class MavlinkForwardQueue
+{
+public:
+	MavlinkForwardQueue() = default;
+	~MavlinkForwardQueue() { delete[] _buffer; }
+
+	// no copy, assignment, move, move assignment
+	MavlinkForwardQueue(const MavlinkForwardQueue &) = delete;
+	MavlinkForwardQueue &operator=(const MavlinkForwardQueue &) = delete;
+	MavlinkForwardQueue(MavlinkForwardQueue &&) = delete;
+	MavlinkForwardQueue &operator=(MavlinkForwardQueue &&) = delete;
+
+	/**
+	 * Allocate the buffer.
+	 * @param size buffer size in bytes, must be a power of two
+	 */
+	bool init(uint32_t size)
+	{
+		if (size == 0 || (size & (size - 1)) != 0) {
+			return false;
+		}
+
+		_buffer = new uint8_t[size];
+
+		if (_buffer == nullptr) {
+			return false;
+		}
+
+		_size = size;
+		return true;
+	}
+
+	/**
+	 * Append a frame. Producer side only.
+	 * @return false if the queue is full, the frame is dropped and counted
+	 */
+	bool push(const uint8_t *frame, uint16_t len)
+	{
+		const uint32_t head = _head.load();
+		const uint32_t tail = _tail.load();
+
+		const uint32_t pos = head & (_size - 1);
+		const uint32_t record = record_size(len);
+		const uint32_t padding = (record > _size - pos) ? _size - pos : 0;
+
+		if (_buffer == nullptr || _size - (head - tail) < padding + record) {
+			_dropped.fetch_add(1);
+			return false;
+		}
+
+		uint32_t write = head;
+
+		if (padding > 0) {
+			write_header(pos, WRAP_MARKER);
+			write += padding;
+		}
+
+		const uint32_t write_pos = write & (_size - 1);
+		write_header(write_pos, len);
+		memcpy(&_buffer[write_pos + HEADER_SIZE], frame, len);
+
+		// publish the frame to the consumer
+		_head.store(write + record);
+
+		return true;
+	}
+
+	/**
+	 * Oldest frame in the queue. Consumer side only.
+	 * The frame stays valid until pop() is called.
+	 * @return nullptr if the queue is empty
+	 */
+	const uint8_t *front(uint16_t &len)
+	{
+		uint32_t tail = _tail.load();
+
+		if (tail == _head.load()) {
+			return nullptr;
+		}
+
+		uint32_t pos = tail & (_size - 1);
+
+		if (read_header(pos) == WRAP_MARKER) {
+			// the producer always writes a frame after the marker
+			tail += _size - pos;
+			_tail.store(tail);
+			pos = 0;
+		}
+
+		len = read_header(pos);
+		return &_buffer[pos + HEADER_SIZE];
+	}
+
+	/**
+	 * Remove the frame returned by front(). Consumer side only.
+	 */
+	void pop()
+	{
+		const uint32_t tail = _tail.load();
+		_tail.store(tail + record_size(read_header(tail & (_size - 1))));
+	}
+
+	/** number of frames dropped because the queue was full */
+	uint32_t dropped() const { return _dropped.load(); }
+
+private:
+	static constexpr uint32_t HEADER_SIZE = 2;
+	static constexpr uint16_t WRAP_MARKER = 0xFFFF;
+
+	/** records are kept 2 byte aligned, so a wrap marker always fits in front of the buffer end */
+	static uint32_t record_size(uint16_t len) { return HEADER_SIZE + ((len + 1u) & ~1u); }
+
+	void write_header(uint32_t pos, uint16_t value)
+	{
+		_buffer[pos] = value & 0xFF;
+		_buffer[pos + 1] = value >> 8;
+	}
+
+	uint16_t read_header(uint32_t pos) const { return _buffer[pos] | (_buffer[pos + 1] << 8); }
+
+	uint8_t *_buffer{nullptr};
+	uint32_t _size{0};
+
+	px4::atomic<uint32_t> _head{0};	///< free running write index, only written by the producer
+	px4::atomic<uint32_t> _tail{0};	///< free running read index, only written by the consumer
+
+	px4::atomic<uint32_t> _dropped{0};
+};
@@ -0,0 +1,273 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_frame_parser.cpp
+ * Frame-at-a-time MAVLink parser.
+ */
+
+#include "mavlink_frame_parser.h"
+
+#include <mathlib/mathlib.h>
+#include <string.h>
+
+static constexpr size_t MAVLINK1_HEADER_LEN = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+static constexpr size_t MAVLINK2_HEADER_LEN = MAVLINK_NUM_HEADER_BYTES;
+
+bool
+MavlinkFrameParser::parse(const uint8_t *&buf, size_t &len, mavlink_message_t *msg)
+{
+	const mavlink_status_t *channel_status = mavlink_get_channel_status(_channel);
+
+	if (channel_status != nullptr && channel_status->signing != nullptr) {
+		// signature checking is only implemented in the reference parser
+		return parse_char_by_char(buf, len, msg);
+	}
+
+	while (true) {
+		if (_pending_len > 0) {
+			// complete the frame started by a previous read
+			size_t needed = frame_length(_pending, _pending_len);
+
+			while (_pending_len < needed && len > 0) {
+				const size_t n = math::min(needed - _pending_len, len);
+				memcpy(&_pending[_pending_len], buf, n);
+				_pending_len += n;
+				buf += n;
+				len -= n;
+
+				// the header might have been completed, which determines the real length
+				needed = frame_length(_pending, _pending_len);
+			}
+
+			if (_pending_len < needed) {
+				return false;
+			}
+
+			if (decode(_pending, msg)) {
+				consume_pending(needed);
+				return true;
+			}
+
+			// invalid frame: resynchronize on the next start marker
+			consume_pending(1);
+			continue;
+		}
+
+		// skip to the next start marker
+		while (len > 0 && !is_stx(*buf)) {
+			buf++;
+			len--;
+		}
+
+		if (len == 0) {
+			return false;
+		}
+
+		const size_t needed = frame_length(buf, len);
+
+		if (len < needed) {
+			// keep the partial frame until more data arrives
+			memcpy(_pending, buf, len);
+			_pending_len = len;
+			buf += len;
+			len = 0;
+			return false;
+		}
+
+		if (decode(buf, msg)) {
+			buf += needed;
+			len -= needed;
+			return true;
+		}
+
+		// invalid frame: resynchronize on the next start marker
+		buf++;
+		len--;
+	}
+}
+
+size_t
+MavlinkFrameParser::frame_length(const uint8_t *buf, size_t len)
+{
+	if (buf[0] == MAVLINK_STX_MAVLINK1) {
+		if (len < 2) {
+			return MAVLINK1_HEADER_LEN;
+		}
+
+		return MAVLINK1_HEADER_LEN + buf[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+	}
+
+	if (len < 3) {
+		return MAVLINK2_HEADER_LEN;
+	}
+
+	const size_t signature_len = (buf[2] & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+
+	return MAVLINK2_HEADER_LEN + buf[1] + MAVLINK_NUM_CHECKSUM_BYTES + signature_len;
+}
+
+bool
+MavlinkFrameParser::decode(const uint8_t *frame, mavlink_message_t *msg)
+{
+	const uint8_t payload_len = frame[1];
+	size_t header_len;
+
+	if (frame[0] == MAVLINK_STX_MAVLINK1) {
+		header_len = MAVLINK1_HEADER_LEN;
+		msg->incompat_flags = 0;
+		msg->compat_flags = 0;
+		msg->seq = frame[2];
+		msg->sysid = frame[3];
+		msg->compid = frame[4];
+		msg->msgid = frame[5];
+
+	} else {
+		if ((frame[2] & ~MAVLINK_IFLAG_MASK) != 0) {
+			// incompatible feature we don't support
+			count_parse_error();
+			return false;
+		}
+
+		header_len = MAVLINK2_HEADER_LEN;
+		msg->incompat_flags = frame[2];
+		msg->compat_flags = frame[3];
+		msg->seq = frame[4];
+		msg->sysid = frame[5];
+		msg->compid = frame[6];
+		msg->msgid = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+	}
+
+	const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msg->msgid);
+	const uint8_t *payload = &frame[header_len];
+	const uint8_t *ck = &payload[payload_len];
+
+	// the checksum covers everything but the start marker, plus the message specific extra byte
+	uint16_t checksum;
+	crc_init(&checksum);
+	crc_accumulate_buffer(&checksum, (const char *)&frame[1], header_len - 1 + payload_len);
+	crc_accumulate(entry ? entry->crc_extra : 0, &checksum);
+
+	if (ck[0] != (checksum & 0xFF) || ck[1] != (checksum >> 8)) {
+		count_parse_error();
+		return false;
+	}
+
+	msg->magic = frame[0];
+	msg->len = payload_len;
+	msg->checksum = checksum;
+	msg->ck[0] = ck[0];
+	msg->ck[1] = ck[1];
+
+	memcpy(_MAV_PAYLOAD_NON_CONST(msg), payload, payload_len);
+
+	// MAVLink 2 truncates trailing zero bytes, restore them
+	if (entry && payload_len < entry->max_msg_len) {
+		memset(&_MAV_PAYLOAD_NON_CONST(msg)[payload_len], 0, entry->max_msg_len - payload_len);
+	}
+
+	if (msg->incompat_flags & MAVLINK_IFLAG_SIGNED) {
+		memcpy(msg->signature, &ck[MAVLINK_NUM_CHECKSUM_BYTES], MAVLINK_SIGNATURE_BLOCK_LEN);
+	}
+
+	_rx_success_count++;
+	update_channel_status(msg);
+
+	return true;
+}
+
+void
+MavlinkFrameParser::count_parse_error()
+{
+	_parse_errors++;
+
+	// rejected frames show up in the link drop statistics, like with mavlink_parse_char()
+	mavlink_status_t *status = mavlink_get_channel_status(_channel);
+
+	if (status != nullptr) {
+		status->packet_rx_drop_count++;
+	}
+}
+
+void
+MavlinkFrameParser::consume_pending(size_t n)
+{
+	while (n < _pending_len && !is_stx(_pending[n])) {
+		n++;
+	}
+
+	_pending_len -= n;
+	memmove(_pending, &_pending[n], _pending_len);
+}
+
+bool
+MavlinkFrameParser::parse_char_by_char(const uint8_t *&buf, size_t &len, mavlink_message_t *msg)
+{
+	while (len > 0) {
+		const uint8_t c = *buf;
+		buf++;
+		len--;
+
+		if (mavlink_parse_char(_channel, c, msg, &_status)) {
+			_rx_success_count++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+MavlinkFrameParser::update_channel_status(const mavlink_message_t *msg)
+{
+	// keep the channel status consistent with what mavlink_parse_char() would report
+	mavlink_status_t *status = mavlink_get_channel_status(_channel);
+
+	if (status == nullptr) {
+		return;
+	}
+
+	if (msg->magic == MAVLINK_STX_MAVLINK1) {
+		status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+
+	} else {
+		status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+	}
+
+	if (status->packet_rx_success_count == 0) {
+		status->packet_rx_drop_count = 0;
+	}
+
+	status->current_rx_seq = msg->seq;
+	status->packet_rx_success_count++;
+}
@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_frame_parser.h
+ * Frame-at-a-time MAVLink parser.
+ *
+ * Instead of running every received byte through the mavlink_parse_char()
+ * state machine, the parser scans for a start marker, reads the length from
+ * the header and validates the whole frame (incompat flags and CRC) in one
+ * go. Frames that straddle two reads are reassembled in a small buffer.
+ */
+
+#pragma once
+
+#include "mavlink_bridge_header.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+class MavlinkFrameParser
+{
+public:
+	explicit MavlinkFrameParser(mavlink_channel_t channel) : _channel(channel) {}
+	~MavlinkFrameParser() = default;
+
+	/**
+	 * Extract the next message from a chunk of received bytes.
+	 *
+	 * @param buf	input bytes, advanced past everything consumed
+	 * @param len	number of input bytes, decremented accordingly
+	 * @param msg	filled with the decoded message
+	 * @return true if a message was decoded, false once the input is exhausted
+	 *		(a trailing partial frame is kept for the next call)
+	 */
+	bool parse(const uint8_t *&buf, size_t &len, mavlink_message_t *msg);
+
+	/**
+	 * Number of frames rejected because of a bad CRC or unsupported flags. These are also counted
+	 * in packet_rx_drop_count of the channel status. Not counted with message signing, where the
+	 * mavlink_parse_char() fallback does its own accounting.
+	 */
+	uint32_t parse_errors() const { return _parse_errors; }
+
+	/** number of successfully decoded frames */
+	uint32_t rx_success_count() const { return _rx_success_count; }
+
+private:
+
+	/**
+	 * Frame length for the frame starting at buf[0], or the number of bytes
+	 * needed to determine it if the header is not complete yet.
+	 */
+	static size_t frame_length(const uint8_t *buf, size_t len);
+
+	/**
+	 * Validate and decode a complete frame.
+	 * @return false if the frame is invalid
+	 */
+	bool decode(const uint8_t *frame, mavlink_message_t *msg);
+
+	void count_parse_error();
+
+	/**
+	 * Drop n bytes from the reassembly buffer, along with everything up to the next start marker.
+	 */
+	void consume_pending(size_t n);
+
+	/**
+	 * Byte by byte fallback through mavlink_parse_char(), used if message signing is configured.
+	 */
+	bool parse_char_by_char(const uint8_t *&buf, size_t &len, mavlink_message_t *msg);
+
+	void update_channel_status(const mavlink_message_t *msg);
+
+	static bool is_stx(uint8_t c) { return c == MAVLINK_STX || c == MAVLINK_STX_MAVLINK1; }
+
+	const mavlink_channel_t _channel;
+
+	uint8_t _pending[MAVLINK_MAX_PACKET_LEN];	///< reassembly buffer for a frame split across reads
+	size_t _pending_len{0};
+
+	mavlink_status_t _status{};	///< only used by the mavlink_parse_char() fallback
+
+	uint32_t _parse_errors{0};
+	uint32_t _rx_success_count{0};
+};
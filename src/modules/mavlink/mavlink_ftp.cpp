@@ -46,17 +46,31 @@
 #include "mavlink_main.h"
 #include "mavlink_tests/mavlink_ftp_test.h"
 
+#include <parameters/param.h>
+
 constexpr const char MavlinkFTP::_root_dir[];
+constexpr const char MavlinkFTP::kParamPackPath[];
 
 MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 	_mavlink(mavlink)
 {
 	// initialize session
 	_session_info.fd = -1;
+
+#ifdef MAVLINK_FTP_UNIT_TEST
+	// do not interfere with the instances that are running
+	strncpy(_param_pack_file, PX4_STORAGEDIR "/param_test.pck", sizeof(_param_pack_file) - 1);
+#else
+	snprintf(_param_pack_file, sizeof(_param_pack_file), PX4_STORAGEDIR "/param_%i.pck", _mavlink->get_instance_id());
+#endif
 }
 
 MavlinkFTP::~MavlinkFTP()
 {
+	if (_param_pack_count > 0) {
+		unlink(_param_pack_file);
+	}
+
 	if (_work_buffer1) {
 		delete[] _work_buffer1;
 	}
@@ -499,8 +513,19 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 		return kErrNoSessionsAvailable;
 	}
 
-	strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
-	strncpy(_work_buffer1 + _root_dir_len, _data_as_cstring(payload), _work_buffer1_len - _root_dir_len);
+	const bool param_pack = oflag == O_RDONLY && _is_param_pack(_data_as_cstring(payload));
+
+	if (param_pack) {
+		if (_update_param_pack() != 0) {
+			return kErrFailErrno;
+		}
+
+		strncpy(_work_buffer1, _param_pack_file, _work_buffer1_len);
+
+	} else {
+		strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
+		strncpy(_work_buffer1 + _root_dir_len, _data_as_cstring(payload), _work_buffer1_len - _root_dir_len);
+	}
 
 #ifdef MAVLINK_FTP_DEBUG
 	PX4_INFO("FTP: open '%s'", _work_buffer1);
@@ -531,6 +556,7 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 	_session_info.fd = fd;
 	_session_info.file_size = fileSize;
 	_session_info.stream_download = false;
+	_param_pack_in_session = param_pack;
 
 	payload->session = 0;
 	payload->size = sizeof(uint32_t);
@@ -748,6 +774,7 @@ MavlinkFTP::_workTerminate(PayloadHeader *payload)
 	::close(_session_info.fd);
 	_session_info.fd = -1;
 	_session_info.stream_download = false;
+	_param_pack_in_session = false;
 
 	payload->size = 0;
 
@@ -762,6 +789,7 @@ MavlinkFTP::_workReset(PayloadHeader *payload)
 		::close(_session_info.fd);
 		_session_info.fd = -1;
 		_session_info.stream_download = false;
+		_param_pack_in_session = false;
 	}
 
 	payload->size = 0;
@@ -841,8 +869,19 @@ MavlinkFTP::_workCalcFileCRC32(PayloadHeader *payload)
 {
 	uint32_t checksum = 0;
 	ssize_t bytes_read;
-	strncpy(_work_buffer2, _root_dir, _work_buffer2_len);
-	strncpy(_work_buffer2 + _root_dir_len, _data_as_cstring(payload), _work_buffer2_len - _root_dir_len);
+
+	if (_is_param_pack(_data_as_cstring(payload))) {
+		if (_update_param_pack() != 0) {
+			return kErrFailErrno;
+		}
+
+		strncpy(_work_buffer2, _param_pack_file, _work_buffer2_len);
+
+	} else {
+		strncpy(_work_buffer2, _root_dir, _work_buffer2_len);
+		strncpy(_work_buffer2 + _root_dir_len, _data_as_cstring(payload), _work_buffer2_len - _root_dir_len);
+	}
+
 	// ensure termination
 	_work_buffer2[_work_buffer2_len - 1] = '\0';
 
@@ -872,6 +911,135 @@ MavlinkFTP::_workCalcFileCRC32(PayloadHeader *payload)
 	return kErrNone;
 }
 
+bool
+MavlinkFTP::_is_param_pack(const char *path)
+{
+	if (path[0] == '/') {
+		++path;
+	}
+
+	return strcmp(path, kParamPackPath) == 0;
+}
+
+int
+MavlinkFTP::_update_param_pack()
+{
+	// parameters only ever become used, so the count and the change sequence identify the content
+	const uint32_t seq = param_change_seq();
+	const unsigned count = param_count_used();
+	struct stat st;
+
+	if (_param_pack_in_session) {
+		// the session downloads the file: keep it (and its CRC) consistent until the session is closed
+		return 0;
+	}
+
+	if (_param_pack_count == count && _param_pack_seq == seq && stat(_param_pack_file, &st) == 0) {
+		return 0;
+	}
+
+	_param_pack_count = 0;
+
+	if (_write_param_pack() != 0) {
+		return -1;
+	}
+
+	_param_pack_seq = seq;
+	_param_pack_count = count;
+	return 0;
+}
+
+/// Writes the used parameters (sorted by name) in the same format as ArduPilot's @PARAM/param.pck, so existing
+/// GCS implementations can parse it:
+/// - header: uint16_t magic (0x671b), uint16_t number of parameters in the file, uint16_t total number of parameters
+/// - per parameter:
+///   - uint8_t type (low nibble: 3=int32, 4=float) and flags (high nibble, always 0)
+///   - uint8_t number of leading name characters shared with the previous parameter (low nibble) and number of
+///     remaining name characters - 1 (high nibble)
+///   - the remaining name characters (not null terminated)
+///   - the value (4 bytes, little endian)
+int
+MavlinkFTP::_write_param_pack()
+{
+	static constexpr uint16_t magic = 0x671b;
+	static constexpr int max_entry_size = 2 + 16 + 4;
+
+	// no other instance uses the file, and this one only writes it while no session reads it
+	int fd = ::open(_param_pack_file, O_CREAT | O_TRUNC | O_WRONLY, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		return -1;
+	}
+
+	uint8_t *buf = (uint8_t *)_work_buffer2;
+	const unsigned num_used = param_count_used();
+	uint16_t header[3] = {magic, 0, (uint16_t)num_used};
+	int len = sizeof(header); // written at the end, when the number of parameters is known
+	int ret = 0;
+	const char *prev_name = "";
+
+	for (unsigned i = 0; i < num_used && ret == 0; i++) {
+		const param_t param = param_for_used_index(i);
+		const param_type_t type = param_type(param);
+
+		if (type != PARAM_TYPE_INT32 && type != PARAM_TYPE_FLOAT) {
+			continue;
+		}
+
+		const char *name = param_name(param);
+		const int name_len = strlen(name);
+		int common_len = 0;
+
+		while (common_len < 15 && common_len < name_len - 1 && name[common_len] == prev_name[common_len]) {
+			++common_len;
+		}
+
+		if (name_len - common_len > 16) {
+			continue;
+		}
+
+		if (len + max_entry_size > _work_buffer2_len) {
+			if (::write(fd, buf, len) != len) {
+				ret = -1;
+				break;
+			}
+
+			len = 0;
+		}
+
+		buf[len++] = type == PARAM_TYPE_FLOAT ? 4 : 3;
+		buf[len++] = common_len | ((name_len - common_len - 1) << 4);
+		memcpy(&buf[len], name + common_len, name_len - common_len);
+		len += name_len - common_len;
+
+		if (param_get(param, &buf[len]) != 0) {
+			memset(&buf[len], 0, 4);
+		}
+
+		len += 4;
+		++header[1];
+		prev_name = name;
+	}
+
+	if (ret == 0 && ::write(fd, buf, len) != len) {
+		ret = -1;
+	}
+
+	if (ret == 0 && (lseek(fd, 0, SEEK_SET) != 0 || ::write(fd, header, sizeof(header)) != sizeof(header))) {
+		ret = -1;
+	}
+
+	int op_errno = errno;
+	::close(fd);
+
+	if (ret != 0) {
+		unlink(_param_pack_file);
+		errno = op_errno;
+	}
+
+	return ret;
+}
+
 /// @brief Guarantees that the payload data is null terminated.
 ///     @return Returns a pointer to the payload data as a char *
 char *
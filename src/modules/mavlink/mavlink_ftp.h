@@ -146,6 +146,23 @@ private:
 	ErrorCode	_workRename(PayloadHeader *payload);
 	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload);
 
+	/**
+	 * check if a requested path (without root dir) refers to the parameter pack (kParamPackPath)
+	 */
+	static bool	_is_param_pack(const char *path);
+
+	/**
+	 * (re)generate _param_pack_file if the parameters changed since it was last written
+	 * @return 0 on success, -1 otherwise (errno is set)
+	 */
+	int		_update_param_pack();
+
+	/**
+	 * write a packed snapshot of all used parameters to _param_pack_file.
+	 * @return 0 on success, -1 otherwise (errno is set)
+	 */
+	int		_write_param_pack();
+
 	uint8_t _getServerSystemId(void);
 	uint8_t _getServerComponentId(void);
 	uint8_t _getServerChannel(void);
@@ -160,6 +177,10 @@ private:
 	static const char	kDirentDir = 'D';	///< Identifies Directory returned from List command
 	static const char	kDirentSkip = 'S';	///< Identifies Skipped entry from List command
 
+	/// Virtual file containing all used parameters (format: see _write_param_pack()). A GCS can download it in a single
+	/// burst instead of requesting each parameter, and cache it by its CRC (kCmdCalcFileCRC32).
+	static constexpr const char kParamPackPath[] = "@PARAM/param.pck";
+
 	/// @brief Maximum data size in RequestHeader::data
 	static const uint8_t	kMaxDataLength = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(PayloadHeader);
 
@@ -191,6 +212,12 @@ private:
 	static constexpr int _work_buffer2_len = 256;
 	hrt_abstime _last_work_buffer_access{0}; ///< timestamp when the buffers were last accessed
 
+	/// every instance has its own file, so that it is never replaced while another instance reads it
+	char _param_pack_file[48] {};
+	uint32_t _param_pack_seq{0};		///< param_change_seq() when _param_pack_file was written
+	unsigned _param_pack_count{0};		///< number of parameters in _param_pack_file, 0 if not written yet
+	bool _param_pack_in_session{false};	///< the open session reads _param_pack_file, do not rewrite it
+
 	// prepend a root directory to each file/dir access to avoid enumerating the full FS tree (e.g. on Linux).
 	// Note that requests can still fall outside of the root dir by using ../..
 #ifdef MAVLINK_FTP_UNIT_TEST
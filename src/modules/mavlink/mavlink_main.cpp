@@ -179,16 +179,20 @@ Mavlink::Mavlink() :
 	if (comp_id > 0 && comp_id < 255) {
 		mavlink_system.compid = comp_id;
 	}
+
+	px4_sem_init(&_wakeup_sem, 0, 0);
+	px4_sem_setprotocol(&_wakeup_sem, SEM_PRIO_NONE);
 }
 
 Mavlink::~Mavlink()
 {
 	perf_free(_loop_perf);
 	perf_free(_loop_interval_perf);
+	perf_free(_stream_latency_perf);
 
 	if (_task_running) {
-		/* task wakes up every 10ms or so at the longest */
 		_task_should_exit = true;
+		wakeup();
 
 		/* wait for a second for the task to quit at our request */
 		unsigned i = 0;
@@ -205,6 +209,55 @@ Mavlink::~Mavlink()
 			}
 		} while (_task_running);
 	}
+
+	px4_sem_destroy(&_wakeup_sem);
+}
+
+void
+Mavlink::wakeup()
+{
+	// post once until the main loop woke up, which keeps the semaphore count bounded
+	bool pending = false;
+
+	if (_wakeup_pending.compare_exchange(&pending, true)) {
+		px4_sem_post(&_wakeup_sem);
+	}
+}
+
+void
+Mavlink::wakeup_trampoline(void *arg)
+{
+	static_cast<Mavlink *>(arg)->wakeup();
+}
+
+void
+Mavlink::wait_for_wakeup(hrt_abstime deadline)
+{
+	hrt_call_at(&_wakeup_call, deadline, &Mavlink::wakeup_trampoline, this);
+
+	px4_sem_wait(&_wakeup_sem);
+
+	// everything changed up to here is handled by the following loop iteration
+	_wakeup_pending.store(false);
+}
+
+hrt_abstime
+Mavlink::next_deadline(const hrt_abstime &now)
+{
+	// shell output and ulog streaming are polled at the main loop rate
+	hrt_abstime deadline = now + (((_mavlink_shell != nullptr) || (_mavlink_ulog != nullptr)) ? _main_loop_delay :
+				      MAVLINK_IDLE_INTERVAL);
+
+	for (const auto &stream : _streams) {
+		const hrt_abstime due = stream->get_next_due();
+
+		if ((due != 0) && (due < deadline)) {
+			deadline = due;
+		}
+	}
+
+	// hard limit to 1000 Hz at max, new data can still wake up the loop sooner
+	return math::max(deadline, now + MAVLINK_MIN_INTERVAL);
 }
 
 void
@@ -366,6 +419,7 @@ Mavlink::destroy_all_instances()
 
 		/* set flag to stop thread and wait for all threads to finish */
 		inst_to_del->_task_should_exit = true;
+		inst_to_del->wakeup();
 
 		while (inst_to_del->_task_running) {
 			printf(".");
@@ -785,6 +839,176 @@ Mavlink::get_free_tx_buf()
 	return buf_free;
 }
 
+#if defined(MAVLINK_UDP)
+unsigned
+Mavlink::get_udp_destinations(const sockaddr_in *destinations[UDP_MAX_DESTINATIONS])
+{
+	unsigned num_destinations = 0;
+
+#ifdef CONFIG_NET
+
+	if (_src_addr_initialized) {
+#endif
+		destinations[num_destinations++] = &_src_addr;
+#ifdef CONFIG_NET
+	}
+
+#endif
+
+	/* resend message via broadcast if no valid connection exists */
+	if ((_mode != MAVLINK_MODE_ONBOARD) && broadcast_enabled() &&
+	    (!get_client_source_initialized()
+	     || (hrt_elapsed_time(&_tstatus.heartbeat_time) > 3_s))) {
+
+		if (!_broadcast_address_found) {
+			find_broadcast_address();
+		}
+
+		if (_broadcast_address_found) {
+			destinations[num_destinations++] = &_bcast_addr;
+		}
+	}
+
+	return num_destinations;
+}
+
+void
+Mavlink::udp_send_failed(const sockaddr_in *destination)
+{
+	if (destination == &_bcast_addr) {
+		if (!_broadcast_failed_warned) {
+			PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
+			_broadcast_failed_warned = true;
+		}
+	}
+}
+
+int
+Mavlink::flush_udp_batch()
+{
+	int ret = 0;
+
+	if ((_udp_batch == nullptr) || (_udp_batch->packets == 0)) {
+		return ret;
+	}
+
+	const sockaddr_in *destinations[UDP_MAX_DESTINATIONS];
+	const unsigned num_destinations = get_udp_destinations(destinations);
+	const unsigned num_datagrams = _udp_batch->datagrams;
+
+#if defined(MAVLINK_UDP_SENDMMSG)
+	// all datagrams to all destinations with a single syscall
+	mmsghdr msgs[UDP_BATCH_MAX_DATAGRAMS * UDP_MAX_DESTINATIONS] {};
+	iovec iovs[UDP_BATCH_MAX_DATAGRAMS];
+	unsigned num_msgs = 0;
+
+	for (unsigned i = 0; i < num_datagrams; i++) {
+		iovs[i].iov_base = _udp_batch->buf[i];
+		iovs[i].iov_len = _udp_batch->len[i];
+	}
+
+	for (unsigned d = 0; d < num_destinations; d++) {
+		for (unsigned i = 0; i < num_datagrams; i++) {
+			msghdr &hdr = msgs[num_msgs++].msg_hdr;
+			hdr.msg_name = (void *)destinations[d];
+			hdr.msg_namelen = sizeof(sockaddr_in);
+			hdr.msg_iov = &iovs[i];
+			hdr.msg_iovlen = 1;
+		}
+	}
+
+	if (num_msgs > 0) {
+		const int sent = sendmmsg(_socket_fd, msgs, num_msgs, 0);
+		_udp_tx_syscalls++;
+
+		if (sent >= 0) {
+			_udp_tx_datagrams += sent;
+		}
+
+		if (sent < (int)num_msgs) {
+			// report the destination of the first datagram that was not sent
+			udp_send_failed(destinations[math::max(sent, 0) / num_datagrams]);
+			ret = -1;
+
+		} else {
+			_broadcast_failed_warned = false;
+		}
+	}
+
+#else
+
+	for (unsigned d = 0; d < num_destinations; d++) {
+		for (unsigned i = 0; i < num_datagrams; i++) {
+			const int sent = sendto(_socket_fd, _udp_batch->buf[i], _udp_batch->len[i], 0,
+						(const struct sockaddr *)destinations[d], sizeof(sockaddr_in));
+			_udp_tx_syscalls++;
+
+			if (sent <= 0) {
+				udp_send_failed(destinations[d]);
+				ret = -1;
+
+			} else {
+				_udp_tx_datagrams++;
+			}
+		}
+	}
+
+#endif // MAVLINK_UDP_SENDMMSG
+
+	_udp_tx_packets += _udp_batch->packets;
+
+	_udp_batch->datagrams = 1;
+	_udp_batch->len[0] = 0;
+	_udp_batch->packets = 0;
+
+	return ret;
+}
+
+int
+Mavlink::batch_udp_packet()
+{
+	int ret = 0;
+	unsigned current = _udp_batch->datagrams - 1;
+
+	if (_udp_batch->len[current] + _network_buf_len > UDP_BATCH_DATAGRAM_SIZE) {
+		// packet does not fit into the current datagram anymore, start a new one
+		if (_udp_batch->datagrams == UDP_BATCH_MAX_DATAGRAMS) {
+			ret = flush_udp_batch();
+
+		} else {
+			_udp_batch->datagrams++;
+		}
+
+		current = _udp_batch->datagrams - 1;
+		_udp_batch->len[current] = 0;
+	}
+
+	memcpy(&_udp_batch->buf[current][_udp_batch->len[current]], _network_buf, _network_buf_len);
+	_udp_batch->len[current] += _network_buf_len;
+	_udp_batch->packets++;
+
+	return ret;
+}
+#endif // MAVLINK_UDP
+
+int
+Mavlink::flush_send_batch()
+{
+	int ret = 0;
+
+#if defined(MAVLINK_UDP)
+
+	if (_udp_batch != nullptr) {
+		pthread_mutex_lock(&_send_mutex);
+		ret = flush_udp_batch();
+		pthread_mutex_unlock(&_send_mutex);
+	}
+
+#endif // MAVLINK_UDP
+
+	return ret;
+}
+
 int
 Mavlink::send_packet()
 {
@@ -800,43 +1024,42 @@ Mavlink::send_packet()
 
 	if (get_protocol() == Protocol::UDP) {
 
-#ifdef CONFIG_NET
+		if (_udp_batch != nullptr) {
+			// the packet is buffered: report its length unless sending (a full batch) failed
+			ret = (batch_udp_packet() == 0) ? _network_buf_len : -1;
 
-		if (_src_addr_initialized) {
-#endif
-			ret = sendto(_socket_fd, _network_buf, _network_buf_len, 0,
-				     (struct sockaddr *)&_src_addr, sizeof(_src_addr));
-#ifdef CONFIG_NET
-		}
-
-#endif
+			// the main loop flushes at the end of each iteration, other threads send right away
+			if (!pthread_equal(pthread_self(), _main_thread) && (flush_udp_batch() != 0)) {
+				ret = -1;
+			}
 
-		/* resend message via broadcast if no valid connection exists */
-		if ((_mode != MAVLINK_MODE_ONBOARD) && broadcast_enabled() &&
-		    (!get_client_source_initialized()
-		     || (hrt_elapsed_time(&_tstatus.heartbeat_time) > 3_s))) {
+		} else {
+			const sockaddr_in *destinations[UDP_MAX_DESTINATIONS];
+			const unsigned num_destinations = get_udp_destinations(destinations);
 
-			if (!_broadcast_address_found) {
-				find_broadcast_address();
-			}
+			for (unsigned d = 0; d < num_destinations; d++) {
+				const int sent = sendto(_socket_fd, _network_buf, _network_buf_len, 0,
+							(const struct sockaddr *)destinations[d], sizeof(sockaddr_in));
+				_udp_tx_syscalls++;
 
-			if (_broadcast_address_found && _network_buf_len > 0) {
+				if (sent <= 0) {
+					udp_send_failed(destinations[d]);
 
-				int bret = sendto(_socket_fd, _network_buf, _network_buf_len, 0,
-						  (struct sockaddr *)&_bcast_addr, sizeof(_bcast_addr));
+				} else {
+					_udp_tx_datagrams++;
 
-				if (bret <= 0) {
-					if (!_broadcast_failed_warned) {
-						PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
-						_broadcast_failed_warned = true;
+					if (destinations[d] == &_bcast_addr) {
+						_broadcast_failed_warned = false;
 					}
+				}
 
-				} else {
-					_broadcast_failed_warned = false;
+				if (destinations[d] == &_src_addr) {
+					ret = sent;
 				}
 			}
-		}
 
+			_udp_tx_packets++;
+		}
 	}
 
 	_network_buf_len = 0;
@@ -1267,7 +1490,7 @@ Mavlink::add_orb_subscription(const orb_id_t topic, int instance, bool disable_s
 	}
 
 	/* add new subscription */
-	MavlinkOrbSubscription *sub_new = new MavlinkOrbSubscription(topic, instance);
+	MavlinkOrbSubscription *sub_new = new MavlinkOrbSubscription(this, topic, instance);
 
 	_subscriptions.add(sub_new);
 
@@ -1347,6 +1570,7 @@ Mavlink::configure_stream_threadsafe(const char *stream_name, const float rate)
 		/* set subscription task */
 		_subscribe_to_stream_rate = rate;
 		_subscribe_to_stream = s;
+		wakeup();
 
 		/* wait for subscription */
 		do {
@@ -1357,118 +1581,42 @@ Mavlink::configure_stream_threadsafe(const char *stream_name, const float rate)
 	}
 }
 
-int
-Mavlink::message_buffer_init(int size)
-{
-	_message_buffer.size = size;
-	_message_buffer.write_ptr = 0;
-	_message_buffer.read_ptr = 0;
-	_message_buffer.data = (char *)malloc(_message_buffer.size);
-
-	int ret;
-
-	if (_message_buffer.data == nullptr) {
-		ret = PX4_ERROR;
-		_message_buffer.size = 0;
-
-	} else {
-		ret = OK;
-	}
-
-	return ret;
-}
-
 void
-Mavlink::message_buffer_destroy()
-{
-	_message_buffer.size = 0;
-	_message_buffer.write_ptr = 0;
-	_message_buffer.read_ptr = 0;
-	free(_message_buffer.data);
-}
-
-int
-Mavlink::message_buffer_count()
-{
-	int n = _message_buffer.write_ptr - _message_buffer.read_ptr;
-
-	if (n < 0) {
-		n += _message_buffer.size;
-	}
-
-	return n;
-}
-
-bool
-Mavlink::message_buffer_write(const void *ptr, int size)
+Mavlink::pass_message(const mavlink_message_t *msg)
 {
-	// bytes available to write
-	int available = _message_buffer.read_ptr - _message_buffer.write_ptr - 1;
-
-	if (available < 0) {
-		available += _message_buffer.size;
-	}
-
-	if (size > available) {
-		// buffer overflow
-		return false;
-	}
-
-	char *c = (char *) ptr;
-	int n = _message_buffer.size - _message_buffer.write_ptr;	// bytes to end of the buffer
+	if (_forwarding_on) {
+		/* forward the frame as received: same sequence number, checksum and signature */
+		uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+		const uint16_t len = mavlink_msg_to_send_buffer(frame, msg);
 
-	if (n < size) {
-		// message goes over end of the buffer
-		memcpy(&(_message_buffer.data[_message_buffer.write_ptr]), c, n);
-		_message_buffer.write_ptr = 0;
+		/* the queue has a single producer, but several instances can forward to this one */
+		pthread_mutex_lock(&_forward_mutex);
+		const bool queued = _forward_queue.push(frame, len);
+		pthread_mutex_unlock(&_forward_mutex);
 
-	} else {
-		n = 0;
+		if (queued) {
+			wakeup();
+		}
 	}
-
-	// now: n = bytes already written
-	int p = size - n;	// number of bytes to write
-	memcpy(&(_message_buffer.data[_message_buffer.write_ptr]), &(c[n]), p);
-	_message_buffer.write_ptr = (_message_buffer.write_ptr + p) % _message_buffer.size;
-	return true;
 }
 
-int
-Mavlink::message_buffer_get_ptr(void **ptr, bool *is_part)
+void
+Mavlink::forward_pending_frames()
 {
-	// bytes available to read
-	int available = _message_buffer.write_ptr - _message_buffer.read_ptr;
+	const uint8_t *frame;
+	uint16_t len;
 
-	if (available == 0) {
-		return 0;	// buffer is empty
-	}
-
-	int n = 0;
-
-	if (available > 0) {
-		// read pointer is before write pointer, all available bytes can be read
-		n = available;
-		*is_part = false;
-
-	} else {
-		// read pointer is after write pointer, read bytes from read_ptr to end of the buffer
-		n = _message_buffer.size - _message_buffer.read_ptr;
-		*is_part = _message_buffer.write_ptr > 0;
-	}
+	while ((frame = _forward_queue.front(len)) != nullptr) {
+		/* send_bytes() drops what does not fit: keep the frame queued until there is room */
+		if (get_free_tx_buf() < len) {
+			break;
+		}
 
-	*ptr = &(_message_buffer.data[_message_buffer.read_ptr]);
-	return n;
-}
+		begin_send();
+		send_bytes(frame, len);
+		send_packet();
 
-void
-Mavlink::pass_message(const mavlink_message_t *msg)
-{
-	if (_forwarding_on) {
-		/* size is 8 bytes plus variable payload */
-		int size = MAVLINK_NUM_NON_PAYLOAD_BYTES + msg->len;
-		pthread_mutex_lock(&_message_buffer_mutex);
-		message_buffer_write(msg, size);
-		pthread_mutex_unlock(&_message_buffer_mutex);
+		_forward_queue.pop();
 	}
 }
 
@@ -1865,7 +2013,7 @@ Mavlink::task_main(int argc, char *argv[])
 	int temp_int_arg;
 #endif
 
-	while ((ch = px4_getopt(argc, argv, "b:r:d:n:u:o:m:t:c:fwxz", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "b:r:d:n:u:o:m:t:c:afwxz", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'b':
 			if (px4_get_parameter_value(myoptarg, _baudrate) != 0) {
@@ -2052,6 +2200,13 @@ Mavlink::task_main(int argc, char *argv[])
 			_force_flow_control = true;
 			break;
 
+#if defined(MAVLINK_UDP)
+
+		case 'a':
+			_udp_batching = true;
+			break;
+#endif // MAVLINK_UDP
+
 		default:
 			err_flag = true;
 			break;
@@ -2115,19 +2270,15 @@ Mavlink::task_main(int argc, char *argv[])
 	/* initialize send mutex */
 	pthread_mutex_init(&_send_mutex, nullptr);
 
-	/* if we are passing on mavlink messages, we need to prepare a buffer for this instance */
+	/* if we are passing on mavlink messages, we need to prepare a queue for this instance */
 	if (_forwarding_on) {
-		/* initialize message buffer if multiplexing is on.
-		 * make space for two messages plus off-by-one space as we use the empty element
-		 * marker ring buffer approach.
-		 */
-		if (OK != message_buffer_init(2 * sizeof(mavlink_message_t) + 1)) {
+		if (!_forward_queue.init(FORWARD_QUEUE_SIZE)) {
 			PX4_ERR("msg buf alloc fail");
 			return 1;
 		}
 
-		/* initialize message buffer mutex */
-		pthread_mutex_init(&_message_buffer_mutex, nullptr);
+		/* initialize forwarding producer mutex */
+		pthread_mutex_init(&_forward_mutex, nullptr);
 	}
 
 	MavlinkOrbSubscription *cmd_sub = add_orb_subscription(ORB_ID(vehicle_command), 0, true);
@@ -2175,7 +2326,7 @@ Mavlink::task_main(int argc, char *argv[])
 		PX4_ERR("configure_streams_to_default() failed");
 	}
 
-	/* set main loop delay depending on data rate to minimize CPU overhead */
+	/* set main loop delay depending on data rate, this bounds the polling of the shell and ulog streaming */
 	_main_loop_delay = (MAIN_LOOP_DELAY * 1000) / _datarate;
 
 	/* hard limit to 1000 Hz at max */
@@ -2200,6 +2351,17 @@ Mavlink::task_main(int argc, char *argv[])
 	/* init socket if necessary */
 	if (get_protocol() == Protocol::UDP) {
 		init_udp();
+
+		if (_udp_batching) {
+			_udp_batch = new UdpBatch();
+
+			if (_udp_batch == nullptr) {
+				PX4_ERR("UDP batch alloc failed, sending unbatched");
+
+			} else {
+				_udp_batch->datagrams = 1;
+			}
+		}
 	}
 
 #endif // MAVLINK_UDP
@@ -2209,15 +2371,21 @@ Mavlink::task_main(int argc, char *argv[])
 		send_autopilot_capabilites();
 	}
 
+	/* sends from this thread are batched until the end of a loop iteration */
+	_main_thread = pthread_self();
+
 	/* start the MAVLink receiver last to avoid a race */
 	MavlinkReceiver::receive_start(&_receive_thread, this);
 
+	hrt_abstime deadline = hrt_absolute_time();
+
 	while (!_task_should_exit) {
-		/* main loop */
-		px4_usleep(_main_loop_delay);
+		/* main loop: sleep until a stream is due or woken up by new data */
+		wait_for_wakeup(deadline);
 
 		if (!should_transmit()) {
 			check_requested_subscriptions();
+			deadline = hrt_absolute_time() + MAVLINK_IDLE_INTERVAL;
 			continue;
 		}
 
@@ -2393,50 +2561,7 @@ Mavlink::task_main(int argc, char *argv[])
 
 		/* pass messages from other UARTs */
 		if (_forwarding_on) {
-
-			bool is_part;
-			uint8_t *read_ptr;
-			uint8_t *write_ptr;
-
-			pthread_mutex_lock(&_message_buffer_mutex);
-			int available = message_buffer_get_ptr((void **)&read_ptr, &is_part);
-			pthread_mutex_unlock(&_message_buffer_mutex);
-
-			if (available > 0) {
-				// Reconstruct message from buffer
-
-				mavlink_message_t msg;
-				write_ptr = (uint8_t *)&msg;
-
-				// Pull a single message from the buffer
-				size_t read_count = available;
-
-				if (read_count > sizeof(mavlink_message_t)) {
-					read_count = sizeof(mavlink_message_t);
-				}
-
-				memcpy(write_ptr, read_ptr, read_count);
-
-				// We hold the mutex until after we complete the second part of the buffer. If we don't
-				// we may end up breaking the empty slot overflow detection semantics when we mark the
-				// possibly partial read below.
-				pthread_mutex_lock(&_message_buffer_mutex);
-
-				message_buffer_mark_read(read_count);
-
-				/* write second part of buffer if there is some */
-				if (is_part && read_count < sizeof(mavlink_message_t)) {
-					write_ptr += read_count;
-					available = message_buffer_get_ptr((void **)&read_ptr, &is_part);
-					read_count = sizeof(mavlink_message_t) - read_count;
-					memcpy(write_ptr, read_ptr, read_count);
-					message_buffer_mark_read(available);
-				}
-
-				pthread_mutex_unlock(&_message_buffer_mutex);
-
-				resend_message(&msg);
-			}
+			forward_pending_frames();
 		}
 
 		/* update TX/RX rates*/
@@ -2461,12 +2586,19 @@ Mavlink::task_main(int argc, char *argv[])
 			publish_telemetry_status();
 		}
 
+		/* send everything batched in this iteration */
+		flush_send_batch();
+
+		deadline = next_deadline(hrt_absolute_time());
+
 		perf_end(_loop_perf);
 
 		/* confirm task running only once fully initialized */
 		_task_running = true;
 	}
 
+	hrt_cancel(&_wakeup_call);
+
 	/* first wait for threads to complete before tearing down anything */
 	pthread_join(_receive_thread, nullptr);
 
@@ -2489,9 +2621,13 @@ Mavlink::task_main(int argc, char *argv[])
 		_socket_fd = -1;
 	}
 
+#if defined(MAVLINK_UDP)
+	delete _udp_batch;
+	_udp_batch = nullptr;
+#endif // MAVLINK_UDP
+
 	if (_forwarding_on) {
-		message_buffer_destroy();
-		pthread_mutex_destroy(&_message_buffer_mutex);
+		pthread_mutex_destroy(&_forward_mutex);
 	}
 
 	if (_mavlink_ulog) {
@@ -2586,10 +2722,18 @@ void Mavlink::publish_telemetry_status()
 	_tstatus.flow_control = get_flow_control_enabled();
 	_tstatus.ftp = ftp_enabled();
 	_tstatus.forwarding = get_forwarding_on();
+	_tstatus.forwarding_dropped = _forward_queue.dropped();
+	_tstatus.rx_parse_errors = _rx_parse_errors;
 	_tstatus.mavlink_v2 = (_protocol_version == 2);
 
 	_tstatus.streams = _streams.size();
 
+#if defined(MAVLINK_UDP)
+	_tstatus.udp_tx_packets = _udp_tx_packets;
+	_tstatus.udp_tx_datagrams = _udp_tx_datagrams;
+	_tstatus.udp_tx_syscalls = _udp_tx_syscalls;
+#endif // MAVLINK_UDP
+
 	_tstatus.timestamp = hrt_absolute_time();
 
 	_telem_status_pub.publish(_tstatus);
@@ -2774,12 +2918,17 @@ Mavlink::display_status()
 	printf("\t  tx rate mult: %.3f\n", (double)_rate_mult);
 	printf("\t  tx rate max: %i B/s\n", _datarate);
 	printf("\t  rx: %.3f kB/s\n", (double)_tstatus.rate_rx);
+	printf("\t  rx parse errors: %u\n", _rx_parse_errors);
 
 	if (_mavlink_ulog) {
 		printf("\tULog rate: %.1f%% of max %.1f%%\n", (double)_mavlink_ulog->current_data_rate() * 100.,
 		       (double)_mavlink_ulog->maximum_data_rate() * 100.);
 	}
 
+	if (_forwarding_on) {
+		printf("\tforwarding: %u frames dropped\n", _forward_queue.dropped());
+	}
+
 	printf("\tFTP enabled: %s, TX enabled: %s\n",
 	       _ftp_on ? "YES" : "NO",
 	       _transmitting_enabled ? "YES" : "NO");
@@ -2793,6 +2942,11 @@ Mavlink::display_status()
 
 	case Protocol::UDP:
 		printf("UDP (%i, remote port: %i)\n", _network_port, _remote_port);
+
+		if (_udp_tx_syscalls > 0) {
+			printf("\tUDP tx: %.2f packets/syscall%s\n", (double)_udp_tx_packets / _udp_tx_syscalls,
+			       (_udp_batch != nullptr) ? " (batched)" : "");
+		}
 #ifdef __PX4_POSIX
 
 		if (get_client_source_initialized()) {
@@ -3049,6 +3203,7 @@ $ mavlink stream -u 14556 -s HIGHRES_IMU -r 50
 	PRINT_MODULE_USAGE_PARAM_FLAG('w', "Wait to send, until first message received", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('x', "Enable FTP", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('z', "Force flow control always on", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('a', "Aggregate packets into MTU sized UDP datagrams, sent in batches", true);
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("stop-all", "Stop all instances");
 
@@ -78,6 +78,7 @@
 #include <uORB/topics/telemetry_status.h>
 
 #include "mavlink_command_sender.h"
+#include "mavlink_forward_queue.h"
 #include "mavlink_messages.h"
 #include "mavlink_orb_subscription.h"
 #include "mavlink_shell.h"
@@ -93,6 +94,11 @@
 # define DEFAULT_REMOTE_PORT_UDP 14550 ///< GCS port per MAVLink spec
 #endif // CONFIG_NET || __PX4_POSIX
 
+#if defined(MAVLINK_UDP) && defined(__PX4_LINUX)
+# define MAVLINK_UDP_SENDMMSG ///< send batched datagrams with a single sendmmsg() call
+# define MAVLINK_UDP_RECVMMSG ///< drain several received datagrams with a single recvmmsg() call
+#endif
+
 enum class Protocol {
 	SERIAL = 0,
 #if defined(MAVLINK_UDP)
@@ -338,9 +344,11 @@ public:
 	int             	send_packet();
 
 	/**
-	 * Resend message as is, don't change sequence number and CRC.
+	 * Send all packets batched so far (batched datagram mode only)
+	 *
+	 * @return 0 on success or -1 in case of error
 	 */
-	void			resend_message(mavlink_message_t *msg) { _mavlink_resend_uart(_channel, msg); }
+	int			flush_send_batch();
 
 	void			handle_message(const mavlink_message_t *msg);
 
@@ -423,11 +431,6 @@ public:
 	bool			get_wait_to_transmit() { return _wait_to_transmit; }
 	bool			should_transmit() { return (_transmitting_enabled && _boot_complete && (!_wait_to_transmit || (_wait_to_transmit && _received_messages))); }
 
-	bool			message_buffer_write(const void *ptr, int size);
-
-	void			lockMessageBufferMutex(void) { pthread_mutex_lock(&_message_buffer_mutex); }
-	void			unlockMessageBufferMutex(void) { pthread_mutex_unlock(&_message_buffer_mutex); }
-
 	/**
 	 * Count transmitted bytes
 	 */
@@ -443,6 +446,11 @@ public:
 	 */
 	void			count_rxbytes(unsigned n) { _bytes_rx += n; };
 
+	/**
+	 * Set the number of received frames rejected by the parser (bad CRC or unsupported flags)
+	 */
+	void			set_rx_parse_errors(uint32_t n) { _rx_parse_errors = n; }
+
 	/**
 	 * Get the receive status of this MAVLink link
 	 */
@@ -489,6 +497,16 @@ public:
 
 	unsigned		get_main_loop_delay() const { return _main_loop_delay; }
 
+	/**
+	 * Wake up the main loop, e.g. on new data for a stream or a request from another thread.
+	 */
+	void			wakeup();
+
+	/**
+	 * Account for how late a stream was sent after it was due.
+	 */
+	void			count_stream_latency(hrt_abstime latency) { perf_set_elapsed(_stream_latency_perf, latency); }
+
 	/** get the Mavlink shell. Create a new one if there isn't one. It is *always* created via MavlinkReceiver thread.
 	 *  Returns nullptr if shell cannot be created */
 	MavlinkShell		*get_shell();
@@ -502,10 +520,11 @@ public:
 		if (_mavlink_ulog) { return; }
 
 		_mavlink_ulog = MavlinkULog::try_start(_datarate, 0.7f, target_system, target_component);
+		wakeup();
 	}
 	void			request_stop_ulog_streaming()
 	{
-		if (_mavlink_ulog) { _mavlink_ulog_stop_requested = true; }
+		if (_mavlink_ulog) { _mavlink_ulog_stop_requested = true; wakeup(); }
 	}
 
 
@@ -551,6 +570,7 @@ private:
 	static constexpr int	MAVLINK_MAX_INSTANCES{4};
 	static constexpr int	MAVLINK_MIN_INTERVAL{1500};
 	static constexpr int	MAVLINK_MAX_INTERVAL{10000};
+	static constexpr int	MAVLINK_IDLE_INTERVAL{50000};	///< longest main loop sleep if no stream is due
 	static constexpr float	MAVLINK_MIN_MULTIPLIER{0.0005f};
 
 	mavlink_message_t	_mavlink_buffer {};
@@ -565,6 +585,10 @@ private:
 
 	unsigned		_main_loop_delay{1000};	/**< mainloop delay, depends on data rate */
 
+	px4_sem_t		_wakeup_sem;			/**< main loop wakeup on data or stream deadline */
+	px4::atomic_bool	_wakeup_pending{false};
+	hrt_call		_wakeup_call{};
+
 	List<MavlinkOrbSubscription *>	_subscriptions;
 	List<MavlinkStream *>		_streams;
 
@@ -619,6 +643,7 @@ private:
 	unsigned		_bytes_txerr{0};
 	unsigned		_bytes_rx{0};
 	uint64_t		_bytes_timestamp{0};
+	uint32_t		_rx_parse_errors{0};
 
 #if defined(MAVLINK_UDP)
 	sockaddr_in		_myaddr {};
@@ -632,6 +657,28 @@ private:
 	uint8_t			_network_buf[MAVLINK_MAX_PACKET_LEN] {};
 	unsigned		_network_buf_len{0};
 
+	static constexpr unsigned UDP_MAX_DESTINATIONS{2};	///< partner and broadcast
+	static constexpr unsigned UDP_BATCH_DATAGRAM_SIZE{1472};	///< UDP payload within an Ethernet MTU
+	static constexpr unsigned UDP_BATCH_MAX_DATAGRAMS{8};
+
+	/**
+	 * Packets aggregated into datagrams until the end of a main loop iteration (-a)
+	 */
+	struct UdpBatch {
+		uint8_t buf[UDP_BATCH_MAX_DATAGRAMS][UDP_BATCH_DATAGRAM_SIZE];
+		unsigned len[UDP_BATCH_MAX_DATAGRAMS];
+		unsigned datagrams;	///< datagrams in use, the last one is being filled
+		unsigned packets;
+	};
+
+	bool			_udp_batching{false};
+	UdpBatch		*_udp_batch{nullptr};
+	pthread_t		_main_thread{};
+
+	uint32_t		_udp_tx_packets{0};
+	uint32_t		_udp_tx_datagrams{0};
+	uint32_t		_udp_tx_syscalls{0};
+
 	unsigned short		_network_port{14556};
 	unsigned short		_remote_port{DEFAULT_REMOTE_PORT_UDP};
 #endif // MAVLINK_UDP
@@ -646,16 +693,14 @@ private:
 
 	ping_statistics_s	_ping_stats {};
 
-	struct mavlink_message_buffer {
-		int write_ptr;
-		int read_ptr;
-		int size;
-		char *data;
-	};
-
-	mavlink_message_buffer	_message_buffer {};
+#if defined(__PX4_NUTTX)
+	static constexpr uint32_t FORWARD_QUEUE_SIZE{2048};	///< forwarded frames buffer size in bytes
+#else
+	static constexpr uint32_t FORWARD_QUEUE_SIZE{16384};
+#endif
 
-	pthread_mutex_t		_message_buffer_mutex {};
+	MavlinkForwardQueue	_forward_queue;			///< raw frames forwarded from other instances
+	pthread_mutex_t		_forward_mutex {};		///< serializes the producers of _forward_queue
 	pthread_mutex_t		_send_mutex {};
 
 	DEFINE_PARAMETERS(
@@ -677,6 +722,7 @@ private:
 
 	perf_counter_t		_loop_perf{perf_alloc(PC_ELAPSED, "mavlink_el")};		/**< loop performance counter */
 	perf_counter_t		_loop_interval_perf{perf_alloc(PC_INTERVAL, "mavlink_int")};	/**< loop interval performance counter */
+	perf_counter_t		_stream_latency_perf{perf_alloc(PC_ELAPSED, "mavlink_lat")};	/**< stream send delay after due */
 
 	void			mavlink_update_parameters();
 
@@ -704,23 +750,49 @@ private:
 	 */
 	int configure_streams_to_default(const char *configure_single_stream = nullptr);
 
-	int message_buffer_init(int size);
+	/**
+	 * Queue a message received by another instance for forwarding on this link.
+	 * Called from the receive threads of the other instances.
+	 */
+	void pass_message(const mavlink_message_t *msg);
 
-	void message_buffer_destroy();
+	/**
+	 * Send the frames queued for forwarding, as long as they fit into the TX buffer.
+	 */
+	void forward_pending_frames();
 
-	int message_buffer_count();
+	void publish_telemetry_status();
 
-	int message_buffer_is_empty() const { return (_message_buffer.read_ptr == _message_buffer.write_ptr); }
+	void check_requested_subscriptions();
 
-	int message_buffer_get_ptr(void **ptr, bool *is_part);
+#if defined(MAVLINK_UDP)
+	unsigned get_udp_destinations(const sockaddr_in *destinations[UDP_MAX_DESTINATIONS]);
+	void udp_send_failed(const sockaddr_in *destination);
 
-	void message_buffer_mark_read(int n) { _message_buffer.read_ptr = (_message_buffer.read_ptr + n) % _message_buffer.size; }
+	/**
+	 * Move the packet in _network_buf into the batch, flushing the batch if it is full.
+	 * @return 0 on success, -1 if flushing the full batch failed
+	 */
+	int batch_udp_packet();
 
-	void pass_message(const mavlink_message_t *msg);
+	/**
+	 * Send the batched datagrams to all destinations.
+	 * @return 0 on success, -1 if sending any datagram failed
+	 */
+	int flush_udp_batch();
+#endif // MAVLINK_UDP
 
-	void publish_telemetry_status();
+	static void wakeup_trampoline(void *arg);
 
-	void check_requested_subscriptions();
+	/**
+	 * Sleep until woken up by new data, a request or the deadline.
+	 */
+	void wait_for_wakeup(hrt_abstime deadline);
+
+	/**
+	 * Get the main loop deadline: the time the next stream is due.
+	 */
+	hrt_abstime next_deadline(const hrt_abstime &now);
 
 	/**
 	 * Check the configuration of a connected radio
@@ -901,6 +901,7 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			_transfer_dataman_id = (_dataman_id == DM_KEY_WAYPOINTS_OFFBOARD_0 ? DM_KEY_WAYPOINTS_OFFBOARD_1 :
 						DM_KEY_WAYPOINTS_OFFBOARD_0);	// use inactive storage for transmission
 			_transfer_current_seq = -1;
+			_transfer_items_count = 0;
 
 			if (_mission_type == MAV_MISSION_TYPE_FENCE) {
 				// We're about to write new geofence items, so take the lock. It will be released when
@@ -957,6 +958,9 @@ MavlinkMissionManager::switch_to_idle_state()
 		PX4_DEBUG("unlocking geofence");
 	}
 
+	// discard buffered items of an aborted transfer
+	_transfer_items_count = 0;
+
 	_state = MAVLINK_WPM_STATE_IDLE;
 }
 
@@ -1066,10 +1070,16 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 					check_failed = true;
 
 				} else {
-					dm_item_t dm_item = _transfer_dataman_id;
+					// buffer the items and write them in blocks, to reduce the number of dataman requests
+					_transfer_items[_transfer_items_count++] = mission_item;
+
+					if (_transfer_items_count == TRANSFER_ITEMS_BUFFER_SIZE || wp.seq + 1 == _transfer_count) {
+						const unsigned first_seq = wp.seq + 1 - _transfer_items_count;
 
-					write_failed = dm_write(dm_item, wp.seq, DM_PERSIST_POWER_ON_RESET, &mission_item,
-								sizeof(struct mission_item_s)) != sizeof(struct mission_item_s);
+						write_failed = dm_write_range(_transfer_dataman_id, first_seq, DM_PERSIST_POWER_ON_RESET, _transfer_items,
+									      sizeof(struct mission_item_s), _transfer_items_count) != (ssize_t)_transfer_items_count;
+						_transfer_items_count = 0;
+					}
 
 					if (!write_failed) {
 						/* waypoint marked as current */
@@ -121,6 +121,10 @@ private:
 
 	int32_t			_transfer_current_seq{-1};		///< Current item ID for current transmission (-1 means not initialized)
 
+	static constexpr unsigned	TRANSFER_ITEMS_BUFFER_SIZE = 8;
+	mission_item_s		_transfer_items[TRANSFER_ITEMS_BUFFER_SIZE];	///< Received mission items, written to dataman in blocks
+	unsigned		_transfer_items_count{0};		///< Number of buffered mission items (ending at _transfer_seq)
+
 	uint8_t			_transfer_partner_sysid{0};		///< Partner system ID for current transmission
 	uint8_t			_transfer_partner_compid{0};		///< Partner component ID for current transmission
 
@@ -38,11 +38,12 @@
  */
 
 #include "mavlink_orb_subscription.h"
+#include "mavlink_main.h"
 
 bool
 MavlinkOrbSubscription::is_published()
 {
-	const bool published = _sub.published();
+	const bool published = _sub.get().published();
 
 	if (published) {
 		return true;
@@ -50,8 +51,39 @@ MavlinkOrbSubscription::is_published()
 	} else if (!published && _subscribe_from_beginning) {
 		// For some topics like vehicle_command_ack, we want to subscribe
 		// from the beginning in order not to miss or delay the first publish respective advertise.
-		return _sub.subscribe();
+		return _sub.get().subscribe();
 	}
 
 	return false;
 }
+
+bool
+MavlinkOrbSubscription::WakeupSubscription::arm_unless(bool updated)
+{
+	if (!updated) {
+		// register with every topic, including ones not advertised yet, so that the stream does not
+		// have to poll for its first publication
+		if (!_registered) {
+			_registered = register_callback();
+		}
+
+		_armed.store(true);
+
+		// a publication between the update and arming did not wake us up
+		if (_subscription.updated()) {
+			call();
+		}
+	}
+
+	return updated;
+}
+
+void
+MavlinkOrbSubscription::WakeupSubscription::call()
+{
+	// called by the publisher, wake up once per requested update
+	if (_armed.load()) {
+		_armed.store(false);
+		_mavlink->wakeup();
+	}
+}
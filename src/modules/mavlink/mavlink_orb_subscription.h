@@ -43,13 +43,16 @@
 
 #include <drivers/drv_hrt.h>
 #include <containers/List.hpp>
-#include <uORB/Subscription.hpp>
+#include <px4_atomic.h>
+#include <uORB/SubscriptionCallback.hpp>
+
+class Mavlink;
 
 class MavlinkOrbSubscription : public ListNode<MavlinkOrbSubscription *>
 {
 public:
 
-	MavlinkOrbSubscription(const orb_id_t topic, int instance) : _sub(topic, instance) {}
+	MavlinkOrbSubscription(Mavlink *mavlink, const orb_id_t topic, int instance) : _sub(mavlink, topic, instance) {}
 	~MavlinkOrbSubscription() = default;
 
 	/**
@@ -61,14 +64,14 @@ public:
 	 * still copy the data.
 	 * If no data available data buffer will be filled with zeros.
 	 */
-	bool update(uint64_t *time, void *data) { return _sub.update(time, data); }
+	bool update(uint64_t *time, void *data) { return _sub.arm_unless(_sub.get().update(time, data)); }
 
 	/**
 	 * Copy topic data to given buffer.
 	 *
 	 * @return true only if topic data copied successfully.
 	 */
-	bool update(void *data) { return _sub.copy(data); }
+	bool update(void *data) { return _sub.arm_unless(_sub.get().copy(data)); }
 
 	/**
 	 * Check if the subscription has been updated.
@@ -76,7 +79,7 @@ public:
 	 * @return true if there has been an update which has been
 	 * copied successfully.
 	 */
-	bool update_if_changed(void *data) { return _sub.update(data); }
+	bool update_if_changed(void *data) { return _sub.arm_unless(_sub.get().update(data)); }
 
 	/**
 	 * Check if the topic has been published.
@@ -94,7 +97,36 @@ public:
 
 private:
 
-	uORB::Subscription	_sub;
+	/**
+	 * Subscription that wakes up the mavlink main loop on the first publication
+	 * after an update was requested but there was no new data (or the topic was not published yet).
+	 */
+	class WakeupSubscription : public uORB::SubscriptionCallback
+	{
+	public:
+		WakeupSubscription(Mavlink *mavlink, const orb_id_t topic, int instance) :
+			SubscriptionCallback(topic, 0, instance),
+			_mavlink(mavlink)
+		{}
+
+		uORB::Subscription &get() { return _subscription; }
+
+		/**
+		 * Arm the wakeup if an update did not return new data.
+		 *
+		 * @return updated
+		 */
+		bool arm_unless(bool updated);
+
+		void call() override;
+
+	private:
+		Mavlink *const _mavlink;
+		px4::atomic_bool _armed{false};
+		bool _registered{false};
+	};
+
+	WakeupSubscription	_sub;
 
 	bool _subscribe_from_beginning{false}; ///< we need to subscribe from the beginning, e.g. for vehicle_command_acks
 };
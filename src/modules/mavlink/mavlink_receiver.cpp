@@ -83,7 +83,8 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_mavlink_log_handler(parent),
 	_mission_manager(parent),
 	_parameters_manager(parent),
-	_mavlink_timesync(parent)
+	_mavlink_timesync(parent),
+	_frame_parser(parent->get_channel())
 {
 }
 
@@ -2545,7 +2546,6 @@ MavlinkReceiver::Run()
 	/* the serial port buffers internally as well, we just need to fit a small chunk */
 	uint8_t buf[64];
 #endif
-	mavlink_message_t msg;
 
 	struct pollfd fds[1] = {};
 
@@ -2556,7 +2556,9 @@ MavlinkReceiver::Run()
 
 #if defined(MAVLINK_UDP)
 	struct sockaddr_in srcaddr = {};
+#if !defined(MAVLINK_UDP_RECVMMSG)
 	socklen_t addrlen = sizeof(srcaddr);
+#endif // !MAVLINK_UDP_RECVMMSG
 
 	if (_mavlink->get_protocol() == Protocol::UDP) {
 		fds[0].fd = _mavlink->get_socket_fd();
@@ -2565,6 +2567,27 @@ MavlinkReceiver::Run()
 
 #endif // MAVLINK_UDP
 
+#if defined(MAVLINK_UDP_RECVMMSG)
+	/* drain up to UDP_RECV_DATAGRAMS datagrams per wakeup, each into its own MTU sized slot of buf */
+	static constexpr int UDP_RECV_DATAGRAMS = 5;
+	static constexpr size_t UDP_RECV_SLOT = sizeof(buf) / UDP_RECV_DATAGRAMS;
+	static_assert(UDP_RECV_SLOT >= 1500, "receive slot must fit a full datagram");
+
+	struct sockaddr_in srcaddrs[UDP_RECV_DATAGRAMS] {};
+	struct iovec iovecs[UDP_RECV_DATAGRAMS] {};
+	struct mmsghdr msgs[UDP_RECV_DATAGRAMS] {};
+
+	for (int d = 0; d < UDP_RECV_DATAGRAMS; d++) {
+		iovecs[d].iov_base = &buf[d * UDP_RECV_SLOT];
+		iovecs[d].iov_len = UDP_RECV_SLOT;
+		msgs[d].msg_hdr.msg_iov = &iovecs[d];
+		msgs[d].msg_hdr.msg_iovlen = 1;
+		msgs[d].msg_hdr.msg_name = &srcaddrs[d];
+	}
+
+	int datagrams = 0;
+#endif // MAVLINK_UDP_RECVMMSG
+
 	ssize_t nread = 0;
 	hrt_abstime last_send_update = 0;
 
@@ -2575,6 +2598,11 @@ MavlinkReceiver::Run()
 		}
 
 		if (poll(&fds[0], 1, timeout) > 0) {
+			nread = 0;
+#if defined(MAVLINK_UDP_RECVMMSG)
+			datagrams = 0;
+#endif // MAVLINK_UDP_RECVMMSG
+
 			if (_mavlink->get_protocol() == Protocol::SERIAL) {
 
 				/*
@@ -2594,7 +2622,21 @@ MavlinkReceiver::Run()
 
 			else if (_mavlink->get_protocol() == Protocol::UDP) {
 				if (fds[0].revents & POLLIN) {
+#if defined(MAVLINK_UDP_RECVMMSG)
+
+					for (int d = 0; d < UDP_RECV_DATAGRAMS; d++) {
+						msgs[d].msg_hdr.msg_namelen = sizeof(srcaddrs[d]);
+					}
+
+					datagrams = recvmmsg(_mavlink->get_socket_fd(), msgs, UDP_RECV_DATAGRAMS, MSG_DONTWAIT, nullptr);
+
+					if (datagrams > 0) {
+						srcaddr = srcaddrs[datagrams - 1];
+					}
+
+#else
 					nread = recvfrom(_mavlink->get_socket_fd(), buf, sizeof(buf), 0, (struct sockaddr *)&srcaddr, &addrlen);
+#endif // MAVLINK_UDP_RECVMMSG
 				}
 
 				struct sockaddr_in &srcaddr_last = _mavlink->get_client_source_address();
@@ -2625,46 +2667,16 @@ MavlinkReceiver::Run()
 			if (_mavlink->get_client_source_initialized()) {
 #endif // MAVLINK_UDP
 
-				/* if read failed, this loop won't execute */
-				for (ssize_t i = 0; i < nread; i++) {
-					if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &_status)) {
-
-						/* check if we received version 2 and request a switch. */
-						if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
-							/* this will only switch to proto version 2 if allowed in settings */
-							_mavlink->set_proto_version(2);
-						}
-
-						/* handle generic messages and commands */
-						handle_message(&msg);
-
-						/* handle packet with mission manager */
-						_mission_manager.handle_message(&msg);
-
+#if defined(MAVLINK_UDP_RECVMMSG)
 
-						/* handle packet with parameter component */
-						_parameters_manager.handle_message(&msg);
-
-						if (_mavlink->ftp_enabled()) {
-							/* handle packet with ftp component */
-							_mavlink_ftp.handle_message(&msg);
-						}
-
-						/* handle packet with log component */
-						_mavlink_log_handler.handle_message(&msg);
-
-						/* handle packet with timesync component */
-						_mavlink_timesync.handle_message(&msg);
-
-						/* handle packet with parent object */
-						_mavlink->handle_message(&msg);
-					}
+				for (int d = 0; d < datagrams; d++) {
+					handle_received_bytes(&buf[d * UDP_RECV_SLOT], msgs[d].msg_len);
 				}
 
-				/* count received bytes (nread will be -1 on read error) */
-				if (nread > 0) {
-					_mavlink->count_rxbytes(nread);
-				}
+#endif // MAVLINK_UDP_RECVMMSG
+
+				/* if read failed, nothing is parsed */
+				handle_received_bytes(buf, nread);
 
 #if defined(MAVLINK_UDP)
 			}
@@ -2691,6 +2703,55 @@ MavlinkReceiver::Run()
 	}
 }
 
+void
+MavlinkReceiver::handle_received_bytes(const uint8_t *buf, ssize_t len)
+{
+	/* nothing to do if the read failed (len will be -1 on read error) */
+	if (len <= 0) {
+		return;
+	}
+
+	size_t remaining = len;
+	mavlink_message_t msg;
+
+	while (_frame_parser.parse(buf, remaining, &msg)) {
+
+		/* check if we received version 2 and request a switch. */
+		if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
+			/* this will only switch to proto version 2 if allowed in settings */
+			_mavlink->set_proto_version(2);
+		}
+
+		/* handle generic messages and commands */
+		handle_message(&msg);
+
+		/* handle packet with mission manager */
+		_mission_manager.handle_message(&msg);
+
+
+		/* handle packet with parameter component */
+		_parameters_manager.handle_message(&msg);
+
+		if (_mavlink->ftp_enabled()) {
+			/* handle packet with ftp component */
+			_mavlink_ftp.handle_message(&msg);
+		}
+
+		/* handle packet with log component */
+		_mavlink_log_handler.handle_message(&msg);
+
+		/* handle packet with timesync component */
+		_mavlink_timesync.handle_message(&msg);
+
+		/* handle packet with parent object */
+		_mavlink->handle_message(&msg);
+	}
+
+	/* count received bytes */
+	_mavlink->count_rxbytes(len);
+	_mavlink->set_rx_parse_errors(_frame_parser.parse_errors());
+}
+
 void *
 MavlinkReceiver::start_helper(void *context)
 {
@@ -41,6 +41,7 @@
 
 #pragma once
 
+#include "mavlink_frame_parser.h"
 #include "mavlink_ftp.h"
 #include "mavlink_log_handler.h"
 #include "mavlink_mission.h"
@@ -202,6 +203,11 @@ private:
 	 */
 	void update_params();
 
+	/**
+	 * Parse a chunk of received bytes and dispatch all contained messages.
+	 */
+	void handle_received_bytes(const uint8_t *buf, ssize_t len);
+
 	Mavlink				*_mavlink;
 
 	MavlinkFTP			_mavlink_ftp;
@@ -210,7 +216,7 @@ private:
 	MavlinkParametersManager	_parameters_manager;
 	MavlinkTimesync			_mavlink_timesync;
 
-	mavlink_status_t		_status{}; ///< receiver status, used for mavlink_parse_char()
+	MavlinkFrameParser		_frame_parser;
 
 	// ORB publications
 	uORB::Publication<actuator_controls_s>			_actuator_controls_pubs[4] {ORB_ID(actuator_controls_0), ORB_ID(actuator_controls_1), ORB_ID(actuator_controls_2), ORB_ID(actuator_controls_3)};
@@ -66,10 +66,14 @@ MavlinkStream::update(const hrt_abstime &t)
 		// on the link scheduling
 		if (send(t)) {
 			_last_sent = hrt_absolute_time();
+			_waiting_for_data = 0;
 
 			if (!_first_message_sent) {
 				_first_message_sent = true;
 			}
+
+		} else {
+			_waiting_for_data = t;
 		}
 
 		return 0;
@@ -82,11 +86,7 @@ MavlinkStream::update(const hrt_abstime &t)
 	}
 
 	int64_t dt = t - _last_sent;
-	int interval = (_interval > 0) ? _interval : 0;
-
-	if (!const_rate()) {
-		interval /= _mavlink->get_rate_mult();
-	}
+	const int interval = get_effective_interval();
 
 	// Send the message if it is due or
 	// if it will overrun the next scheduled send interval
@@ -106,7 +106,12 @@ MavlinkStream::update(const hrt_abstime &t)
 		// distort the average rate. The check of the maximum interval is done to ensure that after a
 		// long time not sending anything, sending multiple messages in a short time is avoided.
 		if (send(t)) {
+			if (interval > 0 && dt > interval) {
+				_mavlink->count_stream_latency(dt - interval);
+			}
+
 			_last_sent = ((interval > 0) && ((int64_t)(1.5f * interval) > dt)) ? _last_sent + interval : t;
+			_waiting_for_data = 0;
 
 			if (!_first_message_sent) {
 				_first_message_sent = true;
@@ -115,9 +120,47 @@ MavlinkStream::update(const hrt_abstime &t)
 			return 0;
 
 		} else {
+			_waiting_for_data = t;
 			return -1;
 		}
 	}
 
 	return -1;
 }
+
+int
+MavlinkStream::get_effective_interval()
+{
+	int interval = (_interval > 0) ? _interval : 0;
+
+	if (!const_rate()) {
+		interval /= _mavlink->get_rate_mult();
+	}
+
+	return interval;
+}
+
+hrt_abstime
+MavlinkStream::get_next_due()
+{
+	const int interval = get_effective_interval();
+
+	if (_waiting_for_data != 0) {
+		// new data on the stream topics wakes up the main loop (see MavlinkOrbSubscription), a stream that
+		// had nothing to send for other reasons is retried one interval after the attempt
+		return (interval > 0) ? _waiting_for_data + interval : 0;
+	}
+
+	if (_last_sent == 0) {
+		// never sent, due immediately
+		return 1;
+	}
+
+	if (interval == 0) {
+		// unlimited rate, at most once per main loop delay like the fixed rate loop
+		return _last_sent + _mavlink->get_main_loop_delay();
+	}
+
+	// same early send margin as in update(), which requires dt to exceed it
+	return _last_sent + interval - (_mavlink->get_main_loop_delay() / 10) * 3 + 1;
+}
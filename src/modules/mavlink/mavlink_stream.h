@@ -79,6 +79,14 @@ public:
 	 * @return 0 if updated / sent, -1 if unchanged
 	 */
 	int update(const hrt_abstime &t);
+
+	/**
+	 * Get the time the stream is due to be sent next.
+	 *
+	 * @return the deadline, or 0 if there is none. A stream that is waiting for new data is woken up
+	 * by the data, and retried one interval after the last attempt at the latest.
+	 */
+	hrt_abstime get_next_due();
 	virtual const char *get_name() const = 0;
 	virtual uint16_t get_id() = 0;
 
@@ -128,8 +136,11 @@ protected:
 	virtual void update_data() { }
 
 private:
+	int get_effective_interval();
+
 	hrt_abstime _last_sent{0};
 	bool _first_message_sent{false};
+	hrt_abstime _waiting_for_data{0};	///< time at which send() had nothing new to send, 0 if not waiting
 };
 
 
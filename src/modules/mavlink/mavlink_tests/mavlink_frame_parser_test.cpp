@@ -0,0 +1,418 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_frame_parser_test.cpp
+
+#include <crc32.h>
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mavlink_frame_parser_test.h"
+
+/// Channel used by the parsers under test. A running mavlink instance is unlikely to use the last one,
+/// so its status is left alone.
+static constexpr mavlink_channel_t test_channel = (mavlink_channel_t)(MAVLINK_COMM_NUM_BUFFERS - 1);
+
+MavlinkFrameParserTest::MavlinkFrameParserTest(const char *capture_file) :
+	_capture_file(capture_file)
+{
+}
+
+MavlinkFrameParserTest::~MavlinkFrameParserTest()
+{
+	delete[] _stream;
+}
+
+void MavlinkFrameParserTest::_init()
+{
+	if (_stream == nullptr) {
+		_stream = new uint8_t[STREAM_SIZE];
+		_stream_size = (_stream != nullptr) ? (size_t)STREAM_SIZE : 0;
+	}
+
+	_stream_len = 0;
+	_tx_status = {};
+	srand(42);
+}
+
+void MavlinkFrameParserTest::_cleanup()
+{
+}
+
+bool MavlinkFrameParserTest::_append_msg(uint32_t msgid, const void *payload, uint8_t min_len, uint8_t len,
+		uint8_t crc_extra)
+{
+	if (_stream_len + MAVLINK_MAX_PACKET_LEN > _stream_size) {
+		return false;
+	}
+
+	mavlink_message_t msg{};
+	memcpy(_MAV_PAYLOAD_NON_CONST(&msg), payload, len);
+	msg.msgid = msgid;
+	mavlink_finalize_message_buffer(&msg, 1, MAV_COMP_ID_OBSTACLE_AVOIDANCE, &_tx_status, min_len, len, crc_extra);
+	_stream_len += mavlink_msg_to_send_buffer(&_stream[_stream_len], &msg);
+
+	return true;
+}
+
+#define APPEND_MSG(NAME, payload) _append_msg(MAVLINK_MSG_ID_##NAME, &payload, MAVLINK_MSG_ID_##NAME##_MIN_LEN, \
+		MAVLINK_MSG_ID_##NAME##_LEN, MAVLINK_MSG_ID_##NAME##_CRC)
+
+unsigned MavlinkFrameParserTest::_generate_stream(bool mavlink1, bool noise, unsigned max_msgs)
+{
+	if (mavlink1) {
+		_tx_status.flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+	}
+
+	unsigned count = 0;
+
+	for (uint32_t i = 0; count < max_msgs; i++) {
+		if (noise && (i % 3 == 0) && _stream_len + 3 < _stream_size) {
+			// a stray start marker whose length field swallows part of the next frame
+			_stream[_stream_len++] = (i % 2) ? MAVLINK_STX : MAVLINK_STX_MAVLINK1;
+			_stream[_stream_len++] = (uint8_t)(i % 64);
+			_stream[_stream_len++] = 0;
+		}
+
+		bool ok = true;
+		const size_t stream_len = _stream_len;
+
+		switch (i % 4) {
+		case 0: {
+				mavlink_heartbeat_t heartbeat{};
+				heartbeat.type = MAV_TYPE_ONBOARD_CONTROLLER;
+				heartbeat.autopilot = MAV_AUTOPILOT_INVALID;
+				ok = APPEND_MSG(HEARTBEAT, heartbeat);
+			}
+			break;
+
+		case 1: {
+				mavlink_set_position_target_local_ned_t setpoint{};
+				setpoint.time_boot_ms = i;
+				setpoint.x = 0.01f * i;
+				setpoint.vx = 1.f;
+				setpoint.type_mask = 0x0FF8;
+				setpoint.target_system = 1;
+				setpoint.coordinate_frame = MAV_FRAME_LOCAL_NED;
+				ok = APPEND_MSG(SET_POSITION_TARGET_LOCAL_NED, setpoint);
+			}
+			break;
+
+		case 2: {
+				mavlink_obstacle_distance_t obstacle{};
+				obstacle.time_usec = i;
+
+				// only a part of the sectors is filled, the trailing zeros are truncated by MAVLink 2
+				for (int j = 0; j < 36; j++) {
+					obstacle.distances[j] = (uint16_t)(100 + (i + j) % 500);
+				}
+
+				obstacle.increment = 5;
+				obstacle.min_distance = 20;
+				obstacle.max_distance = 2000;
+				ok = APPEND_MSG(OBSTACLE_DISTANCE, obstacle);
+			}
+			break;
+
+		case 3:
+
+			// ODOMETRY has a 16 bit message ID and cannot be sent with MAVLink 1
+			if (!mavlink1) {
+				mavlink_odometry_t odometry{};
+				odometry.time_usec = i;
+				odometry.x = 0.1f * i;
+				odometry.q[0] = 1.f;
+				odometry.pose_covariance[0] = NAN;
+				odometry.velocity_covariance[0] = NAN;
+				ok = APPEND_MSG(ODOMETRY, odometry);
+			}
+
+			break;
+		}
+
+		if (!ok) {
+			break;
+		}
+
+		if (_stream_len != stream_len) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+bool MavlinkFrameParserTest::_load_capture()
+{
+	int fd = ::open(_capture_file, O_RDONLY);
+
+	if (fd < 0) {
+		PX4_ERR("failed to open %s", _capture_file);
+		return false;
+	}
+
+	ssize_t nread = ::read(fd, _stream, _stream_size);
+	::close(fd);
+
+	if (nread <= 0) {
+		return false;
+	}
+
+	_stream_len = nread;
+	return true;
+}
+
+uint32_t MavlinkFrameParserTest::_fingerprint(const mavlink_message_t &msg)
+{
+	// both parsers zero fill truncated payloads up to the maximum message length
+	const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msg.msgid);
+	const size_t payload_len = entry ? entry->max_msg_len : msg.len;
+
+	const uint32_t header[] = {msg.msgid, msg.seq, msg.sysid, msg.compid, msg.len};
+	uint32_t crc = crc32part((const uint8_t *)header, sizeof(header), 0);
+
+	return crc32part(_MAV_PAYLOAD(&msg), payload_len, crc);
+}
+
+unsigned MavlinkFrameParserTest::_parse_reference(uint32_t *fingerprints)
+{
+	mavlink_message_t rxmsg{};
+	mavlink_status_t status{};
+	mavlink_message_t msg;
+	mavlink_status_t r_status;
+	unsigned count = 0;
+
+	for (size_t i = 0; i < _stream_len; i++) {
+		if (mavlink_frame_char_buffer(&rxmsg, &status, _stream[i], &msg, &r_status) == MAVLINK_FRAMING_OK) {
+			if (fingerprints && count < MAX_MSGS) {
+				fingerprints[count] = _fingerprint(msg);
+			}
+
+			count++;
+		}
+	}
+
+	return count;
+}
+
+unsigned MavlinkFrameParserTest::_parse_frames(uint32_t *fingerprints, size_t max_chunk)
+{
+	MavlinkFrameParser parser(test_channel);
+	mavlink_message_t msg;
+	unsigned count = 0;
+	size_t offset = 0;
+
+	while (offset < _stream_len) {
+		size_t chunk = (max_chunk > 1) ? 1 + rand() % max_chunk : 1;
+
+		if (chunk > _stream_len - offset) {
+			chunk = _stream_len - offset;
+		}
+
+		const uint8_t *buf = &_stream[offset];
+		size_t len = chunk;
+
+		while (parser.parse(buf, len, &msg)) {
+			if (fingerprints && count < MAX_MSGS) {
+				fingerprints[count] = _fingerprint(msg);
+			}
+
+			count++;
+		}
+
+		offset += chunk;
+	}
+
+	return count;
+}
+
+bool MavlinkFrameParserTest::_compare_test()
+{
+	ut_assert("stream allocation failed", _stream != nullptr);
+
+	for (int mavlink1 = 0; mavlink1 <= 1; mavlink1++) {
+		_init();
+		_generate_stream(mavlink1, false);
+
+		const unsigned ref_count = _parse_reference(_ref_fingerprints);
+		ut_assert("no messages generated", ref_count > 0);
+
+		// whole datagrams, typical serial reads and single bytes
+		const size_t max_chunks[] = {1500, 64, 1};
+
+		for (size_t max_chunk : max_chunks) {
+			const unsigned count = _parse_frames(_frame_fingerprints, max_chunk);
+			ut_compare("message count differs from reference parser", count, ref_count);
+
+			for (unsigned i = 0; i < ref_count && i < MAX_MSGS; i++) {
+				ut_compare("message differs from reference parser", _frame_fingerprints[i], _ref_fingerprints[i]);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MavlinkFrameParserTest::_resync_test()
+{
+	ut_assert("stream allocation failed", _stream != nullptr);
+
+	// reference: the same messages without noise
+	const unsigned msg_count = _generate_stream(false, true);
+	_init();
+	_generate_stream(false, false, msg_count);
+	const unsigned ref_count = _parse_reference(_ref_fingerprints);
+	ut_compare("reference parser lost messages", ref_count, msg_count);
+
+	_init();
+	_generate_stream(false, true);
+
+	// every frame must survive the noise in front of it, also if the noise and the frame arrive in different reads
+	const size_t max_chunks[] = {1500, 64, 1};
+
+	for (size_t max_chunk : max_chunks) {
+		const unsigned count = _parse_frames(_frame_fingerprints, max_chunk);
+		ut_assert("messages lost after noise", count >= ref_count);
+
+		unsigned matched = 0;
+
+		for (unsigned i = 0; i < count && i < MAX_MSGS && matched < ref_count; i++) {
+			if (_frame_fingerprints[i] == _ref_fingerprints[matched]) {
+				matched++;
+			}
+		}
+
+		ut_compare("messages lost after noise", matched, math::min(ref_count, (unsigned)MAX_MSGS));
+	}
+
+	return true;
+}
+
+bool MavlinkFrameParserTest::_crc_error_test()
+{
+	ut_assert("stream allocation failed", _stream != nullptr);
+
+	const unsigned msg_count = _generate_stream(false, false);
+	ut_assert("no messages generated", msg_count > 1);
+
+	// corrupt the checksum of the last frame
+	_stream[_stream_len - 1] ^= 0xFF;
+
+	mavlink_status_t *status = mavlink_get_channel_status(test_channel);
+	ut_assert("no channel status", status != nullptr);
+	*status = {};
+
+	MavlinkFrameParser parser(test_channel);
+	mavlink_message_t msg;
+	const uint8_t *buf = _stream;
+	size_t len = _stream_len;
+	unsigned count = 0;
+
+	while (parser.parse(buf, len, &msg)) {
+		count++;
+	}
+
+	ut_compare("corrupted frame not rejected", count, msg_count - 1);
+	ut_compare("parse error not counted", parser.parse_errors(), 1);
+	ut_compare("drop not counted", status->packet_rx_drop_count, 1);
+
+	return true;
+}
+
+bool MavlinkFrameParserTest::_benchmark_test()
+{
+	ut_assert("stream allocation failed", _stream != nullptr);
+
+	if (_capture_file) {
+		ut_assert("failed to load capture", _load_capture());
+
+	} else {
+		_generate_stream(false, false);
+	}
+
+	static constexpr int iterations = 100;
+	unsigned ref_count = 0;
+	unsigned count = 0;
+
+	hrt_abstime start = hrt_absolute_time();
+
+	for (int i = 0; i < iterations; i++) {
+		ref_count = _parse_reference(nullptr);
+	}
+
+	const hrt_abstime ref_elapsed = hrt_elapsed_time(&start);
+
+	start = hrt_absolute_time();
+
+	for (int i = 0; i < iterations; i++) {
+		count = _parse_frames(nullptr, 1500);
+	}
+
+	const hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+	ut_compare("message count differs from reference parser", count, ref_count);
+	ut_assert("no messages parsed", count > 0);
+
+	const double bytes = (double)_stream_len * iterations;
+	const double msgs = (double)count * iterations;
+
+	PX4_INFO("%zu bytes, %u messages", _stream_len, count);
+	PX4_INFO("mavlink_parse_char:  %8.1f MB/s %8.1f ns/msg", bytes / ref_elapsed, 1e3 * ref_elapsed / msgs);
+	PX4_INFO("MavlinkFrameParser:  %8.1f MB/s %8.1f ns/msg", bytes / elapsed, 1e3 * elapsed / msgs);
+
+	return true;
+}
+
+bool MavlinkFrameParserTest::run_tests()
+{
+	ut_run_test(_compare_test);
+	ut_run_test(_resync_test);
+	ut_run_test(_crc_error_test);
+	ut_run_test(_benchmark_test);
+
+	return (_tests_failed == 0);
+}
+
+bool mavlink_frame_parser_test(const char *capture_file)
+{
+	MavlinkFrameParserTest *test = new MavlinkFrameParserTest(capture_file);
+	bool success = test->run_tests();
+	test->print_results();
+	delete test;
+	return success;
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_frame_parser_test.h
+/// Compares MavlinkFrameParser against the reference mavlink_parse_char() state machine
+/// and benchmarks both on a replayed byte stream.
+
+#pragma once
+
+#include <limits.h>
+#include <unit_test.h>
+#include "../mavlink_bridge_header.h"
+#include "../mavlink_frame_parser.h"
+
+class MavlinkFrameParserTest : public UnitTest
+{
+public:
+	/// @param capture_file optional raw MAVLink byte stream to benchmark instead of the generated one
+	MavlinkFrameParserTest(const char *capture_file = nullptr);
+	virtual ~MavlinkFrameParserTest();
+
+	virtual bool run_tests(void);
+
+	// We don't want any of these
+	MavlinkFrameParserTest(const MavlinkFrameParserTest &) = delete;
+	MavlinkFrameParserTest &operator=(const MavlinkFrameParserTest &) = delete;
+
+private:
+	virtual void _init(void);
+	virtual void _cleanup(void);
+
+	bool _compare_test(void);
+	bool _resync_test(void);
+	bool _crc_error_test(void);
+	bool _benchmark_test(void);
+
+	/// fill the stream with typical offboard traffic, optionally with line noise between the frames
+	/// @return number of messages generated
+	unsigned _generate_stream(bool mavlink1, bool noise, unsigned max_msgs = UINT_MAX);
+	bool _append_msg(uint32_t msgid, const void *payload, uint8_t min_len, uint8_t len, uint8_t crc_extra);
+	bool _load_capture(void);
+
+	/// parse the stream with the reference parser, returns the number of messages
+	unsigned _parse_reference(uint32_t *fingerprints);
+
+	/// parse the stream with the frame parser in chunks of 1 to max_chunk bytes, returns the number of messages
+	unsigned _parse_frames(uint32_t *fingerprints, size_t max_chunk);
+
+	static uint32_t _fingerprint(const mavlink_message_t &msg);
+
+	static constexpr size_t		STREAM_SIZE = 16384;	///< generated stream size
+	static constexpr unsigned	MAX_MSGS = 1024;	///< fingerprints kept for comparison
+
+	const char	*_capture_file;
+
+	uint8_t		*_stream{nullptr};
+	size_t		_stream_len{0};
+	size_t		_stream_size{0};
+
+	mavlink_status_t	_tx_status{};
+
+	uint32_t	_ref_fingerprints[MAX_MSGS] {};
+	uint32_t	_frame_fingerprints[MAX_MSGS] {};
+};
+
+bool mavlink_frame_parser_test(const char *capture_file);
@@ -42,6 +42,8 @@
 #include "mavlink_ftp_test.h"
 #include "../mavlink_ftp.h"
 
+#include <parameters/param.h>
+
 #ifdef __PX4_NUTTX
 #define PX4_MAVLINK_TEST_DATA_DIR "/etc"
 #else
@@ -596,6 +598,100 @@ bool MavlinkFtpTest::_burst_test()
 	return true;
 }
 
+/// @brief Tests the parameter pack virtual file (open, read header, CRC)
+bool MavlinkFtpTest::_param_pack_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+	const char				*file = MavlinkFTP::kParamPackPath;
+
+	payload.opcode = MavlinkFTP::kCmdCalcFileCRC32;
+	payload.offset = 0;
+
+	bool success = _send_receive_msg(&payload,		// FTP payload header
+					 strlen(file) + 1,	// size in bytes of data
+					 (uint8_t *)file,	// Data to start into FTP message payload
+					 &reply);		// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("Incorrect payload size", reply->size, sizeof(uint32_t));
+	uint32_t crc = *((uint32_t *)&reply->data[0]);
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+
+	success = _send_receive_msg(&payload,		// FTP payload header
+				    strlen(file) + 1,	// size in bytes of data
+				    (uint8_t *)file,	// Data to start into FTP message payload
+				    &reply);		// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	uint32_t file_size = *((uint32_t *)&reply->data[0]);
+	ut_assert("File too small", file_size >= 3 * sizeof(uint16_t));
+
+	payload.opcode = MavlinkFTP::kCmdReadFile;
+	payload.session = reply->session;
+	payload.offset = 0;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	uint16_t header[3];
+	memcpy(header, reply->data, sizeof(header));
+	ut_compare("Magic incorrect", header[0], 0x671b);
+	ut_compare("Parameter count incorrect", header[1], param_count_used());
+	ut_compare("Total parameter count incorrect", header[2], param_count_used());
+
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = reply->session;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	// unchanged parameters: the file is not regenerated and the CRC matches
+	payload.opcode = MavlinkFTP::kCmdCalcFileCRC32;
+	payload.offset = 0;
+
+	success = _send_receive_msg(&payload,		// FTP payload header
+				    strlen(file) + 1,	// size in bytes of data
+				    (uint8_t *)file,	// Data to start into FTP message payload
+				    &reply);		// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("CRC changed", *((uint32_t *)&reply->data[0]), crc);
+
+	return true;
+}
+
 /// @brief Tests for correct reponse to a Read command on an invalid session.
 bool MavlinkFtpTest::_read_badsession_test()
 {
@@ -963,6 +1059,7 @@ bool MavlinkFtpTest::run_tests()
 	ut_run_test(_read_test);
 	ut_run_test(_read_badsession_test);
 	ut_run_test(_burst_test);
+	ut_run_test(_param_pack_test);
 	ut_run_test(_removedirectory_test);
 
 	// TODO FIX: Didn't get Nak back - (reply->opcode:128) (MavlinkFTP::kRspNak:129) (../../src/modules/mavlink/mavlink_tests/mavlink_ftp_test.cpp:730)
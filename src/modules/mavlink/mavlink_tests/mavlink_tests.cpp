@@ -38,10 +38,17 @@
 #include <systemlib/err.h>
 
 #include "mavlink_ftp_test.h"
+#include "mavlink_frame_parser_test.h"
 
 extern "C" __EXPORT int mavlink_tests_main(int argc, char *argv[]);
 
 int mavlink_tests_main(int argc, char *argv[])
 {
-	return mavlink_ftp_test() ? 0 : -1;
+	// an optional raw MAVLink capture is replayed by the parser benchmark
+	const char *capture_file = (argc > 1) ? argv[1] : nullptr;
+
+	bool success = mavlink_ftp_test();
+	success = mavlink_frame_parser_test(capture_file) && success;
+
+	return success ? 0 : -1;
 }
@@ -140,7 +140,7 @@ MulticopterAttitudeControl::parameter_update_poll()
 	/* Check if parameters have changed */
 	parameter_update_s param_update;
 
-	if (_params_sub.update(&param_update)) {
+	if (_params_sub.update(&param_update) && parametersChanged()) {
 		updateParams();
 		parameters_updated();
 	}
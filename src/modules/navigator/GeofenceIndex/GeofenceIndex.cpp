@@ -0,0 +1,281 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "GeofenceIndex.hpp"
+
+#include <lib/mathlib/math/Limits.hpp>
+
+bool GeofenceIndex::allocate(int max_areas, int max_vertices)
+{
+	clear();
+
+	_areas = new Area[max_areas];
+	_vertices = new Vertex[max_vertices];
+
+	if (!_areas || !_vertices) {
+		clear();
+		return false;
+	}
+
+	_max_areas = max_areas;
+	_max_vertices = max_vertices;
+	return true;
+}
+
+void GeofenceIndex::clear()
+{
+	delete[](_areas);
+	_areas = nullptr;
+	_num_areas = 0;
+	_max_areas = 0;
+
+	delete[](_vertices);
+	_vertices = nullptr;
+	_num_vertices = 0;
+	_max_vertices = 0;
+	_num_used_vertices = 0;
+
+	delete[](_bands);
+	_bands = nullptr;
+
+	delete[](_band_edges);
+	_band_edges = nullptr;
+	_num_band_edges = 0;
+}
+
+bool GeofenceIndex::addVertex(float x, float y)
+{
+	if (_num_vertices >= _max_vertices) {
+		return false;
+	}
+
+	_vertices[_num_vertices].x = x;
+	_vertices[_num_vertices].y = y;
+	++_num_vertices;
+	return true;
+}
+
+int GeofenceIndex::addPolygon(int vertex_count)
+{
+	if (vertex_count <= 0 || vertex_count > UINT16_MAX || vertex_count != _num_vertices - _num_used_vertices
+	    || _num_areas >= _max_areas) {
+		return -1;
+	}
+
+	Area &area = _areas[_num_areas];
+	area.vertex_index = _num_used_vertices;
+	area.vertex_count = vertex_count;
+	area.circle_radius = 0.f;
+	area.band_index = 0;
+	area.band_count = 0;
+	_num_used_vertices = _num_vertices;
+
+	return _num_areas++;
+}
+
+int GeofenceIndex::addCircle(float radius)
+{
+	if (_num_vertices - _num_used_vertices != 1 || _num_areas >= _max_areas) {
+		return -1;
+	}
+
+	Area &area = _areas[_num_areas];
+	area.vertex_index = _num_used_vertices;
+	area.vertex_count = 0;
+	area.circle_radius = radius;
+	area.band_index = 0;
+	area.band_count = 0;
+	_num_used_vertices = _num_vertices;
+
+	return _num_areas++;
+}
+
+bool GeofenceIndex::build()
+{
+	delete[](_bands);
+	_bands = nullptr;
+	delete[](_band_edges);
+	_band_edges = nullptr;
+	_num_band_edges = 0;
+
+	int num_bands = 0;
+
+	// bounding boxes & number of bands
+	for (int area_idx = 0; area_idx < _num_areas; ++area_idx) {
+		Area &area = _areas[area_idx];
+		const Vertex *vertices = &_vertices[area.vertex_index];
+
+		if (area.vertex_count == 0) { // circle
+			area.x_min = vertices[0].x - area.circle_radius;
+			area.x_max = vertices[0].x + area.circle_radius;
+			area.y_min = vertices[0].y - area.circle_radius;
+			area.y_max = vertices[0].y + area.circle_radius;
+			continue;
+		}
+
+		area.x_min = area.x_max = vertices[0].x;
+		area.y_min = area.y_max = vertices[0].y;
+
+		for (int i = 1; i < area.vertex_count; ++i) {
+			area.x_min = math::min(area.x_min, vertices[i].x);
+			area.x_max = math::max(area.x_max, vertices[i].x);
+			area.y_min = math::min(area.y_min, vertices[i].y);
+			area.y_max = math::max(area.y_max, vertices[i].y);
+		}
+
+		// a few edges per band
+		area.band_index = num_bands;
+		area.band_count = math::constrain(area.vertex_count / 2, 1, 64);
+		num_bands += area.band_count;
+	}
+
+	if (num_bands == 0) {
+		return true;
+	}
+
+	_bands = new Band[num_bands];
+
+	if (!_bands) {
+		return false;
+	}
+
+	// count the edges per band. An edge is in all the bands that its y range overlaps.
+	for (int b = 0; b < num_bands; ++b) {
+		_bands[b].num_edges = 0;
+	}
+
+	for (int pass = 0; pass < 2; ++pass) {
+		for (int area_idx = 0; area_idx < _num_areas; ++area_idx) {
+			const Area &area = _areas[area_idx];
+			const Vertex *vertices = &_vertices[area.vertex_index];
+			Band *bands = &_bands[area.band_index];
+
+			if (area.band_count == 0) { // circle
+				continue;
+			}
+
+			for (int i = 0, j = area.vertex_count - 1; i < area.vertex_count; j = i++) {
+				const int first_band = bandIndex(area, math::min(vertices[i].y, vertices[j].y));
+				const int last_band = bandIndex(area, math::max(vertices[i].y, vertices[j].y));
+
+				for (int b = first_band; b <= last_band; ++b) {
+					if (pass == 1) {
+						_band_edges[bands[b].first_edge + bands[b].num_edges] = i;
+					}
+
+					++bands[b].num_edges;
+				}
+			}
+		}
+
+		if (pass == 0) {
+			// assign the ranges in _band_edges
+			for (int b = 0; b < num_bands; ++b) {
+				_bands[b].first_edge = _num_band_edges;
+				_num_band_edges += _bands[b].num_edges;
+				_bands[b].num_edges = 0;
+			}
+
+			_band_edges = new uint16_t[_num_band_edges];
+
+			if (!_band_edges) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+int GeofenceIndex::bandIndex(const Area &area, float y) const
+{
+	const float height = area.y_max - area.y_min;
+
+	if (height <= 0.f) {
+		return 0;
+	}
+
+	return math::constrain((int)((y - area.y_min) / height * area.band_count), 0, area.band_count - 1);
+}
+
+bool GeofenceIndex::inside(int area, float x, float y) const
+{
+	if (area < 0 || area >= _num_areas) {
+		return false;
+	}
+
+	if (_areas[area].vertex_count == 0) {
+		return insideCircle(_areas[area], x, y);
+	}
+
+	return insidePolygon(_areas[area], x, y);
+}
+
+bool GeofenceIndex::insidePolygon(const Area &area, float x, float y) const
+{
+
+	/* Adaptation of algorithm originally presented as
+	 * PNPOLY - Point Inclusion in Polygon Test
+	 * W. Randolph Franklin (WRF)
+	 * Only supports non-complex polygons (not self intersecting)
+	 *
+	 * Only the edges in the band of the point can be crossed by the test ray.
+	 */
+
+	if (x < area.x_min || x > area.x_max || y < area.y_min || y > area.y_max) {
+		return false;
+	}
+
+	const Vertex *vertices = &_vertices[area.vertex_index];
+	const Band &band = _bands[area.band_index + bandIndex(area, y)];
+	bool c = false;
+
+	for (int k = 0; k < band.num_edges; ++k) {
+		const int i = _band_edges[band.first_edge + k];
+		const int j = (i == 0) ? area.vertex_count - 1 : i - 1;
+
+		if ((vertices[i].y >= y) != (vertices[j].y >= y) &&
+		    (x <= (vertices[j].x - vertices[i].x) * (y - vertices[i].y) / (vertices[j].y - vertices[i].y) + vertices[i].x)) {
+			c = !c;
+		}
+	}
+
+	return c;
+}
+
+bool GeofenceIndex::insideCircle(const Area &area, float x, float y) const
+{
+	const Vertex &center = _vertices[area.vertex_index];
+	const float dx = x - center.x, dy = y - center.y;
+	return dx * dx + dy * dy < area.circle_radius * area.circle_radius;
+}
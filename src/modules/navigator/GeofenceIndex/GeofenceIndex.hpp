@@ -0,0 +1,142 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file GeofenceIndex.hpp
+ *
+ * Polygons and circles of the geofence in a local frame, with a spatial index for the point inclusion test.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class GeofenceIndex
+{
+public:
+	/** vertex in the local frame [m] */
+	struct Vertex {
+		float x;
+		float y;
+	};
+
+	GeofenceIndex() = default;
+	~GeofenceIndex() { clear(); }
+
+	GeofenceIndex(const GeofenceIndex &) = delete;
+	GeofenceIndex &operator=(const GeofenceIndex &) = delete;
+
+	/**
+	 * Free all areas and allocate space for new ones.
+	 * @param max_areas maximum number of polygons and circles
+	 * @param max_vertices maximum number of polygon vertices and circle centers
+	 * @return false if out of memory
+	 */
+	bool allocate(int max_areas, int max_vertices);
+
+	/** free all areas */
+	void clear();
+
+	/**
+	 * Add a vertex, which becomes part of the next polygon or circle.
+	 * @return false if there is no more space
+	 */
+	bool addVertex(float x, float y);
+
+	/**
+	 * Add a polygon made of the last vertex_count vertices added with addVertex() (at most UINT16_MAX).
+	 * @return the area index, or -1 on error
+	 */
+	int addPolygon(int vertex_count);
+
+	/**
+	 * Add a circle around the last vertex added with addVertex().
+	 * @return the area index, or -1 on error
+	 */
+	int addCircle(float radius);
+
+	/**
+	 * Build the index of all areas. Must be called after adding the areas and before inside().
+	 * @return false if out of memory
+	 */
+	bool build();
+
+	/**
+	 * Check if a point in the local frame is within an area (polygon or circle).
+	 * Polygons must not be self intersecting.
+	 */
+	bool inside(int area, float x, float y) const;
+
+	int numAreas() const { return _num_areas; }
+
+	/** number of edge references of the index, for status output */
+	int numBandEdges() const { return _num_band_edges; }
+
+private:
+	struct Area {
+		uint32_t vertex_index; ///< index of the first vertex (or the circle center) in _vertices
+		uint16_t vertex_count; ///< 0 for a circle
+		uint16_t band_count;
+		uint32_t band_index; ///< index of the first band in _bands (polygons only)
+		float circle_radius;
+		float x_min, x_max, y_min, y_max; ///< bounding box [m]
+	};
+
+	/**
+	 * Spatial index of a polygon: its bounding box is split into bands along y, and each band lists the edges that
+	 * overlap it. A point can only be on the edges of its own band in y, so the inside test only looks at these.
+	 */
+	struct Band {
+		uint32_t first_edge; ///< index in _band_edges (edges of all bands of all polygons, can exceed UINT16_MAX)
+		uint32_t num_edges;
+	};
+
+	/** get the band of a polygon for a local y coordinate */
+	int bandIndex(const Area &area, float y) const;
+
+	bool insidePolygon(const Area &area, float x, float y) const;
+	bool insideCircle(const Area &area, float x, float y) const;
+
+	Area *_areas{nullptr};
+	int _num_areas{0};
+	int _max_areas{0};
+
+	Vertex *_vertices{nullptr};
+	int _num_vertices{0};
+	int _max_vertices{0};
+	int _num_used_vertices{0}; ///< vertices that belong to an area
+
+	Band *_bands{nullptr};
+	uint16_t *_band_edges{nullptr}; ///< edge i goes from vertex i-1 to vertex i of the polygon (i < vertex_count)
+	int _num_band_edges{0};
+};
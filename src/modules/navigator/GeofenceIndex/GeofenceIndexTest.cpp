@@ -0,0 +1,239 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <GeofenceIndex.hpp>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+TEST(GeofenceIndexTest, SquareAndCircle)
+{
+	GeofenceIndex index;
+	ASSERT_TRUE(index.allocate(2, 5));
+
+	const float square[4][2] = {{0.f, 0.f}, {10.f, 0.f}, {10.f, 10.f}, {0.f, 10.f}};
+
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_TRUE(index.addVertex(square[i][0], square[i][1]));
+	}
+
+	EXPECT_EQ(index.addPolygon(4), 0);
+	EXPECT_TRUE(index.addVertex(100.f, 0.f));
+	EXPECT_EQ(index.addCircle(5.f), 1);
+	ASSERT_TRUE(index.build());
+
+	EXPECT_TRUE(index.inside(0, 5.f, 5.f));
+	EXPECT_TRUE(index.inside(0, 0.5f, 9.5f));
+	EXPECT_FALSE(index.inside(0, -0.5f, 5.f));
+	EXPECT_FALSE(index.inside(0, 5.f, 10.5f));
+	EXPECT_FALSE(index.inside(0, 100.f, 0.f));
+
+	EXPECT_TRUE(index.inside(1, 100.f, 0.f));
+	EXPECT_TRUE(index.inside(1, 103.f, 3.f));
+	EXPECT_FALSE(index.inside(1, 104.f, 4.f));
+	EXPECT_FALSE(index.inside(1, 5.f, 5.f));
+
+	EXPECT_FALSE(index.inside(2, 5.f, 5.f));
+}
+
+TEST(GeofenceIndexTest, AddErrors)
+{
+	GeofenceIndex index;
+	ASSERT_TRUE(index.allocate(1, 3));
+
+	// vertex count must match the vertices added since the last area
+	EXPECT_TRUE(index.addVertex(0.f, 0.f));
+	EXPECT_TRUE(index.addVertex(1.f, 0.f));
+	EXPECT_EQ(index.addPolygon(3), -1);
+	EXPECT_EQ(index.addCircle(1.f), -1);
+	EXPECT_TRUE(index.addVertex(1.f, 1.f));
+	EXPECT_FALSE(index.addVertex(0.f, 1.f));
+	EXPECT_EQ(index.addPolygon(3), 0);
+
+	// no more space
+	EXPECT_EQ(index.addPolygon(3), -1);
+	EXPECT_EQ(index.numAreas(), 1);
+	EXPECT_TRUE(index.build());
+}
+
+TEST(GeofenceIndexTest, TooManyVertices)
+{
+	// edges are stored as uint16_t per polygon
+	static constexpr int num_vertices = UINT16_MAX + 1;
+
+	GeofenceIndex index;
+	ASSERT_TRUE(index.allocate(1, num_vertices));
+
+	for (int i = 0; i < num_vertices; ++i) {
+		ASSERT_TRUE(index.addVertex((float)i, (float)(i % 2)));
+	}
+
+	EXPECT_EQ(index.addPolygon(num_vertices), -1);
+	EXPECT_TRUE(index.build());
+}
+
+/** PNPOLY over all edges, which is what the band index must match */
+static bool insideAllEdges(const std::vector<GeofenceIndex::Vertex> &vertices, float x, float y)
+{
+	bool c = false;
+
+	for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++) {
+		if ((vertices[i].y >= y) != (vertices[j].y >= y) &&
+		    (x <= (vertices[j].x - vertices[i].x) * (y - vertices[i].y) / (vertices[j].y - vertices[i].y) + vertices[i].x)) {
+			c = !c;
+		}
+	}
+
+	return c;
+}
+
+TEST(GeofenceIndexTest, MatchesAllEdges)
+{
+	// star shaped polygons with 300 vertices each on a 6 x 4 grid, 3 km apart
+	static constexpr int num_polygons = 24;
+	static constexpr int num_vertices = 300;
+	static constexpr int num_points = 20000;
+
+	srand(1);
+
+	GeofenceIndex index;
+	ASSERT_TRUE(index.allocate(num_polygons, num_polygons * num_vertices));
+	std::vector<std::vector<GeofenceIndex::Vertex>> polygons(num_polygons);
+
+	for (int p = 0; p < num_polygons; ++p) {
+		const float center_x = (p % 6) * 3000.f;
+		const float center_y = (p / 6) * 3000.f;
+
+		for (int i = 0; i < num_vertices; ++i) {
+			const float angle = 2.f * (float)M_PI * i / num_vertices;
+			const float radius = 800.f + 600.f * (rand() % 1000) / 1000.f;
+			const GeofenceIndex::Vertex vertex{center_x + radius * cosf(angle), center_y + radius * sinf(angle)};
+			polygons[p].push_back(vertex);
+			ASSERT_TRUE(index.addVertex(vertex.x, vertex.y));
+		}
+
+		ASSERT_EQ(index.addPolygon(num_vertices), p);
+	}
+
+	ASSERT_TRUE(index.build());
+
+	std::vector<GeofenceIndex::Vertex> points(num_points);
+
+	for (auto &point : points) {
+		point.x = -2000.f + (rand() % 2000000) / 100.f;
+		point.y = -2000.f + (rand() % 1400000) / 100.f;
+	}
+
+	int mismatches = 0;
+	int inside_count = 0;
+
+	for (const auto &point : points) {
+		for (int p = 0; p < num_polygons; ++p) {
+			const bool inside = index.inside(p, point.x, point.y);
+			mismatches += inside != insideAllEdges(polygons[p], point.x, point.y);
+			inside_count += inside;
+		}
+	}
+
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_GT(inside_count, 0);
+
+	// benchmark: time per check of a point against all polygons
+	volatile int count = 0;
+	const auto t0 = std::chrono::steady_clock::now();
+
+	for (const auto &point : points) {
+		for (int p = 0; p < num_polygons; ++p) {
+			count = count + insideAllEdges(polygons[p], point.x, point.y);
+		}
+	}
+
+	const auto t1 = std::chrono::steady_clock::now();
+
+	for (const auto &point : points) {
+		for (int p = 0; p < num_polygons; ++p) {
+			count = count + index.inside(p, point.x, point.y);
+		}
+	}
+
+	const auto t2 = std::chrono::steady_clock::now();
+
+	printf("%i polygons x %i vertices, %i edge references: %.2f us per check over all edges, %.2f us with the index\n",
+	       num_polygons, num_vertices, index.numBandEdges(),
+	       std::chrono::duration<double, std::micro>(t1 - t0).count() / num_points,
+	       std::chrono::duration<double, std::micro>(t2 - t1).count() / num_points);
+}
+
+TEST(GeofenceIndexTest, MoreThan65535EdgeReferences)
+{
+	// sawtooth polygons: every edge spans the full height, so it is referenced by all bands of its polygon
+	static constexpr int num_polygons = 2;
+	static constexpr int num_vertices = 1200;
+	static constexpr int num_points = 2000;
+
+	srand(2);
+
+	GeofenceIndex index;
+	ASSERT_TRUE(index.allocate(num_polygons, num_polygons * num_vertices));
+	std::vector<std::vector<GeofenceIndex::Vertex>> polygons(num_polygons);
+
+	for (int p = 0; p < num_polygons; ++p) {
+		for (int i = 0; i < num_vertices; ++i) {
+			const GeofenceIndex::Vertex vertex{(float)i, (float)(p * 200 + ((i % 2) ? 100 : 0))};
+			polygons[p].push_back(vertex);
+			ASSERT_TRUE(index.addVertex(vertex.x, vertex.y));
+		}
+
+		ASSERT_EQ(index.addPolygon(num_vertices), p);
+	}
+
+	ASSERT_TRUE(index.build());
+	EXPECT_GT(index.numBandEdges(), UINT16_MAX);
+
+	int mismatches = 0;
+
+	for (int k = 0; k < num_points; ++k) {
+		const float x = (rand() % (num_vertices * 100)) / 100.f;
+		const float y = (rand() % 30000) / 100.f;
+
+		for (int p = 0; p < num_polygons; ++p) {
+			mismatches += index.inside(p, x, y) != insideAllEdges(polygons[p], x, y);
+		}
+	}
+
+	EXPECT_EQ(mismatches, 0);
+}
@@ -63,9 +63,16 @@ Geofence::Geofence(Navigator *navigator) :
 
 Geofence::~Geofence()
 {
-	if (_polygons) {
-		delete[](_polygons);
-	}
+	clearFence();
+}
+
+void Geofence::clearFence()
+{
+	delete[](_polygons);
+	_polygons = nullptr;
+	_num_polygons = 0;
+
+	_index.clear();
 }
 
 void Geofence::updateFence()
@@ -96,20 +103,37 @@ void Geofence::_updateFence()
 		_update_counter = stats.update_counter;
 	}
 
-	// iterate over all polygons and store their starting vertices
-	_num_polygons = 0;
+	clearFence();
+
+	if (num_fence_items <= 0) {
+		return;
+	}
+
+	// read all fence items with a single request. Each item is at most one polygon and one vertex.
+	mission_fence_point_s *fence_items = new mission_fence_point_s[num_fence_items];
+	_polygons = new PolygonInfo[num_fence_items];
+
+	if (!fence_items || !_polygons || !_index.allocate(num_fence_items, num_fence_items)) {
+		delete[](fence_items);
+		clearFence();
+		PX4_ERR("alloc failed");
+		return;
+	}
+
+	ret = dm_read_range(DM_KEY_FENCE_POINTS, 1, fence_items, sizeof(mission_fence_point_s), num_fence_items);
+
+	if (ret < num_fence_items) {
+		PX4_ERR("dm_read failed");
+		num_fence_items = ret > 0 ? ret : 0;
+	}
+
+	// iterate over all polygons and store their vertices in the local frame
 	int current_seq = 1;
 
 	while (current_seq <= num_fence_items) {
-		mission_fence_point_s mission_fence_point;
+		const mission_fence_point_s &mission_fence_point = fence_items[current_seq - 1];
 		bool is_circle_area = false;
 
-		if (dm_read(DM_KEY_FENCE_POINTS, current_seq, &mission_fence_point, sizeof(mission_fence_point_s)) !=
-		    sizeof(mission_fence_point_s)) {
-			PX4_ERR("dm_read failed");
-			break;
-		}
-
 		switch (mission_fence_point.nav_cmd) {
 		case NAV_CMD_FENCE_RETURN_POINT:
 			// TODO: do we need to store this?
@@ -127,38 +151,47 @@ void Geofence::_updateFence()
 				++current_seq; // avoid endless loop
 				PX4_ERR("Polygon with 0 vertices. Skipping");
 
-			} else {
-				if (_polygons) {
-					// resize: this is somewhat inefficient, but we do not expect there to be many polygons
-					PolygonInfo *new_polygons = new PolygonInfo[_num_polygons + 1];
+			} else if (!is_circle_area && current_seq + mission_fence_point.vertex_count - 1 > num_fence_items) {
+				current_seq = num_fence_items + 1;
+				PX4_ERR("Incomplete polygon. Skipping");
 
-					if (new_polygons) {
-						memcpy(new_polygons, _polygons, sizeof(PolygonInfo) * _num_polygons);
-					}
-
-					delete[](_polygons);
-					_polygons = new_polygons;
-
-				} else {
-					_polygons = new PolygonInfo[1];
-				}
-
-				if (!_polygons) {
-					_num_polygons = 0;
-					PX4_ERR("alloc failed");
-					return;
+			} else {
+				// the first vertex is the reference of the local frame
+				if (_num_polygons == 0) {
+					map_projection_init(&_projection_reference, mission_fence_point.lat, mission_fence_point.lon);
 				}
 
 				PolygonInfo &polygon = _polygons[_num_polygons];
 				polygon.dataman_index = current_seq;
 				polygon.fence_type = mission_fence_point.nav_cmd;
+				polygon.frame_supported = true;
+
+				const int polygon_vertex_count = is_circle_area ? 1 : mission_fence_point.vertex_count;
+
+				for (int i = 0; i < polygon_vertex_count; ++i) {
+					const mission_fence_point_s &vertex = fence_items[current_seq - 1 + i];
+
+					if (vertex.frame != NAV_FRAME_GLOBAL && vertex.frame != NAV_FRAME_GLOBAL_INT
+					    && vertex.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
+					    && vertex.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
+						// TODO: handle different frames
+						PX4_ERR("Frame type %i not supported", (int)vertex.frame);
+						polygon.frame_supported = false;
+					}
+
+					float x, y;
+					map_projection_project(&_projection_reference, vertex.lat, vertex.lon, &x, &y);
+					_index.addVertex(x, y);
+				}
 
 				if (is_circle_area) {
 					polygon.circle_radius = mission_fence_point.circle_radius;
+					_index.addCircle(mission_fence_point.circle_radius);
 					current_seq += 1;
 
 				} else {
 					polygon.vertex_count = mission_fence_point.vertex_count;
+					_index.addPolygon(mission_fence_point.vertex_count);
 					current_seq += mission_fence_point.vertex_count;
 				}
 
@@ -175,6 +208,12 @@ void Geofence::_updateFence()
 
 	}
 
+	delete[](fence_items);
+
+	if (!_index.build()) {
+		clearFence();
+		PX4_ERR("alloc failed");
+	}
 }
 
 bool Geofence::checkAll(const struct vehicle_global_position_s &global_position)
@@ -280,7 +319,7 @@ bool Geofence::checkAll(double lat, double lon, float altitude)
 
 bool Geofence::checkPolygons(double lat, double lon, float altitude)
 {
-	// the following uses dm_read, so first we try to lock all items. If that fails, it (most likely) means
+	// the fence is updated from dataman, so first we try to lock all items. If that fails, it (most likely) means
 	// the data is currently being updated (via a mavlink geofence transfer), and we do not check for a violation now
 	if (dm_trylock(DM_KEY_FENCE_POINTS) != 0) {
 		return true;
@@ -294,8 +333,9 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 		_updateFence();
 	}
 
+	dm_unlock(DM_KEY_FENCE_POINTS);
+
 	if (isEmpty()) {
-		dm_unlock(DM_KEY_FENCE_POINTS);
 		/* Empty fence -> accept all points */
 		return true;
 	}
@@ -303,11 +343,12 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 	/* Vertical check */
 	if (_altitude_max > _altitude_min) { // only enable vertical check if configured properly
 		if (altitude > _altitude_max || altitude < _altitude_min) {
-			dm_unlock(DM_KEY_FENCE_POINTS);
 			return false;
 		}
 	}
 
+	float x, y;
+	map_projection_project(&_projection_reference, lat, lon, &x, &y);
 
 	/* Horizontal check: iterate all polygons & circles */
 	bool outside_exclusion = true;
@@ -316,7 +357,7 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 
 	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
 		if (_polygons[polygon_idx].fence_type == NAV_CMD_FENCE_CIRCLE_INCLUSION) {
-			bool inside = insideCircle(_polygons[polygon_idx], lat, lon, altitude);
+			bool inside = insideArea(polygon_idx, x, y);
 
 			if (inside) {
 				inside_inclusion = true;
@@ -325,14 +366,14 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 			had_inclusion_areas = true;
 
 		} else if (_polygons[polygon_idx].fence_type == NAV_CMD_FENCE_CIRCLE_EXCLUSION) {
-			bool inside = insideCircle(_polygons[polygon_idx], lat, lon, altitude);
+			bool inside = insideArea(polygon_idx, x, y);
 
 			if (inside) {
 				outside_exclusion = false;
 			}
 
 		} else { // it's a polygon
-			bool inside = insidePolygon(_polygons[polygon_idx], lat, lon, altitude);
+			bool inside = insideArea(polygon_idx, x, y);
 
 			if (_polygons[polygon_idx].fence_type == NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION) {
 				if (inside) {
@@ -349,81 +390,12 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 		}
 	}
 
-	dm_unlock(DM_KEY_FENCE_POINTS);
-
 	return (!had_inclusion_areas || inside_inclusion) && outside_exclusion;
 }
 
-bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon, float altitude)
-{
-
-	/* Adaptation of algorithm originally presented as
-	 * PNPOLY - Point Inclusion in Polygon Test
-	 * W. Randolph Franklin (WRF)
-	 * Only supports non-complex polygons (not self intersecting)
-	 */
-
-	mission_fence_point_s temp_vertex_i;
-	mission_fence_point_s temp_vertex_j;
-	bool c = false;
-
-	for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + i, &temp_vertex_i,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
-
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + j, &temp_vertex_j,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
-
-		if (temp_vertex_i.frame != NAV_FRAME_GLOBAL && temp_vertex_i.frame != NAV_FRAME_GLOBAL_INT
-		    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
-		    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-			// TODO: handle different frames
-			PX4_ERR("Frame type %i not supported", (int)temp_vertex_i.frame);
-			break;
-		}
-
-		if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
-		    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
-		     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
-			c = !c;
-		}
-	}
-
-	return c;
-}
-
-bool Geofence::insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude)
+bool Geofence::insideArea(int polygon_idx, float x, float y) const
 {
-
-	mission_fence_point_s circle_point;
-
-	if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index, &circle_point,
-		    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-		PX4_ERR("dm_read failed");
-		return false;
-	}
-
-	if (circle_point.frame != NAV_FRAME_GLOBAL && circle_point.frame != NAV_FRAME_GLOBAL_INT
-	    && circle_point.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
-	    && circle_point.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-		// TODO: handle different frames
-		PX4_ERR("Frame type %i not supported", (int)circle_point.frame);
-		return false;
-	}
-
-	if (!map_projection_initialized(&_projection_reference)) {
-		map_projection_init(&_projection_reference, lat, lon);
-	}
-
-	float x1, y1, x2, y2;
-	map_projection_project(&_projection_reference, lat, lon, &x1, &y1);
-	map_projection_project(&_projection_reference, circle_point.lat, circle_point.lon, &x2, &y2);
-	float dx = x1 - x2, dy = y1 - y2;
-	return dx * dx + dy * dy < circle_point.circle_radius * circle_point.circle_radius;
+	return _polygons[polygon_idx].frame_supported && _index.inside(polygon_idx, x, y);
 }
 
 bool
@@ -603,4 +575,5 @@ void Geofence::printStatus()
 	PX4_INFO("Geofence: %i inclusion, %i exclusion polygons, %i inclusion, %i exclusion circles, %i total vertices",
 		 num_inclusion_polygons, num_exclusion_polygons, num_inclusion_circles, num_exclusion_circles,
 		 total_num_vertices);
+	PX4_INFO("Geofence index: %i edge references", _index.numBandEdges());
 }
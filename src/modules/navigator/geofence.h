@@ -52,6 +52,8 @@
 #include <uORB/topics/vehicle_gps_position.h>
 #include <uORB/topics/vehicle_air_data.h>
 
+#include <GeofenceIndex.hpp>
+
 #define GEOFENCE_FILENAME PX4_STORAGEDIR"/etc/geofence.txt"
 
 class Navigator;
@@ -151,10 +153,13 @@ private:
 			uint16_t vertex_count;
 			float circle_radius;
 		};
+		bool frame_supported;
 	};
 	PolygonInfo *_polygons{nullptr};
 	int _num_polygons{0};
 
+	GeofenceIndex _index; ///< geometry of all polygons and circles in the local frame, same order as _polygons
+
 	map_projection_reference_s _projection_reference = {}; ///< reference to convert (lon, lat) to local [m]
 
 	DEFINE_PARAMETERS(
@@ -172,10 +177,14 @@ private:
 	uint16_t _update_counter{0}; ///< dataman update counter: if it does not match, we polygon data was updated
 
 	/**
-	 * implementation of updateFence(), but without locking
+	 * implementation of updateFence(), but without locking.
+	 * Loads all fence items into RAM and builds the index.
 	 */
 	void _updateFence();
 
+	/** free the fence data */
+	void clearFence();
+
 	/**
 	 * Check if a point passes the Geofence test.
 	 * This takes all polygons and minimum & maximum altitude into account
@@ -200,15 +209,8 @@ private:
 	bool checkAll(const vehicle_global_position_s &global_position, float baro_altitude_amsl);
 
 	/**
-	 * Check if a single point is within a polygon
-	 * @return true if within polygon
-	 */
-	bool insidePolygon(const PolygonInfo &polygon, double lat, double lon, float altitude);
-
-	/**
-	 * Check if a single point is within a circle
-	 * @param polygon must be a circle!
-	 * @return true if within polygon the circle
+	 * Check if a single point (in the local frame) is within a polygon or circle
+	 * @return true if within the polygon or circle
 	 */
-	bool insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude);
+	bool insideArea(int polygon_idx, float x, float y) const;
 };
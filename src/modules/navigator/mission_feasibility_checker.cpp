@@ -61,6 +61,9 @@ MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission,
 	bool failed = false;
 	bool warned = false;
 
+	// the mission items are read again from dataman
+	_items_count = 0;
+
 	// first check if we have a valid position
 	const bool home_valid = _navigator->home_position_valid();
 	const bool home_alt_valid = _navigator->home_alt_valid();
@@ -94,6 +97,27 @@ MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission,
 	return !failed;
 }
 
+bool
+MissionFeasibilityChecker::readMissionItem(const mission_s &mission, size_t index, mission_item_s &mission_item)
+{
+	if (_items_count == 0 || index < _items_first_index || index >= _items_first_index + _items_count) {
+		// read the next block of items in one dataman request
+		const size_t count = math::min(mission.count - index, ITEMS_BLOCK_SIZE);
+		const ssize_t ret = dm_read_range((dm_item_t)mission.dataman_id, index, _items, sizeof(mission_item_s), count);
+
+		if (ret <= 0) {
+			_items_count = 0;
+			return false;
+		}
+
+		_items_first_index = index;
+		_items_count = ret;
+	}
+
+	mission_item = _items[index - _items_first_index];
+	return true;
+}
+
 bool
 MissionFeasibilityChecker::checkRotarywing(const mission_s &mission, float home_alt)
 {
@@ -127,9 +151,8 @@ MissionFeasibilityChecker::checkGeofence(const mission_s &mission, float home_al
 	if (_navigator->get_geofence().valid()) {
 		for (size_t i = 0; i < mission.count; i++) {
 			struct mission_item_s missionitem = {};
-			const ssize_t len = sizeof(missionitem);
 
-			if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
+			if (!readMissionItem(mission, i, missionitem)) {
 				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 				return false;
 			}
@@ -160,9 +183,8 @@ MissionFeasibilityChecker::checkHomePositionAltitude(const mission_s &mission, f
 	/* Check if all waypoints are above the home altitude */
 	for (size_t i = 0; i < mission.count; i++) {
 		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
+		if (!readMissionItem(mission, i, missionitem)) {
 			_navigator->get_mission_result()->warning = true;
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			return false;
@@ -210,9 +232,8 @@ MissionFeasibilityChecker::checkMissionItemValidity(const mission_s &mission)
 	// do not allow mission if we find unsupported item
 	for (size_t i = 0; i < mission.count; i++) {
 		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(struct mission_item_s);
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
+		if (!readMissionItem(mission, i, missionitem)) {
 			// not supposed to happen unless the datamanager can't access the SD card, etc.
 			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
 			return false;
@@ -295,9 +316,8 @@ MissionFeasibilityChecker::checkTakeoff(const mission_s &mission, float home_alt
 
 	for (size_t i = 0; i < mission.count; i++) {
 		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
+		if (!readMissionItem(mission, i, missionitem)) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			return false;
 		}
@@ -345,9 +365,8 @@ MissionFeasibilityChecker::checkTakeoff(const mission_s &mission, float home_alt
 		// one of the bellow mission items
 		for (size_t i = 0; i < (size_t)takeoff_index; i++) {
 			struct mission_item_s missionitem = {};
-			const ssize_t len = sizeof(struct mission_item_s);
 
-			if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
+			if (!readMissionItem(mission, i, missionitem)) {
 				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 				return false;
 			}
@@ -419,9 +438,8 @@ MissionFeasibilityChecker::checkFixedWingLanding(const mission_s &mission, bool
 
 	for (size_t i = 0; i < mission.count; i++) {
 		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(missionitem);
 
-		if (dm_read((dm_item_t)mission.dataman_id, i, &missionitem, len) != len) {
+		if (!readMissionItem(mission, i, missionitem)) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			return false;
 		}
@@ -444,7 +462,7 @@ MissionFeasibilityChecker::checkFixedWingLanding(const mission_s &mission, bool
 			if (i > 0) {
 				landing_approach_index = i - 1;
 
-				if (dm_read((dm_item_t)mission.dataman_id, landing_approach_index, &missionitem_previous, len) != len) {
+				if (!readMissionItem(mission, landing_approach_index, missionitem_previous)) {
 					/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 					return false;
 				}
@@ -537,7 +555,7 @@ MissionFeasibilityChecker::checkDistanceToFirstWaypoint(const mission_s &mission
 
 		struct mission_item_s mission_item {};
 
-		if (!(dm_read((dm_item_t)mission.dataman_id, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
+		if (!readMissionItem(mission, i, mission_item)) {
 			/* error reading, mission is invalid */
 			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
 			return false;
@@ -588,7 +606,7 @@ MissionFeasibilityChecker::checkDistancesBetweenWaypoints(const mission_s &missi
 
 		struct mission_item_s mission_item {};
 
-		if (!(dm_read((dm_item_t)mission.dataman_id, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
+		if (!readMissionItem(mission, i, mission_item)) {
 			/* error reading, mission is invalid */
 			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
 			return false;
@@ -53,6 +53,14 @@ class MissionFeasibilityChecker
 private:
 	Navigator *_navigator{nullptr};
 
+	/* Block of mission items, read from dataman with a single request */
+	static constexpr size_t ITEMS_BLOCK_SIZE = 16;
+	mission_item_s _items[ITEMS_BLOCK_SIZE];
+	size_t _items_first_index{0};
+	size_t _items_count{0};
+
+	bool readMissionItem(const mission_s &mission, size_t index, mission_item_s &mission_item);
+
 	/* Checks for all airframes */
 	bool checkGeofence(const mission_s &mission, float home_alt, bool home_valid);
 
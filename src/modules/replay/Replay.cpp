@@ -47,6 +47,7 @@
 #include <px4_time.h>
 #include <px4_shutdown.h>
 
+#include <algorithm>
 #include <cstring>
 #include <float.h>
 #include <fstream>
@@ -59,9 +60,11 @@
 #include <string>
 
 #include <logger/messages.h>
+#include <logger/data_delta.h>
 
 #include "Replay.hpp"
 #include "ReplayEkf2.hpp"
+#include "ULogScan.hpp"
 
 #define PARAMS_OVERRIDE_FILE PX4_ROOTFSDIR "/replay_params.txt"
 
@@ -166,7 +169,7 @@ Replay::setUserParams(const char *filename)
 }
 
 bool
-Replay::readFileHeader(std::ifstream &file)
+Replay::readFileHeader(ULogFile &file)
 {
 	file.seekg(0);
 	ulog_file_header_s msg_header;
@@ -190,7 +193,7 @@ Replay::readFileHeader(std::ifstream &file)
 }
 
 bool
-Replay::readFileDefinitions(std::ifstream &file)
+Replay::readFileDefinitions(ULogFile &file)
 {
 	PX4_INFO("Applying params from ULog file...");
 
@@ -247,7 +250,7 @@ Replay::readFileDefinitions(std::ifstream &file)
 }
 
 bool
-Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
+Replay::readFlagBits(ULogFile &file, uint16_t msg_size)
 {
 	if (msg_size != 40) {
 		PX4_ERR("unsupported message length for FLAG_BITS message (%i)", msg_size);
@@ -264,7 +267,7 @@ Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
 	bool contains_appended_data = incompat_flags[0] & ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK;
 	bool has_unknown_incompat_bits = false;
 
-	if (incompat_flags[0] & ~0x1) {
+	if (incompat_flags[0] & ~(ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK | ULOG_INCOMPAT_FLAG0_DATA_DELTA_MASK)) {
 		has_unknown_incompat_bits = true;
 	}
 
@@ -294,7 +297,201 @@ Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::readFormat(std::ifstream &file, uint16_t msg_size)
+Replay::readIndex(ULogFile &file)
+{
+	_index_time.clear();
+	_index_first_data.clear();
+	_index_additional.clear();
+	_index_has_additional = false;
+
+	// the footer is the last message, before any appended data
+	file.seekg(0, ios::end);
+	int64_t end_position = (int64_t)file.tellg();
+
+	if (end_position > _read_until_file_position) {
+		end_position = _read_until_file_position;
+	}
+
+	const int64_t index_end = end_position - ULOG_INDEX_FOOTER_SIZE;
+
+	if (index_end <= (int64_t)_data_section_start) {
+		return false;
+	}
+
+	uint8_t footer[ULOG_INDEX_FOOTER_SIZE];
+	file.seekg(index_end);
+	file.read((char *)footer, sizeof(footer));
+
+	if (!file) {
+		file.clear();
+		return false;
+	}
+
+	const size_t key_len = sizeof(ULOG_INDEX_KEY) - 1;
+	ulog_message_header_s message_header;
+	memcpy(&message_header, footer, ULOG_MSG_HEADER_LEN);
+
+	if (message_header.msg_type != (int)ULogMessageType::INFO
+	    || message_header.msg_size != ULOG_INDEX_FOOTER_SIZE - ULOG_MSG_HEADER_LEN
+	    || footer[ULOG_MSG_HEADER_LEN] != key_len || memcmp(footer + ULOG_MSG_HEADER_LEN + 1, ULOG_INDEX_KEY, key_len) != 0) {
+		return false; // no index
+	}
+
+	uint64_t index_offset;
+	memcpy(&index_offset, footer + ULOG_MSG_HEADER_LEN + 1 + key_len, sizeof(index_offset));
+
+	if (index_offset <= (uint64_t)(streamoff)_data_section_start || index_offset >= (uint64_t)index_end) {
+		PX4_WARN("Invalid log index offset, ignoring the index");
+		return false;
+	}
+
+	// read the index messages: INFO_MULTIPLE with uint64_t arrays
+	std::vector<uint64_t> time_values;
+	std::vector<uint64_t> data_values;
+	std::vector<uint64_t> additional_values;
+	bool has_additional = false;
+	std::vector<uint8_t> message;
+	file.seekg(index_offset);
+
+	while ((int64_t)file.tellg() < index_end) {
+		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+
+		if (!file || message_header.msg_type != (int)ULogMessageType::INFO_MULTIPLE || message_header.msg_size < 2) {
+			break;
+		}
+
+		message.resize(message_header.msg_size);
+		file.read((char *)message.data(), message_header.msg_size);
+
+		const size_t msg_key_len = message[1];
+
+		if (!file || 2 + msg_key_len > message_header.msg_size) {
+			break;
+		}
+
+		const string key((char *)message.data() + 2, msg_key_len);
+		const size_t values_size = message_header.msg_size - 2 - msg_key_len;
+		std::vector<uint64_t> *values = nullptr;
+
+		if (key.compare(0, 9, "uint64_t[") == 0 && values_size % sizeof(uint64_t) == 0) {
+			const string name = key.substr(key.find(' ') + 1);
+
+			if (name == ULOG_INDEX_TIME_KEY) {
+				values = &time_values;
+
+			} else if (name == ULOG_INDEX_DATA_KEY) {
+				values = &data_values;
+
+			} else if (name == ULOG_INDEX_ADDITIONAL_KEY) {
+				values = &additional_values;
+				has_additional = true;
+			}
+		}
+
+		if (!values) {
+			break;
+		}
+
+		const size_t num_values = values_size / sizeof(uint64_t);
+		values->resize(values->size() + num_values);
+		memcpy(values->data() + values->size() - num_values, message.data() + 2 + msg_key_len, values_size);
+	}
+
+	if (!file || (int64_t)file.tellg() != index_end || time_values.size() % 2 != 0 || data_values.size() % 2 != 0) {
+		file.clear();
+		PX4_WARN("Invalid log index, ignoring it");
+		return false;
+	}
+
+	for (size_t i = 0; i < time_values.size(); i += 2) {
+		if (time_values[i + 1] >= index_offset || (i > 0 && time_values[i] < _index_time.back().first)) {
+			PX4_WARN("Invalid log index entry, ignoring the index");
+			_index_time.clear();
+			return false;
+		}
+
+		_index_time.emplace_back(time_values[i], time_values[i + 1]);
+	}
+
+	for (size_t i = 0; i < data_values.size(); i += 2) {
+		const uint64_t msg_id = data_values[i];
+
+		if (msg_id > UINT16_MAX || data_values[i + 1] >= index_offset) {
+			continue;
+		}
+
+		if (_index_first_data.size() <= msg_id) {
+			_index_first_data.resize(msg_id + 1, 0);
+		}
+
+		_index_first_data[msg_id] = data_values[i + 1];
+	}
+
+	_index_has_additional = has_additional;
+
+	for (size_t i = 0; i < additional_values.size() && _index_has_additional; ++i) {
+		if (additional_values[i] < (uint64_t)(streamoff)_data_section_start || additional_values[i] >= index_offset
+		    || (i > 0 && additional_values[i] < additional_values[i - 1])) {
+			PX4_WARN("Invalid log index parameter entry, parsing the whole file for parameter changes");
+			_index_has_additional = false;
+		}
+	}
+
+	if (_index_has_additional) {
+		_index_additional = std::move(additional_values);
+	}
+
+	return true;
+}
+
+void
+Replay::seekToTime(ULogFile &file, uint64_t timestamp)
+{
+	// find the last index entry before the timestamp
+	auto entry = std::upper_bound(_index_time.begin(), _index_time.end(), timestamp,
+	[](uint64_t t, const std::pair<uint64_t, uint64_t> &e) { return t < e.first; });
+
+	if (entry == _index_time.begin()) {
+		return;
+	}
+
+	--entry;
+	const streamoff offset = (streamoff)entry->second;
+
+	// topics subscribed during logging before the offset: the subscriptions only find them when reading past them
+	std::vector<streampos> add_logged_messages;
+	ulog_find_add_logged_messages(file, _data_section_start, offset, _index_has_additional ? &_index_additional : nullptr,
+				      add_logged_messages);
+
+	for (const streampos &position : add_logged_messages) {
+		ulog_message_header_s message_header;
+		file.clear();
+		file.seekg(position);
+
+		if (!file.read((char *)&message_header, ULOG_MSG_HEADER_LEN)
+		    || !readAndAddSubscription(file, message_header.msg_size)) {
+			PX4_ERR("Failed to read subscription");
+			break;
+		}
+	}
+
+	file.clear();
+
+	for (size_t i = 0; i < _subscriptions.size(); ++i) {
+		Subscription *subscription = _subscriptions[i];
+
+		if (!subscription || !subscription->orb_meta || (streamoff)subscription->next_read_pos >= offset) {
+			continue;
+		}
+
+		subscription->next_read_pos = offset;
+		subscription->next_data_valid = false;
+		nextDataMessage(file, *subscription, i, false);
+	}
+}
+
+bool
+Replay::readFormat(ULogFile &file, uint16_t msg_size)
 {
 	_read_buffer.reserve(msg_size + 1);
 	char *format = (char *)_read_buffer.data();
@@ -320,7 +517,7 @@ Replay::readFormat(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::readAndAddSubscription(std::ifstream &file, uint16_t msg_size)
+Replay::readAndAddSubscription(ULogFile &file, uint16_t msg_size)
 {
 	_read_buffer.reserve(msg_size + 1);
 	char *message = (char *)_read_buffer.data();
@@ -332,12 +529,10 @@ Replay::readAndAddSubscription(std::ifstream &file, uint16_t msg_size)
 		return false;
 	}
 
-	if (file.tellg() <= _subscription_file_pos) { //already read this subscription
+	if (!_added_subscriptions.insert((streamoff)this_message_pos).second) { //already read this subscription
 		return true;
 	}
 
-	_subscription_file_pos = file.tellg();
-
 	uint8_t multi_id = *(uint8_t *)message;
 	uint16_t msg_id = ((uint16_t) message[1]) | (((uint16_t) message[2]) << 8);
 	string topic_name(message + 3);
@@ -410,8 +605,15 @@ Replay::readAndAddSubscription(std::ifstream &file, uint16_t msg_size)
 	//find first data message (and the timestamp)
 	streampos cur_pos = file.tellg();
 	subscription->next_read_pos = this_message_pos; //this will be skipped
+	bool skip_first = true;
+
+	if (msg_id < _index_first_data.size() && _index_first_data[msg_id] > (uint64_t)(streamoff)this_message_pos) {
+		// the index knows where it is, no need to search for it
+		subscription->next_read_pos = _index_first_data[msg_id];
+		skip_first = false;
+	}
 
-	if (!nextDataMessage(file, *subscription, msg_id)) {
+	if (!nextDataMessage(file, *subscription, msg_id, skip_first)) {
 		return false;
 	}
 
@@ -468,7 +670,37 @@ Replay::findFieldOffset(const string &format, const string &field_name, int &off
 }
 
 bool
-Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_position)
+Replay::readAndHandleAdditionalMessages(ULogFile &file, std::streampos end_position)
+{
+	if (!_index_has_additional) {
+		return handleAdditionalMessages(file, end_position, false);
+	}
+
+	// jump to the messages listed in the index, instead of parsing everything in between
+	const streampos start_position = file.tellg();
+	auto entry = std::lower_bound(_index_additional.begin(), _index_additional.end(), (uint64_t)(streamoff)start_position);
+	streampos handled_position = start_position;
+
+	for (; entry != _index_additional.end() && (streamoff)*entry < (streamoff)end_position; ++entry) {
+		if ((streamoff)*entry < (streamoff)handled_position) {
+			continue; // already handled together with the previous entry
+		}
+
+		file.seekg(*entry);
+
+		if (!handleAdditionalMessages(file, end_position, true)) {
+			return false;
+		}
+
+		handled_position = file.tellg();
+	}
+
+	file.seekg(end_position);
+	return true;
+}
+
+bool
+Replay::handleAdditionalMessages(ULogFile &file, std::streampos end_position, bool stop_at_other)
 {
 	ulog_message_header_s message_header;
 
@@ -491,7 +723,15 @@ Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_
 			readDropout(file, message_header.msg_size);
 			break;
 
+		case (int)ULogMessageType::ADD_LOGGED_MSG: // listed in the index, but already added by the subscriptions
+			file.seekg(message_header.msg_size, ios::cur);
+			break;
+
 		default: //skip all others
+			if (stop_at_other) {
+				return true;
+			}
+
 			file.seekg(message_header.msg_size, ios::cur);
 			break;
 		}
@@ -501,7 +741,7 @@ Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_
 }
 
 bool
-Replay::readAndApplyParameter(std::ifstream &file, uint16_t msg_size)
+Replay::readAndApplyParameter(ULogFile &file, uint16_t msg_size)
 {
 	_read_buffer.reserve(msg_size);
 	uint8_t *message = (uint8_t *)_read_buffer.data();
@@ -543,7 +783,7 @@ Replay::readAndApplyParameter(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::readDropout(std::ifstream &file, uint16_t msg_size)
+Replay::readDropout(ULogFile &file, uint16_t msg_size)
 {
 	uint16_t duration;
 	file.read((char *)&duration, sizeof(duration));
@@ -553,15 +793,18 @@ Replay::readDropout(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, int msg_id)
+Replay::nextDataMessage(ULogFile &file, Subscription &subscription, int msg_id, bool skip_first)
 {
 	ulog_message_header_s message_header;
 	file.seekg(subscription.next_read_pos);
-	//ignore the first message (it's data we already read)
-	file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
 
-	if (file) {
-		file.seekg(message_header.msg_size, ios::cur);
+	if (skip_first) {
+		//ignore the first message (it's data we already read)
+		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+
+		if (file) {
+			file.seekg(message_header.msg_size, ios::cur);
+		}
 	}
 
 	uint16_t file_msg_id;
@@ -586,21 +829,16 @@ Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, int msg
 			break;
 
 		case (int)ULogMessageType::DATA:
+		case (int)ULogMessageType::DATA_DELTA:
 			file.read((char *)&file_msg_id, sizeof(file_msg_id));
 
 			if (file) {
 				if (msg_id == file_msg_id) {
-					if (message_header.msg_size == subscription.orb_meta->o_size_no_padding + 2) {
+					if (readDataMessage(file, subscription, message_header)) {
 						subscription.next_read_pos = cur_pos;
-						file.seekg(subscription.timestamp_offset, ios::cur);
-						file.read((char *)&subscription.next_timestamp, sizeof(subscription.next_timestamp));
+						memcpy(&subscription.next_timestamp, subscription.next_data + subscription.timestamp_offset,
+						       sizeof(subscription.next_timestamp));
 						done = true;
-
-					} else { //sanity check failed!
-						PX4_ERR("data message %s has wrong size %i (expected %i). Skipping",
-							subscription.orb_meta->o_name, message_header.msg_size,
-							subscription.orb_meta->o_size_no_padding + 2);
-						file.seekg(message_header.msg_size - sizeof(file_msg_id), ios::cur);
 					}
 
 				} else { //not the one we are looking for
@@ -637,6 +875,55 @@ Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, int msg
 	return file.good();
 }
 
+bool
+Replay::readDataMessage(ULogFile &file, Subscription &subscription, const ulog_message_header_s &message_header)
+{
+	const size_t data_size = subscription.orb_meta->o_size_no_padding;
+	const size_t payload_size = message_header.msg_size - sizeof(uint16_t); // without msg_id
+
+	if (message_header.msg_type == (int)ULogMessageType::DATA) {
+		if (payload_size != data_size) { //sanity check failed!
+			PX4_ERR("data message %s has wrong size %i (expected %i). Skipping",
+				subscription.orb_meta->o_name, message_header.msg_size, (int)data_size + 2);
+			file.seekg(payload_size, ios::cur);
+			return false;
+		}
+
+		// no copy: use the data directly from the file mapping
+		subscription.next_data = file.read_pointer(data_size);
+		subscription.next_data_valid = subscription.next_data != nullptr;
+		return subscription.next_data_valid;
+	}
+
+	// DATA_DELTA: apply to the previous sample
+	const uint8_t *delta = file.read_pointer(payload_size);
+
+	if (!delta) {
+		return false;
+	}
+
+	if (!subscription.next_data_valid || !subscription.next_data) {
+		// expected after a seek: wait for the next full sample
+		PX4_DEBUG("delta message %s without previous sample. Skipping", subscription.orb_meta->o_name);
+		return false;
+	}
+
+	if (subscription.next_data != subscription.next_data_buffer.data()) {
+		// the reference is in the (read-only) file mapping
+		subscription.next_data_buffer.assign(subscription.next_data, subscription.next_data + data_size);
+		subscription.next_data = subscription.next_data_buffer.data();
+	}
+
+	if (!ulog_data_delta_decode(subscription.next_data_buffer.data(), data_size, delta, payload_size)) {
+		PX4_ERR("delta message %s has wrong size %i. Skipping", subscription.orb_meta->o_name, message_header.msg_size);
+		// the reference is now undefined, wait for the next full sample
+		subscription.next_data_valid = false;
+		return false;
+	}
+
+	return true;
+}
+
 const orb_metadata *
 Replay::findTopic(const std::string &name)
 {
@@ -710,7 +997,7 @@ Replay::sizeOfFullType(const std::string &type_name_full)
 }
 
 bool
-Replay::readDefinitionsAndApplyParams(std::ifstream &file)
+Replay::readDefinitionsAndApplyParams(ULogFile &file)
 {
 	// log reader currently assumes little endian
 	int num = 1;
@@ -736,6 +1023,10 @@ Replay::readDefinitionsAndApplyParams(std::ifstream &file)
 		return false;
 	}
 
+	if (readIndex(file)) {
+		PX4_INFO("Using the log index (%zu time entries)", _index_time.size());
+	}
+
 	setUserParams(PARAMS_OVERRIDE_FILE);
 	return true;
 }
@@ -743,7 +1034,8 @@ Replay::readDefinitionsAndApplyParams(std::ifstream &file)
 void
 Replay::run()
 {
-	ifstream replay_file(_replay_file, ios::in | ios::binary);
+	ULogFile replay_file;
+	replay_file.open(_replay_file);
 
 	if (!readDefinitionsAndApplyParams(replay_file)) {
 		return;
@@ -758,17 +1050,42 @@ Replay::run()
 	ulog_message_header_s message_header;
 	replay_file.seekg(_data_section_start);
 
-	//we know the next message must be an ADD_LOGGED_MSG
-	replay_file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+	//we know the next message must be an ADD_LOGGED_MSG. Add all the subscriptions at the beginning
+	//(they are also found when searching for the data messages, unless the log index skips over them)
+	while (replay_file.read((char *)&message_header, ULOG_MSG_HEADER_LEN)
+	       && message_header.msg_type == (int)ULogMessageType::ADD_LOGGED_MSG) {
+		if (!readAndAddSubscription(replay_file, message_header.msg_size)) {
+			PX4_ERR("Failed to read subscription");
+			return;
+		}
+	}
 
-	if (!readAndAddSubscription(replay_file, message_header.msg_size)) {
-		PX4_ERR("Failed to read subscription");
-		return;
+	replay_file.clear();
+
+	//optional time range to replay [s], relative to the start of the log
+	uint64_t start_time = _file_start_time;
+	uint64_t end_time = UINT64_MAX;
+	const char *replay_start = getenv(replay::ENV_START);
+	const char *replay_end = getenv(replay::ENV_END);
+
+	if (replay_start && atof(replay_start) > 0.) {
+		start_time = _file_start_time + (uint64_t)(atof(replay_start) * 1.e6);
+
+		if (_index_time.empty()) {
+			PX4_INFO("Log has no index, reading the data before the start time");
+
+		} else {
+			seekToTime(replay_file, start_time);
+		}
+	}
+
+	if (replay_end && atof(replay_end) > 0.) {
+		end_time = _file_start_time + (uint64_t)(atof(replay_end) * 1.e6);
 	}
 
 	//we update the timestamps from the file by a constant offset to match
 	//the current replay time
-	const uint64_t timestamp_offset = _replay_start_time - _file_start_time;
+	const uint64_t timestamp_offset = _replay_start_time - start_time;
 	uint32_t nr_published_messages = 0;
 	streampos last_additional_message_pos = _data_section_start;
 
@@ -802,12 +1119,17 @@ Replay::run()
 
 		Subscription &sub = *_subscriptions[next_msg_id];
 
-		if (next_file_time == 0) {
-			//someone didn't set the timestamp properly. Consider the message invalid
+		if (next_file_time == 0 || next_file_time < start_time) {
+			//someone didn't set the timestamp properly (consider the message invalid), or before the requested start.
+			//Parameter changes in between are still applied with the next published message.
 			nextDataMessage(replay_file, sub, next_msg_id);
 			continue;
 		}
 
+		if (next_file_time > end_time) {
+			break;
+		}
+
 		//handle additional messages between last and next published data
 		replay_file.seekg(last_additional_message_pos);
 		streampos next_additional_message_pos = sub.next_read_pos;
@@ -858,17 +1180,17 @@ Replay::run()
 }
 
 void
-Replay::readTopicDataToBuffer(const Subscription &sub, std::ifstream &replay_file)
+Replay::readTopicDataToBuffer(const Subscription &sub, ULogFile &replay_file)
 {
 	const size_t msg_read_size = sub.orb_meta->o_size_no_padding;
 	const size_t msg_write_size = sub.orb_meta->o_size;
 	_read_buffer.reserve(msg_write_size);
-	replay_file.seekg(sub.next_read_pos + (streamoff)(ULOG_MSG_HEADER_LEN + 2)); //skip header & msg id
-	replay_file.read((char *)_read_buffer.data(), msg_read_size);
+	// the data is already decoded by nextDataMessage() (needed for DATA_DELTA messages)
+	memcpy(_read_buffer.data(), sub.next_data, msg_read_size);
 }
 
 bool
-Replay::handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file)
+Replay::handleTopicUpdate(Subscription &sub, void *data, ULogFile &replay_file)
 {
 	return publishTopic(sub, data);
 }
@@ -972,6 +1294,10 @@ the log file to be replayed. The second is the mode, specified via `replay_mode`
 - Generic otherwise: this can be used to replay any module(s), but the replay will be done with the same speed as the
   log was recorded.
 
+Optionally, only a part of the log can be replayed with `replay_start` and `replay_end` (in seconds since the start
+of the log). If the log contains an index (written by the logger when the log is closed), the replay directly seeks
+to the start time.
+
 The module is typically used together with uORB publisher rules, to specify which messages should be replayed.
 The replay module will just publish all messages that are found in the log. It also applies the parameters from
 the log.
@@ -1035,7 +1361,8 @@ Replay::applyParams(bool quiet)
 		return -ENOMEM;
 	}
 
-	ifstream replay_file(_replay_file, ios::in | ios::binary);
+	ULogFile replay_file;
+	replay_file.open(_replay_file);
 
 	if (!r->readDefinitionsAndApplyParams(replay_file)) {
 		ret = -1;
@@ -40,7 +40,9 @@
 #include <string>
 
 #include "definitions.hpp"
+#include "ULogFile.hpp"
 
+#include <logger/messages.h>
 #include <px4_module.h>
 #include <uORB/uORBTopics.h>
 #include <uORB/topics/ekf2_timestamps.h>
@@ -136,6 +138,9 @@ protected:
 
 		std::streampos next_read_pos;
 		uint64_t next_timestamp; ///< timestamp of the file
+		const uint8_t *next_data = nullptr; ///< data of the message at next_read_pos (in the file mapping or next_data_buffer)
+		std::vector<uint8_t> next_data_buffer; ///< decoded data of a DATA_DELTA message
+		bool next_data_valid = false; ///< next_data can be used as reference for a DATA_DELTA message
 
 		CompatBase *compat = nullptr;
 
@@ -189,12 +194,12 @@ protected:
 	 * handle the publication of a topic update
 	 * @return true if published, false otherwise
 	 */
-	virtual bool handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file);
+	virtual bool handleTopicUpdate(Subscription &sub, void *data, ULogFile &replay_file);
 
 	/**
-	 * read a topic from the file (offset given by the subscription) into _read_buffer
+	 * copy the topic data of the next message of a subscription (read by nextDataMessage()) into _read_buffer
 	 */
-	void readTopicDataToBuffer(const Subscription &sub, std::ifstream &replay_file);
+	void readTopicDataToBuffer(const Subscription &sub, ULogFile &replay_file);
 
 	/**
 	 * Find next data message for this subscription, starting with the stored file offset.
@@ -202,9 +207,10 @@ protected:
 	 * This also takes care of new subscriptions and parameter updates. When reaching EOF,
 	 * the subscription is set to invalid.
 	 * File seek position is arbitrary after this call.
+	 * @param skip_first false if the stored file offset was not read yet (e.g. after a seek)
 	 * @return false on file error
 	 */
-	bool nextDataMessage(std::ifstream &file, Subscription &subscription, int msg_id);
+	bool nextDataMessage(ULogFile &file, Subscription &subscription, int msg_id, bool skip_first = true);
 
 	std::vector<Subscription *> _subscriptions;
 	std::vector<uint8_t> _read_buffer;
@@ -217,41 +223,74 @@ private:
 	uint64_t _replay_start_time;
 	std::streampos _data_section_start; ///< first ADD_LOGGED_MSG message
 
-	/** keep track of file position to avoid adding a subscription multiple times. */
-	std::streampos _subscription_file_pos = 0;
+	/** keep track of file positions to avoid adding a subscription multiple times. */
+	std::set<std::streamoff> _added_subscriptions;
+
+	/** log index (if the file has one): (timestamp, file offset) pairs, ordered by time */
+	std::vector<std::pair<uint64_t, uint64_t>> _index_time;
+	std::vector<uint64_t> _index_first_data; ///< file offset of the first data message per msg_id (0 if unknown)
+	std::vector<uint64_t> _index_additional; ///< ascending file offsets of parameter changes and dropouts
+	bool _index_has_additional{false}; ///< _index_additional lists all of them, no need to parse the whole file
 
 	int64_t _read_until_file_position = 1ULL << 60; ///< read limit if log contains appended data
 
-	bool readFileHeader(std::ifstream &file);
+	bool readFileHeader(ULogFile &file);
 
 	/**
 	 * Read definitions section: check formats, apply parameters and store
 	 * the start of the data section.
 	 * @return true on success
 	 */
-	bool readFileDefinitions(std::ifstream &file);
+	bool readFileDefinitions(ULogFile &file);
 
 	///file parsing methods. They return false, when further parsing should be aborted.
-	bool readFormat(std::ifstream &file, uint16_t msg_size);
-	bool readAndAddSubscription(std::ifstream &file, uint16_t msg_size);
-	bool readFlagBits(std::ifstream &file, uint16_t msg_size);
+	bool readFormat(ULogFile &file, uint16_t msg_size);
+	bool readAndAddSubscription(ULogFile &file, uint16_t msg_size);
+	bool readFlagBits(ULogFile &file, uint16_t msg_size);
+
+	/**
+	 * Read the index from the end of the file (@see ULOG_INDEX_KEY). It's optional, and ignored if invalid.
+	 * @return true if the file contains a valid index
+	 */
+	bool readIndex(ULogFile &file);
+
+	/**
+	 * Move all subscriptions forward to the last index entry before a timestamp, so that only the data after it
+	 * needs to be read. Topics added during logging before that point are added first. Does nothing if the file has
+	 * no index.
+	 */
+	void seekToTime(ULogFile &file, uint64_t timestamp);
 
 	/**
 	 * Read the file header and definitions sections. Apply the parameters from this section
 	 * and apply user-defined overridden parameters.
 	 * @return true on success
 	 */
-	bool readDefinitionsAndApplyParams(std::ifstream &file);
+	bool readDefinitionsAndApplyParams(ULogFile &file);
 
 	/**
 	 * Read and handle additional messages starting at current file position, while position < end_position.
 	 * This handles dropout and parameter update messages.
 	 * We need to handle these separately, because they have no timestamp. We look at the file position instead.
+	 * If the log index lists them, only the listed messages are read.
 	 * @return false on file error
 	 */
-	bool readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_position);
-	bool readDropout(std::ifstream &file, uint16_t msg_size);
-	bool readAndApplyParameter(std::ifstream &file, uint16_t msg_size);
+	bool readAndHandleAdditionalMessages(ULogFile &file, std::streampos end_position);
+
+	/**
+	 * Handle the additional messages starting at current file position, while position < end_position.
+	 * @param stop_at_other stop at the first message that is not an additional message (instead of skipping it)
+	 * @return false on file error
+	 */
+	bool handleAdditionalMessages(ULogFile &file, std::streampos end_position, bool stop_at_other);
+	bool readDropout(ULogFile &file, uint16_t msg_size);
+	bool readAndApplyParameter(ULogFile &file, uint16_t msg_size);
+
+	/**
+	 * Read the payload of a DATA or DATA_DELTA message (after the msg_id) and set subscription.next_data.
+	 * @return false if the message is invalid (it is skipped in that case)
+	 */
+	bool readDataMessage(ULogFile &file, Subscription &subscription, const ulog_message_header_s &message_header);
 
 	static const orb_metadata *findTopic(const std::string &name);
 
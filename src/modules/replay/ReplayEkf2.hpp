@@ -59,13 +59,13 @@ protected:
 	 * @param replay_file file currently replayed (file seek position should be considered arbitrary after this call)
 	 * @return true if published, false otherwise
 	 */
-	bool handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file) override;
+	bool handleTopicUpdate(Subscription &sub, void *data, ULogFile &replay_file) override;
 
 	void onSubscriptionAdded(Subscription &sub, uint16_t msg_id) override;
 
 private:
 
-	bool publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifstream &replay_file);
+	bool publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, ULogFile &replay_file);
 
 	/**
 	 * find the next message for a subscription that matches a given timestamp and publish it
@@ -74,7 +74,7 @@ private:
 	 * @param replay_file file currently replayed (file seek position should be considered arbitrary after this call)
 	 * @return true if timestamp found and published
 	 */
-	bool findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, std::ifstream &replay_file);
+	bool findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, ULogFile &replay_file);
 
 	int _vehicle_attitude_sub = -1;
 
@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "ULogFile.hpp"
+
+#include <px4_log.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace px4
+{
+
+bool
+ULogFile::open(const char *file_name)
+{
+	close();
+
+	int fd = ::open(file_name, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping stays valid
+
+	if (data == MAP_FAILED) {
+		PX4_ERR("mmap failed (%i)", errno);
+		return false;
+	}
+
+	// the log is mostly read front to back (each subscription scans forward): aggressive read-ahead
+	if (madvise(data, st.st_size, MADV_SEQUENTIAL) != 0) {
+		PX4_DEBUG("madvise failed (%i)", errno);
+	}
+
+	_data = (const uint8_t *)data;
+	_size = st.st_size;
+	_pos = 0;
+	_state = std::ios_base::goodbit;
+	return true;
+}
+
+void
+ULogFile::close()
+{
+	if (_data) {
+		munmap((void *)_data, _size);
+		_data = nullptr;
+	}
+
+	_size = 0;
+	_pos = 0;
+}
+
+ULogFile &
+ULogFile::read(char *buffer, size_t size)
+{
+	const uint8_t *data = read_pointer(size);
+
+	if (data) {
+		memcpy(buffer, data, size);
+	}
+
+	return *this;
+}
+
+const uint8_t *
+ULogFile::read_pointer(size_t size)
+{
+	if (!*this || !_data) {
+		_state |= std::ios_base::failbit;
+		return nullptr;
+	}
+
+	if (_pos > _size || size > _size - _pos) {
+		_pos = _size;
+		_state |= std::ios_base::eofbit | std::ios_base::failbit;
+		return nullptr;
+	}
+
+	const uint8_t *data = _data + _pos;
+	_pos += size;
+	return data;
+}
+
+ULogFile &
+ULogFile::seekg(std::streampos pos)
+{
+	// like std::istream: clear eof, but do nothing if the stream failed
+	_state &= ~std::ios_base::eofbit;
+
+	if (*this) {
+		if ((std::streamoff)pos < 0) {
+			_state |= std::ios_base::failbit;
+
+		} else {
+			_pos = (size_t)(std::streamoff)pos;
+		}
+	}
+
+	return *this;
+}
+
+ULogFile &
+ULogFile::seekg(std::streamoff off, std::ios_base::seekdir dir)
+{
+	std::streamoff base = 0;
+
+	if (dir == std::ios_base::cur) {
+		base = _pos;
+
+	} else if (dir == std::ios_base::end) {
+		base = _size;
+	}
+
+	return seekg(std::streampos(base + off));
+}
+
+} //namespace px4
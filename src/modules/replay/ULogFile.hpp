@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <ios>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace px4
+{
+
+/**
+ * @class ULogFile
+ * Read-only, memory-mapped ULog file. The interface follows the subset of std::istream used by the replay
+ * (including the stream state semantics), but reading and seeking do not need a system call, and message
+ * payloads can be accessed in place with read_pointer().
+ */
+class ULogFile
+{
+public:
+	ULogFile() = default;
+	~ULogFile() { close(); }
+
+	ULogFile(const ULogFile &) = delete;
+	ULogFile &operator=(const ULogFile &) = delete;
+
+	/**
+	 * map a file
+	 * @return true on success
+	 */
+	bool open(const char *file_name);
+	void close();
+	bool is_open() const { return _data != nullptr; }
+
+	size_t size() const { return _size; }
+
+	/**
+	 * copy size bytes from the current position
+	 */
+	ULogFile &read(char *buffer, size_t size);
+
+	/**
+	 * get a pointer to size bytes at the current position and advance the position.
+	 * The pointer is valid until close().
+	 * @return nullptr if the file is too short (and the stream state is set accordingly)
+	 */
+	const uint8_t *read_pointer(size_t size);
+
+	ULogFile &seekg(std::streampos pos);
+	ULogFile &seekg(std::streamoff off, std::ios_base::seekdir dir);
+	std::streampos tellg() const { return _state & std::ios_base::failbit ? std::streampos(-1) : std::streampos(_pos); }
+
+	explicit operator bool() const { return (_state & (std::ios_base::failbit | std::ios_base::badbit)) == 0; }
+	bool operator!() const { return !static_cast<bool>(*this); }
+	bool good() const { return _state == std::ios_base::goodbit; }
+	bool eof() const { return (_state & std::ios_base::eofbit) != 0; }
+	void clear() { _state = std::ios_base::goodbit; }
+	void setstate(std::ios_base::iostate state) { _state |= state; }
+
+private:
+	const uint8_t *_data{nullptr};
+	size_t _size{0};
+	size_t _pos{0};
+	std::ios_base::iostate _state{std::ios_base::goodbit};
+};
+
+} //namespace px4
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <ios>
+#include <stdint.h>
+#include <vector>
+
+#include <logger/messages.h>
+
+namespace px4
+{
+
+/**
+ * Find the ADD_LOGGED_MSG messages in the range [start, end) of a ULog data section by reading only message headers.
+ * Replay uses it to add the topics that the logger subscribed to in a range it seeks over.
+ *
+ * @param file ULogFile (or a std::istream)
+ * @param index_additional ascending offsets from the log index (ULOG_INDEX_ADDITIONAL_KEY). They list the
+ *        ADD_LOGGED_MSG of every topic subscribed during logging, so only the runs of messages at these offsets are
+ *        read. nullptr if the log has none: then all headers in the range are read.
+ * @param offsets the file offsets of the found messages are appended
+ * @return false on a read error
+ */
+template<class File>
+bool ulog_find_add_logged_messages(File &file, std::streampos start, std::streampos end,
+				   const std::vector<uint64_t> *index_additional, std::vector<std::streampos> &offsets)
+{
+	ulog_message_header_s header;
+
+	auto scan = [&](std::streampos from, bool run_only) {
+		file.seekg(from);
+
+		while (file && file.tellg() < end) {
+			const std::streampos pos = file.tellg();
+
+			if (!file.read((char *)&header, ULOG_MSG_HEADER_LEN)) {
+				return false;
+			}
+
+			if (header.msg_type == (uint8_t)ULogMessageType::ADD_LOGGED_MSG) {
+				offsets.push_back(pos);
+
+			} else if (run_only && header.msg_type != (uint8_t)ULogMessageType::PARAMETER
+				   && header.msg_type != (uint8_t)ULogMessageType::DROPOUT) {
+				return true; // end of the listed run
+			}
+
+			file.seekg(header.msg_size, std::ios::cur);
+		}
+
+		return (bool)file;
+	};
+
+	if (!index_additional) {
+		return scan(start, false);
+	}
+
+	std::streampos handled = start;
+
+	for (const uint64_t entry : *index_additional) {
+		if ((std::streamoff)entry >= (std::streamoff)end) {
+			break;
+		}
+
+		if ((std::streamoff)entry < (std::streamoff)handled) {
+			continue; // before the range, or already read with the previous run
+		}
+
+		if (!scan((std::streamoff)entry, true)) {
+			return false;
+		}
+
+		handled = file.tellg();
+	}
+
+	return true;
+}
+
+} //namespace px4
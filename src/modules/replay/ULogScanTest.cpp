@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "ULogScan.hpp"
+
+#include <sstream>
+#include <string>
+
+using namespace px4;
+
+class ULogScanTest : public ::testing::Test
+{
+public:
+	// append a message with an empty payload of the given size, return its offset
+	std::streampos add(ULogMessageType type, uint16_t payload_size = 8)
+	{
+		const std::streampos pos = (std::streamoff)_data.size();
+		ulog_message_header_s header{payload_size, (uint8_t)type};
+		_data.append((const char *)&header, ULOG_MSG_HEADER_LEN);
+		_data.append(payload_size, '\0');
+		return pos;
+	}
+
+	std::vector<std::streampos> find(std::streampos start, std::streampos end, const std::vector<uint64_t> *index,
+					 bool expect_ok = true)
+	{
+		std::istringstream file(_data);
+		std::vector<std::streampos> offsets;
+		EXPECT_EQ(ulog_find_add_logged_messages(file, start, end, index, offsets), expect_ok);
+		return offsets;
+	}
+
+	std::string _data;
+};
+
+TEST_F(ULogScanTest, MidLogSubscription)
+{
+	// topics a (subscribed at the start), b and c (subscribed during logging), d (after the seek offset)
+	const std::streampos start = add(ULogMessageType::ADD_LOGGED_MSG, 12);
+	add(ULogMessageType::DATA, 40);
+	const std::streampos param = add(ULogMessageType::PARAMETER, 20);
+	add(ULogMessageType::DATA, 40);
+	const std::streampos add_b = add(ULogMessageType::ADD_LOGGED_MSG, 15);
+	add(ULogMessageType::DATA, 24);
+	add(ULogMessageType::SYNC);
+	const std::streampos dropout = add(ULogMessageType::DROPOUT, 2);
+	const std::streampos add_c = add(ULogMessageType::ADD_LOGGED_MSG, 17); // in the run of the dropout
+	add(ULogMessageType::DATA, 60);
+	const std::streampos seek_offset = add(ULogMessageType::SYNC);
+	const std::streampos add_d = add(ULogMessageType::ADD_LOGGED_MSG, 12);
+	add(ULogMessageType::DATA, 40);
+	const std::vector<uint64_t> index{(uint64_t)(std::streamoff)param, (uint64_t)(std::streamoff)add_b,
+					  (uint64_t)(std::streamoff)dropout, (uint64_t)(std::streamoff)add_d};
+
+	// without an index all headers are read
+	std::vector<std::streampos> offsets = find(start, seek_offset, nullptr);
+	ASSERT_EQ(offsets.size(), 3u);
+	EXPECT_EQ(offsets[0], start);
+	EXPECT_EQ(offsets[1], add_b);
+	EXPECT_EQ(offsets[2], add_c);
+
+	// with the index only the listed runs: the topics subscribed at the start are not listed
+	offsets = find(start, seek_offset, &index);
+	ASSERT_EQ(offsets.size(), 2u);
+	EXPECT_EQ(offsets[0], add_b);
+	EXPECT_EQ(offsets[1], add_c);
+
+	// a range starting after b
+	offsets = find(add_b + (std::streamoff)1, seek_offset, &index);
+	ASSERT_EQ(offsets.size(), 1u);
+	EXPECT_EQ(offsets[0], add_c);
+
+	// the whole file
+	offsets = find(start, (std::streamoff)_data.size(), &index);
+	ASSERT_EQ(offsets.size(), 3u);
+	EXPECT_EQ(offsets[2], add_d);
+}
+
+TEST_F(ULogScanTest, TruncatedFile)
+{
+	const std::streampos start = add(ULogMessageType::DATA, 40);
+	add(ULogMessageType::ADD_LOGGED_MSG, 12);
+	add(ULogMessageType::DATA, 40);
+	_data.resize(_data.size() - 30);
+
+	const std::vector<std::streampos> offsets = find(start, start + (std::streamoff)200, nullptr, false);
+	EXPECT_EQ(offsets.size(), 1u);
+}
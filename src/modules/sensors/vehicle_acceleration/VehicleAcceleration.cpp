@@ -159,6 +159,11 @@ VehicleAcceleration::ParametersUpdate(bool force)
 		parameter_update_s param_update;
 		_params_sub.copy(&param_update);
 
+		// nothing to do if the board rotation parameters did not change
+		if (!force && !parametersChanged()) {
+			return;
+		}
+
 		updateParams();
 
 		// get transformation matrix from sensor/board to body frame
@@ -198,6 +198,11 @@ VehicleAngularVelocity::ParametersUpdate(bool force)
 		parameter_update_s param_update;
 		_params_sub.copy(&param_update);
 
+		// nothing to do if the board rotation parameters did not change
+		if (!force && !parametersChanged()) {
+			return;
+		}
+
 		updateParams();
 
 		// get transformation matrix from sensor/board to body frame
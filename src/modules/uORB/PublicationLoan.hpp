@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file PublicationLoan.hpp
+ *
+ */
+
+#pragma once
+
+#include <px4_defines.h>
+#include <uORB/uORB.h>
+
+#include "uORBManager.hpp"
+
+namespace uORB
+{
+
+/**
+ * Publication that lets the publisher fill messages in place, directly in the
+ * topic's buffer, instead of having publish() copy them.
+ *
+ * The first publication (the advertisement) is copied from an embedded buffer. If the
+ * topic is already published by someone else, loans are not available and the
+ * embedded buffer is used for all publications.
+ */
+template<typename T>
+class PublicationLoan
+{
+public:
+
+	/**
+	 * Constructor
+	 *
+	 * @param meta The uORB metadata (usually from the ORB_ID() macro) for the topic.
+	 */
+	PublicationLoan(const orb_metadata *meta) : _meta(meta) {}
+	~PublicationLoan()
+	{
+		// an unpublished loan of this publisher is discarded (not one of another publisher of the instance)
+		if (_loaned) {
+			uORB::Manager::get_instance()->orb_cancel_loan(_meta, _handle);
+		}
+
+		orb_unadvertise(_handle);
+	}
+
+	// no copy, assignment, move, move assignment
+	PublicationLoan(const PublicationLoan &) = delete;
+	PublicationLoan &operator=(const PublicationLoan &) = delete;
+	PublicationLoan(PublicationLoan &&) = delete;
+	PublicationLoan &operator=(PublicationLoan &&) = delete;
+
+	/**
+	 * Get the buffer of the next message. It is only valid until publish() is called,
+	 * and its previous content is undefined, so all fields must be written.
+	 */
+	T &loan()
+	{
+		if (!_loaned && (_handle != nullptr)) {
+			T *slot = (T *)uORB::Manager::get_instance()->orb_loan(_meta, _handle);
+
+			if (slot != nullptr) {
+				_loan = slot;
+				_loaned = true;
+			}
+		}
+
+		return *_loan;
+	}
+
+	/**
+	 * Publish the message filled in the buffer returned by loan()
+	 */
+	bool publish()
+	{
+		if (_loaned) {
+			_loaned = false;
+			_loan = &_data;
+			return (uORB::Manager::get_instance()->orb_publish_loan(_meta, _handle) == PX4_OK);
+
+		} else if (_handle != nullptr) {
+			return (orb_publish(_meta, _handle, &_data) == PX4_OK);
+
+		} else {
+			orb_advert_t handle = uORB::Manager::get_instance()->orb_advertise_multi(_meta, &_data, nullptr,
+					      ORB_PRIO_DEFAULT, 1, true);
+
+			if (handle != nullptr) {
+				_handle = handle;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+protected:
+	const orb_metadata *_meta;
+
+	orb_advert_t _handle{nullptr};
+
+	T _data{};
+	T *_loan{&_data};
+	bool _loaned{false};
+};
+
+} // namespace uORB
@@ -97,6 +97,16 @@ public:
 	 * */
 	bool updated() { return published() ? (_node->published_message_count() != _last_generation) : false; }
 
+	/**
+	 * Number of publications not read yet. If this exceeds the queue size, the oldest ones are lost.
+	 */
+	unsigned unread_count() const { return valid() ? _node->published_message_count() - _last_generation : 0; }
+
+	/**
+	 * Queue size of the topic (0 if not subscribed yet).
+	 */
+	uint8_t get_queue_size() const { return valid() ? _node->get_queue_size() : 0; }
+
 	/**
 	 * Update the struct
 	 * @param data The uORB message struct we are updating.
@@ -120,6 +130,21 @@ public:
 	 */
 	bool copy(void *dst) { return published() ? _node->copy(dst, _last_generation) : false; }
 
+	/**
+	 * Borrow a read-only view of the message that copy() would return, without copying it.
+	 * The view refers to a fixed generation in the publisher's queue buffer and must be
+	 * handed back with release() once the caller is done reading it.
+	 * @return pointer to the message, nullptr if nothing was published yet
+	 */
+	const void *borrow() { return published() ? _node->borrow(_last_generation, _borrowed_index) : nullptr; }
+
+	/**
+	 * Release a view returned by borrow().
+	 * @return true if the view was not overwritten by the publisher while it was held.
+	 * If false, everything read through the view must be discarded.
+	 */
+	bool release() { return valid() ? _node->borrow_valid(_borrowed_index) : false; }
+
 	uint8_t		get_instance() const { return _instance; }
 	orb_id_t	get_topic() const { return _meta; }
 
@@ -140,6 +165,7 @@ protected:
 	 * attempts if the topic has not yet been published.
 	 */
 	unsigned		_last_generation{0};
+	unsigned		_borrowed_index{0}; /**< buffer index of the last borrow() */
 	uint8_t			_instance{0};
 };
 
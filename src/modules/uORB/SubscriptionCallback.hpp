@@ -91,6 +91,15 @@ public:
 		return ret;
 	}
 
+	/**
+	 * Register the callback only if the topic already exists (unlike register_callback() it never creates it).
+	 * @return true if registered
+	 */
+	bool register_callback_if_exists()
+	{
+		return _subscription.get_node() && _subscription.get_node()->register_callback(this);
+	}
+
 	void unregister_callback()
 	{
 		if (_subscription.get_node()) {
@@ -136,6 +136,7 @@ uORB::DeviceMaster::advertise(const struct orb_metadata *meta, int *instance, in
 		} else {
 			// add to the node map;.
 			_node_list.add(node);
+			addToNodeIndex(node);
 		}
 
 		group_tries++;
@@ -409,20 +410,53 @@ void uORB::DeviceMaster::showTop(char **topic_filter, int num_filters)
 
 #undef CLEAR_LINE
 
+unsigned uORB::DeviceMaster::nodeIndexHash(const char *name, size_t name_len, const uint8_t instance)
+{
+	// FNV-1a over the topic name, with the instance mixed in as a final byte
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < name_len; i++) {
+		hash ^= (uint8_t)name[i];
+		hash *= 16777619u;
+	}
+
+	hash ^= instance;
+	hash *= 16777619u;
+
+	return hash & (NODE_INDEX_SIZE - 1);
+}
+
+void uORB::DeviceMaster::addToNodeIndex(uORB::DeviceNode *node)
+{
+	const char *name = node->get_name();
+	const unsigned bucket = nodeIndexHash(name, strlen(name), node->get_instance());
+
+	node->_index_next = _node_index[bucket];
+	_node_index[bucket] = node;
+}
+
 uORB::DeviceNode *uORB::DeviceMaster::getDeviceNode(const char *nodepath)
 {
-	lock();
+	// node paths are of the form /obj/<topic name><instance>, see uORB::Utils::node_mkpath()
+	static constexpr char prefix[] = "/obj/";
+	static constexpr size_t prefix_len = sizeof(prefix) - 1;
 
-	for (uORB::DeviceNode *node : _node_list) {
-		if (strcmp(node->get_devname(), nodepath) == 0) {
-			unlock();
-			return node;
-		}
+	if ((nodepath == nullptr) || (strncmp(nodepath, prefix, prefix_len) != 0)) {
+		return nullptr;
 	}
 
+	const char *name = nodepath + prefix_len;
+	const size_t len = strlen(name);
+
+	if ((len < 2) || (name[len - 1] < '0') || (name[len - 1] > '9')) {
+		return nullptr;
+	}
+
+	lock();
+	uORB::DeviceNode *node = getDeviceNodeLocked(name, len - 1, name[len - 1] - '0');
 	unlock();
 
-	return nullptr;
+	return node;
 }
 
 uORB::DeviceNode *uORB::DeviceMaster::getDeviceNode(const struct orb_metadata *meta, const uint8_t instance)
@@ -442,8 +476,18 @@ uORB::DeviceNode *uORB::DeviceMaster::getDeviceNode(const struct orb_metadata *m
 
 uORB::DeviceNode *uORB::DeviceMaster::getDeviceNodeLocked(const struct orb_metadata *meta, const uint8_t instance)
 {
-	for (uORB::DeviceNode *node : _node_list) {
-		if ((strcmp(node->get_name(), meta->o_name) == 0) && (node->get_instance() == instance)) {
+	return getDeviceNodeLocked(meta->o_name, strlen(meta->o_name), instance);
+}
+
+uORB::DeviceNode *uORB::DeviceMaster::getDeviceNodeLocked(const char *name, size_t name_len, const uint8_t instance)
+{
+	const unsigned bucket = nodeIndexHash(name, name_len, instance);
+
+	for (uORB::DeviceNode *node = _node_index[bucket]; node != nullptr; node = node->_index_next) {
+		const char *node_name = node->get_name();
+
+		if ((node->get_instance() == instance) && (strncmp(node_name, name, name_len) == 0)
+		    && (node_name[name_len] == '\0')) {
 			return node;
 		}
 	}
@@ -110,8 +110,33 @@ private:
 	 */
 	uORB::DeviceNode *getDeviceNodeLocked(const struct orb_metadata *meta, const uint8_t instance);
 
+	/**
+	 * Find a node given its topic name (not necessarily null-terminated) and instance.
+	 * _lock must already be held when calling this.
+	 * @return node if exists, nullptr otherwise
+	 */
+	uORB::DeviceNode *getDeviceNodeLocked(const char *name, size_t name_len, const uint8_t instance);
+
+	/**
+	 * Hash a topic name and instance into an index bucket.
+	 */
+	static unsigned nodeIndexHash(const char *name, size_t name_len, const uint8_t instance);
+
+	/**
+	 * Add a node to the lookup index. _lock must already be held when calling this.
+	 */
+	void addToNodeIndex(uORB::DeviceNode *node);
+
+	static constexpr unsigned NODE_INDEX_SIZE = 128; /**< number of index buckets, must be a power of 2 */
+
 	List<uORB::DeviceNode *> _node_list;
 
+	/**
+	 * Lookup index of all nodes in _node_list, hashed by topic name and instance.
+	 * Each bucket is a singly linked list chained through DeviceNode::_index_next.
+	 */
+	uORB::DeviceNode *_node_index[NODE_INDEX_SIZE] {};
+
 	hrt_abstime       _last_statistics_output;
 
 	px4_sem_t	_lock; /**< lock to protect access to all class members (also for derived classes) */
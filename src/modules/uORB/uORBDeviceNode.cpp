@@ -169,11 +169,12 @@ uORB::DeviceNode::copy_locked(void *dst, unsigned &generation)
 {
 	bool updated = false;
 
-	if ((dst != nullptr) && (_data != nullptr)) {
+	// generation 0 is not published yet: with loans its slot can already be filled in place
+	if ((dst != nullptr) && (_data != nullptr) && (_generation > 0)) {
 
 		if (_generation > generation + _queue_size) {
 			// Reader is too far behind: some messages are lost
-			_lost_messages += _generation - (generation + _queue_size);
+			__atomic_fetch_add(&_lost_messages, _generation - (generation + _queue_size), __ATOMIC_RELAXED);
 			generation = _generation - _queue_size;
 		}
 
@@ -184,7 +185,7 @@ uORB::DeviceNode::copy_locked(void *dst, unsigned &generation)
 			--generation;
 		}
 
-		memcpy(dst, _data + (_meta->o_size * (generation % _queue_size)), _meta->o_size);
+		memcpy(dst, _data + (_meta->o_size * (generation % buffer_slots())), _meta->o_size);
 
 		if (generation < _generation) {
 			++generation;
@@ -196,9 +197,83 @@ uORB::DeviceNode::copy_locked(void *dst, unsigned &generation)
 	return updated;
 }
 
+#ifdef ORB_USE_SEQLOCK
+bool
+uORB::DeviceNode::copy_seqlock(void *dst, unsigned &generation, hrt_abstime *update_time, bool &updated)
+{
+	for (int i = 0; i < SEQLOCK_MAX_RETRIES; i++) {
+		const unsigned seq_begin = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+
+		if (seq_begin & 1) {
+			// a write is in progress, and the writer might be preempted: do not spin
+			return false;
+		}
+
+		uint8_t *data = _data;
+		const unsigned node_generation = _generation;
+
+		if ((dst == nullptr) || (data == nullptr) || (node_generation == 0)) {
+			updated = false;
+			return true;
+		}
+
+		const hrt_abstime last_update = _last_update;
+		unsigned gen = generation;
+		unsigned lost = 0;
+
+		if (node_generation > gen + _queue_size) {
+			// Reader is too far behind: some messages are lost
+			lost = node_generation - (gen + _queue_size);
+			gen = node_generation - _queue_size;
+		}
+
+		if ((node_generation == gen) && (gen > 0)) {
+			/* The subscriber already read the latest message, but nothing new was published yet.
+			 * Return the previous message
+			 */
+			--gen;
+		}
+
+		memcpy(dst, data + (_meta->o_size * (gen % buffer_slots())), _meta->o_size);
+
+		if (gen < node_generation) {
+			++gen;
+		}
+
+		// order the data reads above before re-reading the sequence counter
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		if (__atomic_load_n(&_seq, __ATOMIC_RELAXED) == seq_begin) {
+			if (lost > 0) {
+				__atomic_fetch_add(&_lost_messages, lost, __ATOMIC_RELAXED);
+			}
+
+			if (update_time != nullptr) {
+				*update_time = last_update;
+			}
+
+			generation = gen;
+			updated = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+#endif /* ORB_USE_SEQLOCK */
+
 bool
 uORB::DeviceNode::copy(void *dst, unsigned &generation)
 {
+#ifdef ORB_USE_SEQLOCK
+	bool copied = false;
+
+	if (copy_seqlock(dst, generation, nullptr, copied)) {
+		return copied;
+	}
+
+#endif /* ORB_USE_SEQLOCK */
+
 	ATOMIC_ENTER;
 
 	bool updated = copy_locked(dst, generation);
@@ -211,6 +286,17 @@ uORB::DeviceNode::copy(void *dst, unsigned &generation)
 uint64_t
 uORB::DeviceNode::copy_and_get_timestamp(void *dst, unsigned &generation)
 {
+#ifdef ORB_USE_SEQLOCK
+	hrt_abstime timestamp = 0;
+	bool copied = false;
+
+	if (copy_seqlock(dst, generation, &timestamp, copied)) {
+		// without data copy_locked() still returns the last update time
+		return copied ? timestamp : _last_update;
+	}
+
+#endif /* ORB_USE_SEQLOCK */
+
 	ATOMIC_ENTER;
 
 	const hrt_abstime update_time = _last_update;
@@ -241,7 +327,7 @@ uORB::DeviceNode::read(cdev::file_t *filp, char *buffer, size_t buflen)
 	 */
 	ATOMIC_ENTER;
 
-	copy_locked(buffer, sd->generation);
+	const bool copied = copy_locked(buffer, sd->generation);
 
 	// if subscriber has an interval track the last update time
 	if (sd->update_interval) {
@@ -250,7 +336,56 @@ uORB::DeviceNode::read(cdev::file_t *filp, char *buffer, size_t buflen)
 
 	ATOMIC_LEAVE;
 
-	return _meta->o_size;
+	/* nothing was published yet */
+	return copied ? _meta->o_size : 0;
+}
+
+bool
+uORB::DeviceNode::allocate_buffer()
+{
+	if (nullptr == _data) {
+		lock();
+
+		/* re-check size */
+		if (nullptr == _data) {
+			/* loanable topics have one more slot for a write deferred by a loan */
+			_data = new uint8_t[_meta->o_size * (buffer_slots() + (_loanable ? 1 : 0))];
+		}
+
+		unlock();
+	}
+
+	return (_data != nullptr);
+}
+
+void
+uORB::DeviceNode::begin_write_locked()
+{
+#ifdef ORB_USE_SEQLOCK
+	/* writers are serialized by ATOMIC_ENTER, readers of copy_seqlock() retry while the counter is odd */
+	__atomic_store_n(&_seq, _seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+#endif /* ORB_USE_SEQLOCK */
+}
+
+void
+uORB::DeviceNode::commit_locked()
+{
+	/* update the timestamp and generation count */
+	_last_update = hrt_absolute_time();
+	/* wrap-around happens after ~49 days, assuming a publisher rate of 1 kHz */
+	_generation++;
+
+#ifdef ORB_USE_SEQLOCK
+	__atomic_store_n(&_seq, _seq + 1, __ATOMIC_RELEASE);
+#endif /* ORB_USE_SEQLOCK */
+
+	_published = true;
+
+	// callbacks
+	for (auto item : _callbacks) {
+		item->call();
+	}
 }
 
 ssize_t
@@ -272,14 +407,7 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 		if (!up_interrupt_context()) {
 #endif /* __PX4_NUTTX */
 
-			lock();
-
-			/* re-check size */
-			if (nullptr == _data) {
-				_data = new uint8_t[_meta->o_size * _queue_size];
-			}
-
-			unlock();
+			allocate_buffer();
 
 #ifdef __PX4_NUTTX
 		}
@@ -299,20 +427,26 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 
 	/* Perform an atomic copy. */
 	ATOMIC_ENTER;
-	memcpy(_data + (_meta->o_size * (_generation % _queue_size)), buffer, _meta->o_size);
 
-	/* update the timestamp and generation count */
-	_last_update = hrt_absolute_time();
-	/* wrap-around happens after ~49 days, assuming a publisher rate of 1 kHz */
-	_generation++;
+	if (_loaned) {
+		/* the slot is being filled in place by the loan holder: publish this message after the loan */
+		if (_write_deferred) {
+			__atomic_fetch_add(&_lost_messages, 1, __ATOMIC_RELAXED);
+		}
 
-	_published = true;
+		memcpy(deferred_slot(), buffer, _meta->o_size);
+		_write_deferred = true;
 
-	// callbacks
-	for (auto item : _callbacks) {
-		item->call();
+		ATOMIC_LEAVE;
+		return _meta->o_size;
 	}
 
+	begin_write_locked();
+
+	memcpy(_data + (_meta->o_size * (_generation % buffer_slots())), buffer, _meta->o_size);
+
+	commit_locked();
+
 	ATOMIC_LEAVE;
 
 	/* notify any poll waiters */
@@ -321,6 +455,73 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 	return _meta->o_size;
 }
 
+const void *
+uORB::DeviceNode::borrow(unsigned &generation, unsigned &index)
+{
+	if (_data == nullptr) {
+		return nullptr;
+	}
+
+	ATOMIC_ENTER;
+
+	if (_generation == 0) {
+		// nothing published yet
+		ATOMIC_LEAVE;
+		return nullptr;
+	}
+
+	if (_generation > generation + _queue_size) {
+		// Reader is too far behind: some messages are lost
+		__atomic_fetch_add(&_lost_messages, _generation - (generation + _queue_size), __ATOMIC_RELAXED);
+		generation = _generation - _queue_size;
+	}
+
+	if ((_generation == generation) && (generation > 0)) {
+		/* The subscriber already read the latest message, but nothing new was published yet.
+		 * Return the previous message
+		 */
+		--generation;
+	}
+
+	index = generation;
+	const void *view = _data + (_meta->o_size * (generation % buffer_slots()));
+
+	if (generation < _generation) {
+		++generation;
+	}
+
+	ATOMIC_LEAVE;
+
+	return view;
+}
+
+bool
+uORB::DeviceNode::borrow_valid(unsigned index)
+{
+	// the slot of index is overwritten by the write of index + buffer_slots()
+	unsigned writes_started;
+
+#ifdef ORB_USE_SEQLOCK
+	// order the reads through the view before checking the sequence counter
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	unsigned seq;
+
+	do {
+		seq = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+		// a write (or loan) in progress has already started on its slot
+		writes_started = _generation + (((seq & 1) || __atomic_load_n(&_loaned, __ATOMIC_RELAXED)) ? 1 : 0);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&_seq, __ATOMIC_RELAXED) != seq);
+
+#else
+	ATOMIC_ENTER;
+	writes_started = _generation + (_loaned ? 1 : 0);
+	ATOMIC_LEAVE;
+#endif /* ORB_USE_SEQLOCK */
+
+	return (writes_started - index) <= buffer_slots();
+}
+
 int
 uORB::DeviceNode::ioctl(cdev::file_t *filp, int cmd, unsigned long arg)
 {
@@ -399,6 +600,10 @@ uORB::DeviceNode::ioctl(cdev::file_t *filp, int cmd, unsigned long arg)
 
 		return OK;
 
+	case ORBIOCSETLOANABLE:
+		//same as the queue size, this is only used during the advertisement call
+		return arg ? enable_loans() : PX4_OK;
+
 	default:
 		/* give it to the superclass */
 		return CDev::ioctl(filp, cmd, arg);
@@ -454,6 +659,159 @@ uORB::DeviceNode::publish(const orb_metadata *meta, orb_advert_t handle, const v
 	return PX4_OK;
 }
 
+void *
+uORB::DeviceNode::loan(const orb_metadata *meta, orb_advert_t handle)
+{
+	uORB::DeviceNode *devnode = (uORB::DeviceNode *)handle;
+
+	if ((devnode == nullptr) || (meta == nullptr) || (devnode->_meta != meta)) {
+		return nullptr;
+	}
+
+	return devnode->begin_loan();
+}
+
+int
+uORB::DeviceNode::publish_loan(const orb_metadata *meta, orb_advert_t handle)
+{
+	uORB::DeviceNode *devnode = (uORB::DeviceNode *)handle;
+
+	/* check if the device handle is initialized */
+	if ((devnode == nullptr) || (meta == nullptr)) {
+		errno = EFAULT;
+		return PX4_ERROR;
+	}
+
+	/* check if the orb meta data matches the publication */
+	if (devnode->_meta != meta) {
+		errno = EINVAL;
+		return PX4_ERROR;
+	}
+
+	const uint8_t *data = devnode->commit_loan();
+
+	if (data == nullptr) {
+		errno = EINVAL;
+		return PX4_ERROR;
+	}
+
+#ifdef ORB_COMMUNICATOR
+	/*
+	 * if the publication is successful, send the data over the Multi-ORB link
+	 */
+	uORBCommunicator::IChannel *ch = uORB::Manager::get_instance()->get_uorb_communicator();
+
+	if (ch != nullptr) {
+		if (ch->send_message(meta->o_name, meta->o_size, (uint8_t *)data) != 0) {
+			PX4_ERR("Error Sending [%s] topic data over comm_channel", meta->o_name);
+			return PX4_ERROR;
+		}
+	}
+
+#endif /* ORB_COMMUNICATOR */
+
+	return PX4_OK;
+}
+
+int
+uORB::DeviceNode::cancel_loan(const orb_metadata *meta, orb_advert_t handle)
+{
+	uORB::DeviceNode *devnode = (uORB::DeviceNode *)handle;
+
+	if ((devnode == nullptr) || (meta == nullptr) || (devnode->_meta != meta)) {
+		return PX4_ERROR;
+	}
+
+	devnode->cancel_loan();
+	return PX4_OK;
+}
+
+void *
+uORB::DeviceNode::begin_loan()
+{
+	if (!_loanable || !allocate_buffer()) {
+		return nullptr;
+	}
+
+	ATOMIC_ENTER;
+
+	if (_loaned) {
+		ATOMIC_LEAVE;
+		return nullptr;
+	}
+
+	/* borrow_valid() checks the flag after reading through a view of the slot that is now overwritten */
+	__atomic_store_n(&_loaned, true, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	/* the spare slot: no subscriber reads the generation that is about to be published */
+	uint8_t *slot = _data + (_meta->o_size * (_generation % buffer_slots()));
+
+	ATOMIC_LEAVE;
+
+	return slot;
+}
+
+const uint8_t *
+uORB::DeviceNode::commit_loan()
+{
+	ATOMIC_ENTER;
+
+	if (!_loaned) {
+		ATOMIC_LEAVE;
+		return nullptr;
+	}
+
+	const uint8_t *slot = _data + (_meta->o_size * (_generation % buffer_slots()));
+
+	/* the slot is already filled, only the generation update is visible to lock-free readers */
+	begin_write_locked();
+	commit_locked();
+
+	__atomic_store_n(&_loaned, false, __ATOMIC_RELAXED);
+	publish_deferred_locked();
+
+	ATOMIC_LEAVE;
+
+	/* notify any poll waiters */
+	poll_notify(POLLIN);
+
+	return slot;
+}
+
+void
+uORB::DeviceNode::cancel_loan()
+{
+	ATOMIC_ENTER;
+
+	__atomic_store_n(&_loaned, false, __ATOMIC_RELAXED);
+	const bool published = publish_deferred_locked();
+
+	ATOMIC_LEAVE;
+
+	if (published) {
+		poll_notify(POLLIN);
+	}
+}
+
+bool
+uORB::DeviceNode::publish_deferred_locked()
+{
+	if (!_write_deferred) {
+		return false;
+	}
+
+	_write_deferred = false;
+
+	begin_write_locked();
+
+	memcpy(_data + (_meta->o_size * (_generation % buffer_slots())), deferred_slot(), _meta->o_size);
+
+	commit_locked();
+
+	return true;
+}
+
 int uORB::DeviceNode::unadvertise(orb_advert_t handle)
 {
 	if (handle == nullptr) {
@@ -670,6 +1028,21 @@ int uORB::DeviceNode::update_queue_size(unsigned int queue_size)
 	return PX4_OK;
 }
 
+int uORB::DeviceNode::enable_loans()
+{
+	if (_loanable) {
+		return PX4_OK;
+	}
+
+	//the spare slot is part of the buffer, so this is only possible before the first publication
+	if (_data || buffer_slots() >= 255) {
+		return PX4_ERROR;
+	}
+
+	_loanable = true;
+	return PX4_OK;
+}
+
 bool
 uORB::DeviceNode::register_callback(uORB::SubscriptionCallback *callback_sub)
 {
@@ -40,6 +40,14 @@
 
 #include <containers/List.hpp>
 
+/**
+ * Lock-free (seqlock) read path for copy() and copy_and_get_timestamp().
+ * Requires real atomics, which are not available on QuRT.
+ */
+#if !defined(__PX4_QURT)
+#define ORB_USE_SEQLOCK
+#endif
+
 namespace uORB
 {
 class DeviceNode;
@@ -114,6 +122,24 @@ public:
 
 	static int        unadvertise(orb_advert_t handle);
 
+	/**
+	 * Method to loan the buffer slot of the next publication.
+	 * @see uORB::Manager::orb_loan()
+	 */
+	static void      *loan(const orb_metadata *meta, orb_advert_t handle);
+
+	/**
+	 * Method to publish the message previously filled in place.
+	 * @see uORB::Manager::orb_publish_loan()
+	 */
+	static int        publish_loan(const orb_metadata *meta, orb_advert_t handle);
+
+	/**
+	 * Method to discard a loan without publishing it.
+	 * @see uORB::Manager::orb_cancel_loan()
+	 */
+	static int        cancel_loan(const orb_metadata *meta, orb_advert_t handle);
+
 #ifdef ORB_COMMUNICATOR
 	static int16_t topic_advertised(const orb_metadata *meta, int priority);
 	//static int16_t topic_unadvertised(const orb_metadata *meta, int priority);
@@ -172,6 +198,13 @@ public:
 	 */
 	int update_queue_size(unsigned int queue_size);
 
+	/**
+	 * Allow the publisher to fill messages in place (loans). This reserves one buffer
+	 * slot in addition to the queue, and can only be done as long as nobody published yet.
+	 * @return PX4_OK if loans are enabled
+	 */
+	int enable_loans();
+
 	/**
 	 * Print statistics (nr of lost messages)
 	 * @param reset if true, reset statistics afterwards
@@ -224,6 +257,29 @@ public:
 	 */
 	uint64_t copy_and_get_timestamp(void *dst, unsigned &generation);
 
+	/**
+	 * Borrow a read-only view of a message in the queue buffer instead of copying it.
+	 * Advances the generation the same way as copy().
+	 *
+	 * The view is not pinned: the publisher may overwrite the slot once the queue wrapped
+	 * around. Check borrow_valid() after reading and discard the data if it returns false.
+	 *
+	 * @param generation
+	 *   The generation that was borrowed.
+	 * @param index
+	 *   Set to the buffer index of the borrowed message, to be passed to borrow_valid().
+	 * @return
+	 *   Pointer to the message, nullptr if nothing was published yet.
+	 */
+	const void *borrow(unsigned &generation, unsigned &index);
+
+	/**
+	 * Check whether a view returned by borrow() has not been overwritten since.
+	 * @param index
+	 *   The index returned by borrow().
+	 */
+	bool borrow_valid(unsigned index);
+
 	// add item to list of work items to schedule on node update
 	bool register_callback(SubscriptionCallback *callback_sub);
 
@@ -251,6 +307,79 @@ private:
 	 */
 	bool copy_locked(void *dst, unsigned &generation);
 
+	/**
+	 * Number of allocated buffer slots: the queue plus a spare slot for loans.
+	 */
+	unsigned buffer_slots() const { return _queue_size + (_loanable ? 1 : 0); }
+
+	/**
+	 * Allocate the buffer if not done yet. Must not be called from interrupt context.
+	 * @return true if the buffer is allocated
+	 */
+	bool allocate_buffer();
+
+	/**
+	 * Slot of a write that arrived while the spare slot was loaned, after the buffer slots.
+	 */
+	uint8_t *deferred_slot() const { return _data + (_meta->o_size * buffer_slots()); }
+
+	/**
+	 * Mark the start of a write for lock-free readers. Must be called with ATOMIC_ENTER held.
+	 */
+	void begin_write_locked();
+
+	/**
+	 * Make the message in the slot of the current generation visible to subscribers.
+	 * Must be called with ATOMIC_ENTER held.
+	 */
+	void commit_locked();
+
+	/**
+	 * Publish the write deferred by a loan, if any. Must be called with ATOMIC_ENTER held.
+	 * @return true if a message was published
+	 */
+	bool publish_deferred_locked();
+
+	/**
+	 * Loan the spare buffer slot to the publisher.
+	 * @return pointer to the slot, nullptr if loans are not enabled or the slot is already loaned
+	 */
+	void *begin_loan();
+
+	/**
+	 * Publish the loaned slot.
+	 * @return pointer to the published message, nullptr if there is no active loan
+	 */
+	const uint8_t *commit_loan();
+
+	/**
+	 * Discard an active loan without publishing it. A write deferred by the loan is published.
+	 */
+	void cancel_loan();
+
+#ifdef ORB_USE_SEQLOCK
+	/**
+	 * Lock-free variant of copy_locked() for a single writer and multiple readers.
+	 * Readers never block the writer or each other: the copy is validated against
+	 * the sequence counter and retried if a publication raced with it.
+	 *
+	 * @param dst
+	 *   The buffer into which the data is copied.
+	 * @param generation
+	 *   The generation that was copied.
+	 * @param update_time
+	 *   If not null, set to the timestamp of the copied data.
+	 * @param updated
+	 *   Set to the result that copy_locked() would have returned.
+	 * @return bool
+	 *   Returns false if no consistent copy could be made (a write is in
+	 *   progress or too many retries), the caller must then take the lock.
+	 */
+	bool copy_seqlock(void *dst, unsigned &generation, hrt_abstime *update_time, bool &updated);
+
+	static constexpr int SEQLOCK_MAX_RETRIES = 3;
+#endif /* ORB_USE_SEQLOCK */
+
 	struct UpdateIntervalData {
 		uint64_t last_update{0}; /**< time at which the last update was provided, used when update_interval is nonzero */
 		unsigned interval{0}; /**< if nonzero minimum interval between updates */
@@ -268,9 +397,13 @@ private:
 	uint8_t     *_data{nullptr};   /**< allocated object buffer */
 	hrt_abstime   _last_update{0}; /**< time the object was last updated */
 	volatile unsigned   _generation{0};  /**< object generation count */
+	unsigned _seq{0}; /**< seqlock sequence counter, odd while a write is in progress */
 	List<uORB::SubscriptionCallback *>	_callbacks;
 	uint8_t   _priority;  /**< priority of the topic */
 	bool _published{false};  /**< has ever data been published */
+	bool _loanable{false}; /**< has a spare buffer slot to fill in place */
+	bool _loaned{false}; /**< the spare slot is currently loaned to the publisher */
+	bool _write_deferred{false}; /**< a write arrived during the loan and is published after it */
 	uint8_t _queue_size; /**< maximum number of elements in the queue */
 	int8_t _subscriber_count{0};
 
@@ -281,6 +414,9 @@ private:
 	uint32_t _lost_messages = 0; /**< nr of lost messages for all subscribers. If two subscribers lose the same
 					message, it is counted as two. */
 
+	friend class uORB::DeviceMaster;
+	uORB::DeviceNode *_index_next{nullptr}; /**< next node in the same DeviceMaster index bucket */
+
 	inline static SubscriberData    *filp_to_sd(cdev::file_t *filp);
 
 	/**
@@ -168,7 +168,7 @@ int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 }
 
 orb_advert_t uORB::Manager::orb_advertise_multi(const struct orb_metadata *meta, const void *data, int *instance,
-		int priority, unsigned int queue_size)
+		int priority, unsigned int queue_size, bool loanable)
 {
 #ifdef ORB_USE_PUBLISHER_RULES
 
@@ -211,6 +211,11 @@ orb_advert_t uORB::Manager::orb_advertise_multi(const struct orb_metadata *meta,
 		PX4_WARN("orb_advertise_multi: failed to set queue size");
 	}
 
+	if (loanable) {
+		/* This fails if the topic has already been published: the publisher then falls back to copying */
+		px4_ioctl(fd, ORBIOCSETLOANABLE, 1);
+	}
+
 	/* get the advertiser handle and close the node */
 	orb_advert_t advertiser;
 
@@ -280,6 +285,45 @@ int uORB::Manager::orb_publish(const struct orb_metadata *meta, orb_advert_t han
 	return uORB::DeviceNode::publish(meta, handle, data);
 }
 
+void *uORB::Manager::orb_loan(const struct orb_metadata *meta, orb_advert_t handle)
+{
+#ifdef ORB_USE_PUBLISHER_RULES
+
+	if (handle == _Instance) {
+		return nullptr; // the publisher keeps using its own buffer
+	}
+
+#endif /* ORB_USE_PUBLISHER_RULES */
+
+	return uORB::DeviceNode::loan(meta, handle);
+}
+
+int uORB::Manager::orb_publish_loan(const struct orb_metadata *meta, orb_advert_t handle)
+{
+#ifdef ORB_USE_PUBLISHER_RULES
+
+	if (handle == _Instance) {
+		return PX4_OK; //pretend success
+	}
+
+#endif /* ORB_USE_PUBLISHER_RULES */
+
+	return uORB::DeviceNode::publish_loan(meta, handle);
+}
+
+int uORB::Manager::orb_cancel_loan(const struct orb_metadata *meta, orb_advert_t handle)
+{
+#ifdef ORB_USE_PUBLISHER_RULES
+
+	if (handle == _Instance) {
+		return PX4_OK;
+	}
+
+#endif /* ORB_USE_PUBLISHER_RULES */
+
+	return uORB::DeviceNode::cancel_loan(meta, handle);
+}
+
 int uORB::Manager::orb_copy(const struct orb_metadata *meta, int handle, void *buffer)
 {
 	int ret;
@@ -155,6 +155,8 @@ public:
 	 *      and handle different priorities (@see orb_priority()).
 	 * @param queue_size  Maximum number of buffered elements. If this is 1, no queuing is
 	 *      used.
+	 * @param loanable  If true, reserve a spare buffer slot so that the publisher can fill
+	 *      messages in place (@see orb_loan()). This only succeeds for the first advertiser.
 	 * @return    PX4_ERROR on error, otherwise returns a handle
 	 *      that can be used to publish to the topic.
 	 *      If the topic in question is not known (due to an
@@ -162,7 +164,7 @@ public:
 	 *      this function will return -1 and set errno to ENOENT.
 	 */
 	orb_advert_t orb_advertise_multi(const struct orb_metadata *meta, const void *data, int *instance,
-					 int priority, unsigned int queue_size = 1);
+					 int priority, unsigned int queue_size = 1, bool loanable = false);
 
 	/**
 	 * Unadvertise a topic.
@@ -187,6 +189,46 @@ public:
 	 */
 	int  orb_publish(const struct orb_metadata *meta, orb_advert_t handle, const void *data);
 
+	/**
+	 * Loan the buffer slot of the next publication, so that the publisher can fill
+	 * the message in place instead of having it copied by orb_publish().
+	 *
+	 * The topic must have been advertised as loanable, and only a single publisher
+	 * may use loans. The loan must be completed with orb_publish_loan(). Other
+	 * publishers of the topic are not blocked: a message they publish meanwhile
+	 * is published right after the loan.
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+	 *      for the topic.
+	 * @param handle  The handle returned from orb_advertise.
+	 * @return    pointer to the message buffer, nullptr if loans are not available
+	 */
+	void *orb_loan(const struct orb_metadata *meta, orb_advert_t handle);
+
+	/**
+	 * Publish the message previously filled in place via orb_loan().
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+	 *      for the topic.
+	 * @param handle  The handle returned from orb_advertise.
+	 * @return    OK on success, PX4_ERROR otherwise with errno set accordingly.
+	 */
+	int  orb_publish_loan(const struct orb_metadata *meta, orb_advert_t handle);
+
+	/**
+	 * Discard the loan previously obtained via orb_loan() without publishing it.
+	 *
+	 * The handle is shared by all publishers of the topic instance, so orb_unadvertise()
+	 * does not know which publisher holds the loan: the loan holder has to cancel it
+	 * before it unadvertises.
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+	 *      for the topic.
+	 * @param handle  The handle returned from orb_advertise.
+	 * @return    OK on success, PX4_ERROR otherwise.
+	 */
+	int  orb_cancel_loan(const struct orb_metadata *meta, orb_advert_t handle);
+
 	/**
 	 * Subscribe to a topic.
 	 *
@@ -40,6 +40,12 @@
 #include <poll.h>
 #include <math.h>
 #include <lib/cdev/CDev.hpp>
+#include <uORB/PublicationLoan.hpp>
+#include <uORB/Subscription.hpp>
+
+#ifdef __PX4_POSIX
+#include <pthread.h>
+#endif /* __PX4_POSIX */
 
 ORB_DEFINE(orb_test, struct orb_test, sizeof(orb_test), "ORB_TEST:int val;hrt_abstime time;");
 ORB_DEFINE(orb_multitest, struct orb_test, sizeof(orb_test), "ORB_MULTITEST:int val;hrt_abstime time;");
@@ -52,6 +58,8 @@ ORB_DEFINE(orb_test_medium_queue, struct orb_test_medium, sizeof(orb_test_medium
 	   "ORB_TEST_MEDIUM_MULTI:int val;hrt_abstime time;char[64] junk;");
 ORB_DEFINE(orb_test_medium_queue_poll, struct orb_test_medium, sizeof(orb_test_medium),
 	   "ORB_TEST_MEDIUM_MULTI:int val;hrt_abstime time;char[64] junk;");
+ORB_DEFINE(orb_test_medium_loan, struct orb_test_medium, sizeof(orb_test_medium),
+	   "ORB_TEST_MEDIUM_LOAN:int val;hrt_abstime time;char[64] junk;");
 
 ORB_DEFINE(orb_test_large, struct orb_test_large, sizeof(orb_test_large),
 	   "ORB_TEST_LARGE:int val;hrt_abstime time;char[512] junk;");
@@ -224,7 +232,13 @@ int uORBTest::UnitTest::test()
 		return ret;
 	}
 
-	return test_queue_poll_notify();
+	ret = test_queue_poll_notify();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	return test_loan();
 }
 
 int uORBTest::UnitTest::test_unadvertise()
@@ -260,6 +274,126 @@ int uORBTest::UnitTest::test_unadvertise()
 }
 
 
+#ifdef __PX4_POSIX
+void *uORBTest::UnitTest::contention_reader_entry(void *arg)
+{
+	ContentionReader *reader = (ContentionReader *)arg;
+	uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+
+	uORB::Subscription sub{ORB_ID(orb_test_large)};
+	orb_test_large data{};
+
+	while (!t._thread_should_exit) {
+		const hrt_abstime start = hrt_absolute_time();
+		const bool copied = sub.copy(&data);
+		const hrt_abstime elapsed = hrt_absolute_time() - start;
+
+		if (!copied) {
+			continue;
+		}
+
+		reader->num_copies++;
+		reader->total_time += elapsed;
+
+		if (elapsed > reader->max_time) {
+			reader->max_time = elapsed;
+		}
+
+		// the publisher fills the whole message with the value, so a mixed message is a torn read
+		for (unsigned i = 0; i < sizeof(data.junk); i++) {
+			if (data.junk[i] != (char)data.val) {
+				reader->num_torn++;
+				break;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+int uORBTest::UnitTest::contention_test(int num_readers)
+{
+	static constexpr int max_readers = 16;
+	static constexpr unsigned num_publications = 2000;
+
+	if (num_readers < 1 || num_readers > max_readers) {
+		return test_fail("number of readers must be in [1, %i]", max_readers);
+	}
+
+	test_note("---------------- CONTENTION TEST (%i readers) ------------------", num_readers);
+
+	orb_test_large t{};
+	orb_advert_t pfd = orb_advertise(ORB_ID(orb_test_large), &t);
+
+	if (pfd == nullptr) {
+		return test_fail("orb_advertise failed (%i)", errno);
+	}
+
+	ContentionReader readers[max_readers] {};
+	pthread_t threads[max_readers];
+	_thread_should_exit = false;
+
+	for (int i = 0; i < num_readers; i++) {
+		if (pthread_create(&threads[i], nullptr, &contention_reader_entry, &readers[i]) != 0) {
+			_thread_should_exit = true;
+
+			for (int j = 0; j < i; j++) {
+				pthread_join(threads[j], nullptr);
+			}
+
+			orb_unadvertise(pfd);
+			return test_fail("failed launching reader thread");
+		}
+	}
+
+	hrt_abstime publish_time = 0;
+	hrt_abstime publish_time_max = 0;
+
+	for (unsigned i = 0; i < num_publications; i++) {
+		++t.val;
+		t.time = hrt_absolute_time();
+		memset(t.junk, (char)t.val, sizeof(t.junk));
+
+		const hrt_abstime start = hrt_absolute_time();
+		orb_publish(ORB_ID(orb_test_large), pfd, &t);
+		const hrt_abstime elapsed = hrt_absolute_time() - start;
+
+		publish_time += elapsed;
+
+		if (elapsed > publish_time_max) {
+			publish_time_max = elapsed;
+		}
+
+		/* 1 kHz publication rate */
+		px4_usleep(1000);
+	}
+
+	_thread_should_exit = true;
+
+	unsigned num_torn = 0;
+
+	for (int i = 0; i < num_readers; i++) {
+		pthread_join(threads[i], nullptr);
+
+		const ContentionReader &r = readers[i];
+		test_note("reader %i: %u copies, mean %.3f us, max %u us, torn %u", i, r.num_copies,
+			  r.num_copies > 0 ? (double)r.total_time / r.num_copies : 0., (unsigned)r.max_time, r.num_torn);
+		num_torn += r.num_torn;
+	}
+
+	test_note("publisher: %u publications, mean %.3f us, max %u us", num_publications,
+		  (double)publish_time / num_publications, (unsigned)publish_time_max);
+
+	orb_unadvertise(pfd);
+
+	if (num_torn > 0) {
+		return test_fail("%u torn reads", num_torn);
+	}
+
+	return test_note("PASS contention test");
+}
+#endif /* __PX4_POSIX */
+
 int uORBTest::UnitTest::info()
 {
 	return OK;
@@ -844,6 +978,119 @@ int uORBTest::UnitTest::test_queue_poll_notify()
 }
 
 
+int uORBTest::UnitTest::test_loan()
+{
+	test_note("Testing loaned publications");
+
+	uORB::PublicationLoan<orb_test_medium> pub{ORB_ID(orb_test_medium_loan)};
+	uORB::Subscription sub{ORB_ID(orb_test_medium_loan)};
+
+	// the first publication advertises the topic from the embedded buffer
+	orb_test_medium &first = pub.loan();
+	first.val = 0;
+	first.time = hrt_absolute_time();
+
+	if (!pub.publish()) {
+		return test_fail("advertise failed");
+	}
+
+	orb_test_medium data{};
+
+	for (int i = 1; i < 10; ++i) {
+		orb_test_medium &msg = pub.loan();
+
+		if (&msg == &first) {
+			return test_fail("got no loan from the topic buffer");
+		}
+
+		msg.val = i;
+		msg.time = hrt_absolute_time();
+
+		if (!pub.publish()) {
+			return test_fail("publish of loan %i failed", i);
+		}
+
+		// copy() keeps working for subscribers that do not borrow
+		if (!sub.update(&data) || data.val != i) {
+			return test_fail("copy mismatch (%i != %i)", data.val, i);
+		}
+	}
+
+	test_note("  publishing during a loan");
+
+	// a second publisher of the same instance is not blocked by the loan
+	orb_advert_t other = orb_advertise(ORB_ID(orb_test_medium_loan), &data);
+
+	if (other == nullptr) {
+		return test_fail("advertise of second publisher failed");
+	}
+
+	sub.update(&data);
+
+	orb_test_medium &loaned = pub.loan();
+	loaned.val = 100;
+
+	data.val = 101;
+
+	if (orb_publish(ORB_ID(orb_test_medium_loan), other, &data) != PX4_OK) {
+		return test_fail("publish during a loan failed");
+	}
+
+	if (sub.updated()) {
+		return test_fail("loan visible before it is published");
+	}
+
+	pub.publish();
+
+	// the loan is published first, then the deferred message
+	if (!sub.update(&data) || data.val != 101) {
+		return test_fail("deferred publication mismatch (%i != 101)", data.val);
+	}
+
+	test_note("  borrowing views");
+
+	orb_test_medium &msg = pub.loan();
+	msg.val = 10;
+	pub.publish();
+
+	const orb_test_medium *view = (const orb_test_medium *)sub.borrow();
+
+	if (view == nullptr || view->val != 10) {
+		return test_fail("borrow mismatch");
+	}
+
+	if (!sub.release()) {
+		return test_fail("view invalid without new publication");
+	}
+
+	// with queue size 1 there are two buffer slots: the second publication reuses the slot of the view
+	view = (const orb_test_medium *)sub.borrow();
+
+	for (int i = 11; i < 13; ++i) {
+		orb_test_medium &next = pub.loan();
+		next.val = i;
+		pub.publish();
+	}
+
+	if (sub.release()) {
+		return test_fail("overwritten view reported as valid");
+	}
+
+	test_note("  unadvertising another publisher during a loan");
+
+	orb_test_medium &kept = pub.loan();
+	kept.val = 200;
+
+	// the loan belongs to pub, the other publisher leaving must not discard it
+	orb_unadvertise(other);
+
+	if (!pub.publish() || !sub.update(&data) || data.val != 200) {
+		return test_fail("loan discarded by another publisher (%i != 200)", data.val);
+	}
+
+	return test_note("PASS loaned publications");
+}
+
 int uORBTest::UnitTest::test_fail(const char *fmt, ...)
 {
 	va_list ap;
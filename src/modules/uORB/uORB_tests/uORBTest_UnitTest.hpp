@@ -56,6 +56,7 @@ ORB_DECLARE(orb_test_medium);
 ORB_DECLARE(orb_test_medium_multi);
 ORB_DECLARE(orb_test_medium_queue);
 ORB_DECLARE(orb_test_medium_queue_poll);
+ORB_DECLARE(orb_test_medium_loan);
 
 struct orb_test_large {
 	int val;
@@ -81,6 +82,14 @@ public:
 	template<typename S> int latency_test(orb_id_t T, bool print);
 	int info();
 
+#ifdef __PX4_POSIX
+	/**
+	 * Copy contention benchmark: num_readers threads continuously copy a large
+	 * topic that is published at 1 kHz, and report the per-copy cost.
+	 */
+	int contention_test(int num_readers);
+#endif /* __PX4_POSIX */
+
 private:
 	UnitTest() : pubsubtest_passed(false), pubsubtest_print(false) {}
 
@@ -115,8 +124,22 @@ private:
 	static int pub_test_queue_entry(int argc, char *argv[]);
 	int pub_test_queue_main();
 	int test_queue_poll_notify();
+
+	/* in-place publication and borrowed subscription views */
+	int test_loan();
 	volatile int _num_messages_sent = 0;
 
+#ifdef __PX4_POSIX
+	struct ContentionReader {
+		unsigned num_copies{0};
+		unsigned num_torn{0};
+		hrt_abstime total_time{0};
+		hrt_abstime max_time{0};
+	};
+
+	static void *contention_reader_entry(void *arg);
+#endif /* __PX4_POSIX */
+
 	int test_fail(const char *fmt, ...);
 	int test_note(const char *fmt, ...);
 };
@@ -44,7 +44,7 @@ extern "C" { __EXPORT int uorb_tests_main(int argc, char *argv[]); }
 
 static void usage()
 {
-	PX4_INFO("Usage: uorb_tests [latency_test]");
+	PX4_INFO("Usage: uorb_tests [latency_test|contention_test [num_readers]]");
 }
 
 int
@@ -90,6 +90,24 @@ uorb_tests_main(int argc, char *argv[])
 		}
 	}
 
+#ifdef __PX4_POSIX
+
+	/*
+	 * Test copy contention between readers and a 1 kHz publisher.
+	 */
+	if (argc > 1 && !strcmp(argv[1], "contention_test")) {
+
+		uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
+		int num_readers = 4;
+
+		if (argc > 2) {
+			num_readers = atoi(argv[2]);
+		}
+
+		return t.contention_test(num_readers);
+	}
+
+#endif /* __PX4_POSIX */
 #endif
 
 	usage();
@@ -163,7 +163,7 @@ public:
 	 */
 	inline bool compare_exchange(T *expected, T num)
 	{
-		return __atomic_compare_exchange(&_value, expected, num, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+		return __atomic_compare_exchange_n(&_value, expected, num, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
 	}
 
 private:
@@ -75,6 +75,7 @@ protected:
 	/**
 	 * @brief Call this method whenever the module gets a parameter change notification.
 	 *        It will automatically call updateParams() for all children, which then call updateParamsImpl().
+	 *        The parameters of a class are only reloaded if at least one of them changed since the last update.
 	 */
 	virtual void updateParams()
 	{
@@ -82,7 +83,34 @@ protected:
 			child->updateParams();
 		}
 
-		updateParamsImpl();
+		// get the sequence before reading, so that a concurrent change is picked up with the next update
+		const uint32_t seq = param_change_seq();
+
+		if (seq != _params_seq && paramsChangedSinceImpl(_params_seq)) {
+			updateParamsImpl();
+		}
+
+		_params_seq = seq;
+	}
+
+	/**
+	 * @brief Check if a parameter of this class or of one of its children changed since the last updateParams().
+	 *        The parameter_update topic is published for any parameter change: use this to filter the
+	 *        notifications, so that nothing needs to be done if the module's parameters were not touched.
+	 */
+	bool parametersChanged() const
+	{
+		if (param_change_seq() == _params_seq) {
+			return false;
+		}
+
+		for (auto child = _children.getHead(); child != nullptr; child = child->getSibling()) {
+			if (child->parametersChanged()) {
+				return true;
+			}
+		}
+
+		return paramsChangedSinceImpl(_params_seq);
 	}
 
 	/**
@@ -90,7 +118,16 @@ protected:
 	 */
 	virtual void updateParamsImpl() {}
 
+	/**
+	 * @brief Check if a parameter of this class changed after the change sequence seq.
+	 *        The implementation for this is generated with the macro DEFINE_PARAMETERS()
+	 */
+	virtual bool paramsChangedSinceImpl(uint32_t seq) const { return false; }
+
 private:
 	/** @list _children The module parameter list of inheriting classes. */
 	List<ModuleParams *> _children;
+
+	/** parameter change sequence of the last update (@see param_change_seq()) */
+	uint32_t _params_seq{param_change_seq()};
 };
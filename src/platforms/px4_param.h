@@ -60,13 +60,19 @@ inline static param_t param_handle(px4::params p)
 #define _CALL_UPDATE(x) \
 	STRIP(x).update();
 
-// define the parameter update method, which will update all parameters.
-// It is marked as 'final', so that wrong usages lead to a compile error (see below)
+#define _CALL_CHANGED_SINCE(x) \
+	param_changed_since(STRIP(x).handle(), seq) ||
+
+// define the parameter update method, which will update all parameters, and the method to check if any of them
+// changed. They are marked as 'final', so that wrong usages lead to a compile error (see below)
 #define _DEFINE_PARAMETER_UPDATE_METHOD(...) \
 	protected: \
 	void updateParamsImpl() final { \
 		APPLY_ALL(_CALL_UPDATE, __VA_ARGS__) \
 	} \
+	bool paramsChangedSinceImpl(uint32_t seq) const final { \
+		return APPLY_ALL(_CALL_CHANGED_SINCE, __VA_ARGS__) false; \
+	} \
 	private:
 
 // Define a list of parameters. This macro also creates code to update parameters.
@@ -86,6 +92,9 @@ inline static param_t param_handle(px4::params p)
 		parent_class::updateParamsImpl(); \
 		APPLY_ALL(_CALL_UPDATE, __VA_ARGS__) \
 	} \
+	bool paramsChangedSinceImpl(uint32_t seq) const override { \
+		return parent_class::paramsChangedSinceImpl(seq) || APPLY_ALL(_CALL_CHANGED_SINCE, __VA_ARGS__) false; \
+	} \
 	private:
 
 #define DEFINE_PARAMETERS_CUSTOM_PARENT(parent_class, ...) \
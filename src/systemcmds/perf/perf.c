@@ -46,11 +46,13 @@ __EXPORT int perf_main(int argc, char *argv[]);
 
 static void print_usage(void)
 {
-	PRINT_MODULE_DESCRIPTION("Tool to print performance counters");
+	PRINT_MODULE_DESCRIPTION("Tool to print performance counters. Elapsed time and interval counters with histogram also print latency percentiles.");
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("perf", "command");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Reset all counters");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("latency", "Print HRT timer latency histogram");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("hist", "Enable the latency histogram of elapsed time and interval counters");
+	PRINT_MODULE_USAGE_ARG("<name>", "Only counters whose name contains <name>", true);
 
 	PRINT_MODULE_USAGE_PARAM_COMMENT("Prints all performance counters if no arguments given");
 }
@@ -67,6 +69,11 @@ int perf_main(int argc, char *argv[])
 			perf_print_latency(1 /* stdout */);
 			fflush(stdout);
 			return 0;
+
+		} else if (strcmp(argv[1], "hist") == 0) {
+			int num_enabled = perf_histogram_enable_all(argc > 2 ? argv[2] : NULL);
+			PX4_INFO("histogram enabled for %i counters", num_enabled);
+			return 0;
 		}
 
 		print_usage();
@@ -39,6 +39,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -49,17 +51,38 @@
 
 #include <drivers/drv_hrt.h>
 
+/** write strategies, matching the logger's SDLOG_WR_MODE */
+enum write_strategy {
+	STRATEGY_STREAM = 0, ///< plain writes, fsync at the end of a run (or after each block with -s)
+	STRATEGY_ALIGNED,    ///< preallocated file, fdatasync once per second
+	STRATEGY_DIRECT,     ///< like aligned, with O_DIRECT (Linux only)
+
+	STRATEGY_COUNT
+};
+
+static const char *strategy_names[STRATEGY_COUNT] = {"stream", "aligned", "direct"};
+
 static void	usage(void);
 
 /** sequential write speed test */
-static void	write_test(int fd, uint8_t *block, int block_size);
+static void	write_test(int fd, uint8_t *block, int block_size, enum write_strategy strategy);
+
+/** open the benchmark file for a strategy, -1 on error */
+static int	open_bench_file(enum write_strategy strategy);
+
+/**
+ * Reserve file space (Linux only).
+ * @return number of bytes reserved from offset on, 0 if not supported
+ */
+static size_t	preallocate(int fd, size_t offset, size_t size);
 
 /**
  * Measure the time for fsync.
  * @param fd
+ * @param data_only use fdatasync instead of fsync (if available)
  * @return time in ms
  */
-static inline unsigned int time_fsync(int fd);
+static inline unsigned int time_fsync(int fd, bool data_only);
 
 __EXPORT int	sd_bench_main(int argc, char *argv[]);
 
@@ -69,22 +92,34 @@ static int num_runs; ///< number of runs
 static int run_duration; ///< duration of a single run [ms]
 static bool synchronized; ///< call fsync after each block?
 
+static const size_t PREALLOCATE_SIZE = 16 * 1024 * 1024; ///< file reservation step, same as the logger
+static const int ALIGNMENT = 4096; ///< block size & memory alignment for O_DIRECT
+
 static void
 usage()
 {
-	PRINT_MODULE_DESCRIPTION("Test the speed of an SD Card");
+	PRINT_MODULE_DESCRIPTION("Test the speed of an SD Card.\n"
+				 "\n"
+				 "The write strategies correspond to the logger's SDLOG_WR_MODE:\n"
+				 "- stream: plain writes, fsync at the end of each run (or after each block with -s)\n"
+				 "- aligned: preallocated file (Linux), fdatasync once per second\n"
+				 "- direct: like aligned, but with O_DIRECT (Linux only)\n");
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("sd_bench", "command");
 	PRINT_MODULE_USAGE_PARAM_INT('b', 4096, 1, 1000000, "Block size for each read/write", true);
 	PRINT_MODULE_USAGE_PARAM_INT('r', 5, 1, 1000, "Number of runs", true);
 	PRINT_MODULE_USAGE_PARAM_INT('d', 2000, 1, 100000, "Duration of a run in ms", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('s', "Call fsync after each block (default=at end of each run)", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('m', "stream", "stream|aligned|direct|all",
+					"Write strategy, 'all' runs all of them for comparison", true);
 }
 
 int
 sd_bench_main(int argc, char *argv[])
 {
 	int block_size = 4096;
+	int first_strategy = STRATEGY_STREAM;
+	int last_strategy = STRATEGY_STREAM;
 	int myoptind = 1;
 	int ch;
 	const char *myoptarg = NULL;
@@ -92,7 +127,7 @@ sd_bench_main(int argc, char *argv[])
 	num_runs = 5;
 	run_duration = 2000;
 
-	while ((ch = px4_getopt(argc, argv, "b:r:d:s", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "b:r:d:sm:", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'b':
 			block_size = strtol(myoptarg, NULL, 0);
@@ -110,6 +145,28 @@ sd_bench_main(int argc, char *argv[])
 			synchronized = true;
 			break;
 
+		case 'm':
+			if (strcmp(myoptarg, "all") == 0) {
+				first_strategy = STRATEGY_STREAM;
+				last_strategy = STRATEGY_COUNT - 1;
+
+			} else {
+				first_strategy = -1;
+
+				for (int i = 0; i < STRATEGY_COUNT; ++i) {
+					if (strcmp(myoptarg, strategy_names[i]) == 0) {
+						first_strategy = last_strategy = i;
+					}
+				}
+
+				if (first_strategy < 0) {
+					usage();
+					return -1;
+				}
+			}
+
+			break;
+
 		default:
 			usage();
 			return -1;
@@ -122,58 +179,134 @@ sd_bench_main(int argc, char *argv[])
 		return -1;
 	}
 
-	int bench_fd = open(BENCHMARK_FILE, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
-
-	if (bench_fd < 0) {
-		PX4_ERR("Can't open benchmark file %s", BENCHMARK_FILE);
+	if (last_strategy != STRATEGY_STREAM && block_size % ALIGNMENT != 0) {
+		PX4_ERR("block size must be a multiple of %i for aligned writes", ALIGNMENT);
 		return -1;
 	}
 
-	//create some data block
-	uint8_t *block = (uint8_t *)malloc(block_size);
+	//create some data block (aligned, as needed for O_DIRECT)
+	uint8_t *block_alloc = (uint8_t *)malloc(block_size + ALIGNMENT - 1);
 
-	if (!block) {
+	if (!block_alloc) {
 		PX4_ERR("Failed to allocate memory block");
-		close(bench_fd);
 		return -1;
 	}
 
+	uint8_t *block = (uint8_t *)(((uintptr_t)block_alloc + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1));
+
 	for (int i = 0; i < block_size; ++i) {
 		block[i] = (uint8_t)i;
 	}
 
-	PX4_INFO("Using block size = %i bytes, sync=%i", block_size, (int)synchronized);
-	write_test(bench_fd, block, block_size);
+	int ret = 0;
+
+	for (int strategy = first_strategy; strategy <= last_strategy; ++strategy) {
+		int bench_fd = open_bench_file((enum write_strategy)strategy);
+
+		if (bench_fd < 0) {
+			PX4_ERR("Can't open benchmark file %s", BENCHMARK_FILE);
+			ret = -1;
+			break;
+		}
+
+		PX4_INFO("Using block size = %i bytes, sync=%i, strategy=%s", block_size, (int)synchronized,
+			 strategy_names[strategy]);
+		write_test(bench_fd, block, block_size, (enum write_strategy)strategy);
+
+		close(bench_fd);
+		unlink(BENCHMARK_FILE);
+	}
+
+	free(block_alloc);
 
-	free(block);
-	close(bench_fd);
-	unlink(BENCHMARK_FILE);
+	return ret;
+}
+
+int open_bench_file(enum write_strategy strategy)
+{
+	int flags = O_CREAT | O_WRONLY | O_TRUNC;
+
+	if (strategy == STRATEGY_DIRECT) {
+#if defined(__PX4_LINUX)
+		int fd = open(BENCHMARK_FILE, flags | O_DIRECT, PX4_O_MODE_666);
+
+		if (fd >= 0) {
+			return fd;
+		}
+
+		PX4_WARN("O_DIRECT not supported (%i), using aligned writes", errno);
+#else
+		PX4_WARN("O_DIRECT not supported, using aligned writes");
+#endif /* __PX4_LINUX */
+	}
+
+	return open(BENCHMARK_FILE, flags, PX4_O_MODE_666);
+}
+
+size_t preallocate(int fd, size_t offset, size_t size)
+{
+#if defined(__PX4_LINUX)
+
+	if (fallocate(fd, FALLOC_FL_KEEP_SIZE, offset, size) == 0) {
+		return size;
+	}
+
+#endif /* __PX4_LINUX */
 
 	return 0;
 }
 
-unsigned int time_fsync(int fd)
+unsigned int time_fsync(int fd, bool data_only)
 {
 	hrt_abstime fsync_start = hrt_absolute_time();
+#if defined(__PX4_NUTTX) || defined(__PX4_DARWIN)
+	// no fdatasync()
 	fsync(fd);
+#else
+
+	if (data_only) {
+		fdatasync(fd);
+
+	} else {
+		fsync(fd);
+	}
+
+#endif /* __PX4_NUTTX || __PX4_DARWIN */
 	return hrt_elapsed_time(&fsync_start) / 1000;
 }
 
-void write_test(int fd, uint8_t *block, int block_size)
+void write_test(int fd, uint8_t *block, int block_size, enum write_strategy strategy)
 {
 	PX4_INFO("");
 	PX4_INFO("Testing Sequential Write Speed...");
 	double total_elapsed = 0.;
 	unsigned int total_blocks = 0;
+	const bool aligned = strategy != STRATEGY_STREAM;
+	size_t file_size = 0;
+	size_t preallocated = 0;
+
+	if (aligned) {
+		preallocated = preallocate(fd, 0, PREALLOCATE_SIZE);
+
+		if (preallocated == 0) {
+			PX4_WARN("file preallocation not supported");
+		}
+	}
 
 	for (int run = 0; run < num_runs; ++run) {
 		hrt_abstime start = hrt_absolute_time();
+		hrt_abstime last_sync = start;
 		unsigned int num_blocks = 0;
 		unsigned int max_write_time = 0;
 		unsigned int fsync_time = 0;
+		unsigned int max_fsync_time = 0;
 
 		while ((int64_t)hrt_elapsed_time(&start) < run_duration * 1000) {
 
+			if (preallocated > 0 && file_size + block_size > preallocated) {
+				preallocated += preallocate(fd, preallocated, PREALLOCATE_SIZE);
+			}
+
 			hrt_abstime write_start = hrt_absolute_time();
 			size_t written = write(fd, block, block_size);
 			unsigned int write_time = hrt_elapsed_time(&write_start) / 1000;
@@ -187,8 +320,17 @@ void write_test(int fd, uint8_t *block, int block_size)
 				return;
 			}
 
-			if (synchronized) {
-				fsync_time += time_fsync(fd);
+			file_size += written;
+
+			if (synchronized || (aligned && hrt_elapsed_time(&last_sync) > 1000000)) {
+				unsigned int t = time_fsync(fd, aligned);
+				fsync_time += t;
+
+				if (t > max_fsync_time) {
+					max_fsync_time = t;
+				}
+
+				last_sync = hrt_absolute_time();
 			}
 
 			++num_blocks;
@@ -197,13 +339,13 @@ void write_test(int fd, uint8_t *block, int block_size)
 		//Note: if testing a slow device (SD Card) and the OS buffers a lot (eg. Linux),
 		//fsync can take really long, and it looks like the process hangs. But it does
 		//not and the reported result will still be correct.
-		fsync_time += time_fsync(fd);
+		fsync_time += time_fsync(fd, aligned);
 
 		//report
 		double elapsed = hrt_elapsed_time(&start) / 1.e6;
-		PX4_INFO("  Run %2i: %8.2lf KB/s, max write time: %i ms (=%7.2lf KB/s), fsync: %i ms", run,
+		PX4_INFO("  Run %2i: %8.2lf KB/s, max write time: %i ms (=%7.2lf KB/s), fsync: %i ms (max %i ms)", run,
 			 (double)block_size * num_blocks / elapsed / 1024.,
-			 max_write_time, (double)block_size / max_write_time * 1000. / 1024., fsync_time);
+			 max_write_time, (double)block_size / max_write_time * 1000. / 1024., fsync_time, max_fsync_time);
 
 		total_elapsed += elapsed;
 		total_blocks += num_blocks;
@@ -156,6 +156,96 @@ fail:
 	return -1;
 }
 
+#define NUM_RANGE_TEST_ITEMS (DM_KEY_WAYPOINTS_OFFBOARD_1_MAX < 1000 ? DM_KEY_WAYPOINTS_OFFBOARD_1_MAX : 1000)
+#define RANGE_TEST_BLOCK_SIZE 16
+
+/* write & read a mission with single item requests and range requests, and compare the timing */
+static int
+test_range(void)
+{
+	struct mission_item_s items[RANGE_TEST_BLOCK_SIZE];
+	struct mission_item_s item;
+
+	hrt_abstime start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < NUM_RANGE_TEST_ITEMS; i++) {
+		memset(&item, 0, sizeof(item));
+		item.do_jump_repeat_count = i;
+
+		if (dm_write(DM_KEY_WAYPOINTS_OFFBOARD_1, i, DM_PERSIST_IN_FLIGHT_RESET, &item, sizeof(item)) != sizeof(item)) {
+			PX4_ERR("write failed, index %d", i);
+			return -1;
+		}
+	}
+
+	dm_flush();
+	hrt_abstime write_single = hrt_elapsed_time(&start);
+
+	start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < NUM_RANGE_TEST_ITEMS; i++) {
+		if (dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, i, &item, sizeof(item)) != sizeof(item) || item.do_jump_repeat_count != i) {
+			PX4_ERR("read failed, index %d", i);
+			return -1;
+		}
+	}
+
+	hrt_abstime read_single = hrt_elapsed_time(&start);
+
+	start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < NUM_RANGE_TEST_ITEMS; i += RANGE_TEST_BLOCK_SIZE) {
+		unsigned count = NUM_RANGE_TEST_ITEMS - i < RANGE_TEST_BLOCK_SIZE ? NUM_RANGE_TEST_ITEMS - i : RANGE_TEST_BLOCK_SIZE;
+		memset(items, 0, sizeof(items));
+
+		for (unsigned k = 0; k < count; k++) {
+			items[k].do_jump_repeat_count = i + k;
+		}
+
+		if (dm_write_range(DM_KEY_WAYPOINTS_OFFBOARD_1, i, DM_PERSIST_IN_FLIGHT_RESET, items, sizeof(items[0]),
+				   count) != (ssize_t)count) {
+			PX4_ERR("range write failed, index %d", i);
+			return -1;
+		}
+	}
+
+	dm_flush();
+	hrt_abstime write_range = hrt_elapsed_time(&start);
+
+	start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < NUM_RANGE_TEST_ITEMS; i += RANGE_TEST_BLOCK_SIZE) {
+		unsigned count = NUM_RANGE_TEST_ITEMS - i < RANGE_TEST_BLOCK_SIZE ? NUM_RANGE_TEST_ITEMS - i : RANGE_TEST_BLOCK_SIZE;
+
+		if (dm_read_range(DM_KEY_WAYPOINTS_OFFBOARD_1, i, items, sizeof(items[0]), count) != (ssize_t)count) {
+			PX4_ERR("range read failed, index %d", i);
+			return -1;
+		}
+
+		for (unsigned k = 0; k < count; k++) {
+			if (items[k].do_jump_repeat_count != i + k) {
+				PX4_ERR("range read data verification failed, index %d", i + k);
+				return -1;
+			}
+		}
+	}
+
+	hrt_abstime read_range = hrt_elapsed_time(&start);
+
+	/* the range must stop at the first empty item */
+	if (dm_clear(DM_KEY_WAYPOINTS_ONBOARD) != 0 ||
+	    dm_write(DM_KEY_WAYPOINTS_ONBOARD, 0, DM_PERSIST_IN_FLIGHT_RESET, &item, sizeof(item)) != sizeof(item) ||
+	    dm_read_range(DM_KEY_WAYPOINTS_ONBOARD, 0, items, sizeof(items[0]), 2) != 1) {
+		PX4_ERR("range read of empty items failed");
+		return -1;
+	}
+
+	PX4_INFO("%d items: write %" PRIu64 "us (range %" PRIu64 "us), read %" PRIu64 "us (range %" PRIu64 "us)",
+		 NUM_RANGE_TEST_ITEMS, write_single, write_range, read_single, read_range);
+
+	return 0;
+}
+
 int test_dataman(int argc, char *argv[])
 {
 	int i = 0;
@@ -210,6 +300,10 @@ int test_dataman(int argc, char *argv[])
 		return -1;
 	}
 
+	if (test_range() != 0) {
+		return -1;
+	}
+
 	dm_restart(DM_INIT_REASON_IN_FLIGHT);
 
 	for (i = 0; i < NUM_MISSIONS_TEST; i++) {
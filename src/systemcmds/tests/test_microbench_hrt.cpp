@@ -93,6 +93,7 @@ public:
 private:
 
 	bool time_px4_hrt();
+	bool time_px4_hrt_callouts();
 
 	void reset();
 
@@ -117,6 +118,7 @@ private:
 bool MicroBenchHRT::run_tests()
 {
 	ut_run_test(time_px4_hrt);
+	ut_run_test(time_px4_hrt_callouts);
 
 	return (_tests_failed == 0);
 }
@@ -147,4 +149,72 @@ bool MicroBenchHRT::time_px4_hrt()
 	return true;
 }
 
+struct PeriodicCallout {
+	hrt_call call;
+	hrt_abstime first;
+	hrt_abstime interval;
+	unsigned runs;
+	perf_counter_t jitter;
+};
+
+static void periodic_callout(void *arg)
+{
+	PeriodicCallout *c = static_cast<PeriodicCallout *>(arg);
+
+	// periodic calls are timed between scheduled (not actual) call times
+	const hrt_abstime expected = c->first + c->runs * c->interval;
+	perf_set_elapsed(c->jitter, hrt_absolute_time() - expected);
+	c->runs++;
+}
+
+bool MicroBenchHRT::time_px4_hrt_callouts()
+{
+	static constexpr unsigned NUM_CALLOUTS = 200;
+
+	PeriodicCallout *callouts = new PeriodicCallout[NUM_CALLOUTS];
+
+	if (callouts == nullptr) {
+		PX4_ERR("alloc failed");
+		return false;
+	}
+
+	perf_counter_t jitter = perf_alloc(PC_ELAPSED, "hrt_call_every() jitter (200 callouts)");
+
+	// 1 - 10 ms intervals with staggered start
+	const hrt_abstime now = hrt_absolute_time();
+
+	for (unsigned i = 0; i < NUM_CALLOUTS; i++) {
+		PeriodicCallout &c = callouts[i];
+		hrt_call_init(&c.call);
+		c.interval = 1000 + (i % 10) * 1000;
+		c.first = now + 1000 + (i * 37) % c.interval;
+		c.runs = 0;
+		c.jitter = jitter;
+		hrt_call_every(&c.call, c.first - now, c.interval, periodic_callout, &c);
+	}
+
+	// cost of entering and cancelling a callout with all the others queued
+	hrt_call extra{};
+	PERF("hrt_call_after() + hrt_cancel() (200 queued)", hrt_call_after(&extra, 1000000, nullptr, nullptr);
+	     hrt_cancel(&extra), 1000);
+
+	px4_usleep(2000000);
+
+	unsigned total_runs = 0;
+
+	for (unsigned i = 0; i < NUM_CALLOUTS; i++) {
+		hrt_cancel(&callouts[i].call);
+		total_runs += callouts[i].runs;
+	}
+
+	perf_print_counter(jitter);
+	perf_free(jitter);
+	delete[] callouts;
+
+	// 2 s are 200 periods of the slowest callout
+	ut_assert("callouts did not run", total_runs > NUM_CALLOUTS * 100);
+
+	return true;
+}
+
 } // namespace MicroBenchHRT
@@ -48,6 +48,7 @@
 #include <px4_micro_hal.h>
 
 #include <uORB/Subscription.hpp>
+#include <uORB/uORBTopics.h>
 #include <uORB/topics/sensor_accel.h>
 #include <uORB/topics/sensor_gyro.h>
 #include <uORB/topics/vehicle_local_position.h>
@@ -100,6 +101,7 @@ private:
 
 	bool time_px4_uorb();
 	bool time_px4_uorb_direct();
+	bool time_px4_uorb_lookup();
 
 	void reset();
 
@@ -112,6 +114,7 @@ bool MicroBenchORB::run_tests()
 {
 	ut_run_test(time_px4_uorb);
 	ut_run_test(time_px4_uorb_direct);
+	ut_run_test(time_px4_uorb_lookup);
 
 	return (_tests_failed == 0);
 }
@@ -205,4 +208,41 @@ bool MicroBenchORB::time_px4_uorb_direct()
 	return true;
 }
 
+bool MicroBenchORB::time_px4_uorb_lookup()
+{
+	// Lookup cost as a function of the number of topics known to the DeviceMaster.
+	// Subscribing creates a (not yet published) node, so step through the topic list
+	// and time lookups of an existing and a missing node at each size.
+	const orb_metadata *const *topics = orb_get_topics();
+	const size_t num_topics = orb_topics_count();
+	const size_t step = 32;
+
+	int fds[step];
+	int ret = 0;
+
+	for (size_t first = 0; first < num_topics; first += step) {
+		const size_t last = (first + step < num_topics) ? first + step : num_topics;
+
+		for (size_t i = first; i < last; i++) {
+			fds[i - first] = orb_subscribe(topics[i]);
+		}
+
+		char name_hit[48];
+		char name_miss[48];
+		snprintf(name_hit, sizeof(name_hit), "orb_exists %u topics hit", (unsigned)last);
+		snprintf(name_miss, sizeof(name_miss), "orb_exists %u topics miss", (unsigned)last);
+
+		PERF(name_hit, ret = orb_exists(topics[last - 1], 0), 1000);
+		PERF(name_miss, ret = orb_exists(topics[last - 1], ORB_MULTI_MAX_INSTANCES - 1), 1000);
+
+		for (size_t i = first; i < last; i++) {
+			if (fds[i - first] >= 0) {
+				orb_unsubscribe(fds[i - first]);
+			}
+		}
+	}
+
+	return true;
+}
+
 } // namespace MicroBenchORB
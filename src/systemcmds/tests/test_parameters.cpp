@@ -38,7 +38,11 @@
 
 #include <unit_test.h>
 
+#include <drivers/drv_hrt.h>
+#include <px4_atomic.h>
 #include <px4_defines.h>
+#include <px4_sem.h>
+#include <px4_tasks.h>
 
 #include <errno.h>
 #include <fcntl.h>
@@ -80,10 +84,15 @@ private:
 	bool ResetAllExcludesBoundaryCheck();
 	bool ResetAllExcludesWildcard();
 	bool exportImport();
+	bool getSetConcurrent();
 
 	// tests on system parameters
 	// WARNING, can potentially trash your system
 	bool exportImportAll();
+	bool saveJournal();
+
+	bool _set_first_parameters(int num, int32_t offset);
+	bool _check_first_parameters(int num, int32_t offset);
 };
 
 bool ParameterTest::_assert_parameter_int_value(param_t param, int32_t expected)
@@ -349,6 +358,101 @@ bool ParameterTest::exportImport()
 	return ret;
 }
 
+/* state shared with the reader tasks of getSetConcurrent() */
+static constexpr int CONCURRENT_NUM_READERS = 3;
+static constexpr int CONCURRENT_NUM_GETS = 100000;
+static param_t concurrent_param{PARAM_INVALID};
+static px4::atomic_int concurrent_readers_running{0};
+static px4::atomic_int concurrent_bad_values{0};
+static px4_sem_t concurrent_done_sem;
+static hrt_abstime concurrent_get_time[CONCURRENT_NUM_READERS];
+
+static int concurrent_reader_main(int argc, char *argv[])
+{
+	const int reader = atoi(argv[1]);
+	const hrt_abstime start = hrt_absolute_time();
+
+	for (int i = 0; i < CONCURRENT_NUM_GETS; i++) {
+		int32_t value = 0;
+
+		// the writer only sets 1 and 2
+		if (param_get(concurrent_param, &value) != PX4_OK || (value != 1 && value != 2)) {
+			concurrent_bad_values.fetch_add(1);
+		}
+	}
+
+	concurrent_get_time[reader] = hrt_elapsed_time(&start);
+	concurrent_readers_running.fetch_sub(1);
+	px4_sem_post(&concurrent_done_sem);
+	return 0;
+}
+
+bool ParameterTest::getSetConcurrent()
+{
+	concurrent_param = p2;
+	int32_t value = 1;
+	param_set_no_notification(concurrent_param, &value);
+
+	// single-threaded reference
+	hrt_abstime start = hrt_absolute_time();
+
+	for (int i = 0; i < CONCURRENT_NUM_GETS; i++) {
+		param_get(concurrent_param, &value);
+	}
+
+	const hrt_abstime single_get_time = hrt_elapsed_time(&start);
+
+	concurrent_bad_values.store(0);
+	concurrent_readers_running.store(CONCURRENT_NUM_READERS);
+	px4_sem_init(&concurrent_done_sem, 0, 0);
+	px4_sem_setprotocol(&concurrent_done_sem, SEM_PRIO_NONE);
+
+	for (int i = 0; i < CONCURRENT_NUM_READERS; i++) {
+		char reader[4];
+		snprintf(reader, sizeof(reader), "%d", i);
+		char *const argv[] = {reader, nullptr};
+
+		if (px4_task_spawn_cmd("param_reader", SCHED_DEFAULT, SCHED_PRIORITY_DEFAULT, 2000, concurrent_reader_main,
+				       argv) < 0) {
+			concurrent_readers_running.fetch_sub(1);
+			px4_sem_post(&concurrent_done_sem);
+			ut_assert("task start failed", false);
+		}
+	}
+
+	// toggle the value while the readers are running
+	int num_sets = 0;
+
+	while (concurrent_readers_running.load() > 0) {
+		value = (num_sets++ % 2) + 1;
+		param_set_no_notification(concurrent_param, &value);
+		px4_usleep(10); // let the readers run on single core systems
+	}
+
+	for (int i = 0; i < CONCURRENT_NUM_READERS; i++) {
+		px4_sem_wait(&concurrent_done_sem);
+	}
+
+	px4_sem_destroy(&concurrent_done_sem);
+
+	hrt_abstime concurrent_get_time_sum = 0;
+
+	for (int i = 0; i < CONCURRENT_NUM_READERS; i++) {
+		concurrent_get_time_sum += concurrent_get_time[i];
+	}
+
+	PX4_INFO("param_get: %.3f us single-threaded, %.3f us with %i readers and %i concurrent param_set",
+		 (double)single_get_time / CONCURRENT_NUM_GETS,
+		 (double)concurrent_get_time_sum / (CONCURRENT_NUM_GETS * CONCURRENT_NUM_READERS), CONCURRENT_NUM_READERS,
+		 num_sets);
+
+	ut_compare("param_get returned invalid values", 0, concurrent_bad_values.load());
+
+	param_reset(concurrent_param);
+
+	return true;
+}
+
 bool ParameterTest::exportImportAll()
 {
 	static constexpr float MAGIC_FLOAT_VAL = 0.217828f;
@@ -532,6 +636,157 @@ bool ParameterTest::exportImportAll()
 	return ret;
 }
 
+bool ParameterTest::_set_first_parameters(int num, int32_t offset)
+{
+	int num_set = 0;
+
+	for (unsigned i = 0; i < param_count() && num_set < num; i++) {
+		param_t p = param_for_index(i);
+
+		if (param_type(p) == PARAM_TYPE_INT32) {
+			const int32_t set_val = p + offset;
+			ut_compare("param_set_no_notification failed", PX4_OK, param_set_no_notification(p, &set_val));
+			num_set++;
+
+		} else if (param_type(p) == PARAM_TYPE_FLOAT) {
+			const float set_val = (float)(p + offset);
+			ut_compare("param_set_no_notification failed", PX4_OK, param_set_no_notification(p, &set_val));
+			num_set++;
+		}
+	}
+
+	return true;
+}
+
+bool ParameterTest::_check_first_parameters(int num, int32_t offset)
+{
+	int num_checked = 0;
+
+	for (unsigned i = 0; i < param_count() && num_checked < num; i++) {
+		param_t p = param_for_index(i);
+
+		if (param_type(p) == PARAM_TYPE_INT32) {
+			int32_t get_val = 0;
+			ut_compare("param_get failed", PX4_OK, param_get(p, &get_val));
+			ut_compare("value for param doesn't match saved value", p + offset, get_val);
+			num_checked++;
+
+		} else if (param_type(p) == PARAM_TYPE_FLOAT) {
+			float get_val = 0.f;
+			ut_compare("param_get failed", PX4_OK, param_get(p, &get_val));
+			ut_compare_float("value for param doesn't match saved value", (float)(p + offset), get_val, 0.001f);
+			num_checked++;
+		}
+	}
+
+	return true;
+}
+
+bool ParameterTest::saveJournal()
+{
+	static constexpr int NUM_CHANGED = 500;
+
+	// backup current parameters
+	const char *param_file_name = PX4_STORAGEDIR "/param_backup";
+	int fd = open(param_file_name, O_WRONLY | O_CREAT, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		PX4_ERR("open '%s' failed (%i)", param_file_name, errno);
+		return false;
+	}
+
+	int result = param_export(fd, false);
+	close(fd);
+
+	if (result != PX4_OK) {
+		PX4_ERR("param_export failed");
+		return false;
+	}
+
+	// a reset cannot be journaled: the next save writes the whole file
+	param_reset(p2);
+	ut_assert("setting parameters failed", _set_first_parameters(NUM_CHANGED, 1));
+
+	hrt_abstime start = hrt_absolute_time();
+	ut_compare("param_save_default failed", PX4_OK, param_save_default());
+	const hrt_abstime full_time = hrt_elapsed_time(&start);
+
+	// 1 changed parameter is appended to the journal
+	ut_assert("setting parameters failed", _set_first_parameters(1, 2));
+
+	start = hrt_absolute_time();
+	ut_compare("param_save_default failed", PX4_OK, param_save_default());
+	const hrt_abstime journal_1_time = hrt_elapsed_time(&start);
+
+	// NUM_CHANGED changed parameters
+	ut_assert("setting parameters failed", _set_first_parameters(NUM_CHANGED, 3));
+
+	start = hrt_absolute_time();
+	ut_compare("param_save_default failed", PX4_OK, param_save_default());
+	const hrt_abstime journal_n_time = hrt_elapsed_time(&start);
+
+	PX4_INFO("save: full %llu us, 1 changed %llu us, %i changed %llu us", (unsigned long long)full_time,
+		 (unsigned long long)journal_1_time, NUM_CHANGED, (unsigned long long)journal_n_time);
+
+	// changes exported to another file (which marks them as saved) are still appended to the journal
+	ut_assert("setting parameters failed", _set_first_parameters(NUM_CHANGED, 4));
+	const char *export_file_name = PX4_STORAGEDIR "/param_export";
+	fd = open(export_file_name, O_WRONLY | O_CREAT | O_TRUNC, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		PX4_ERR("open '%s' failed (%i)", export_file_name, errno);
+		return false;
+	}
+
+	result = param_export(fd, false);
+	close(fd);
+	unlink(export_file_name);
+	ut_compare("param_export failed", PX4_OK, result);
+	ut_compare("param_save_default failed", PX4_OK, param_save_default());
+
+	// overwrite w/o saving, then load the parameter file + journal
+	ut_assert("setting parameters failed", _set_first_parameters(NUM_CHANGED, 5));
+	ut_compare("param_load_default failed", PX4_OK, param_load_default());
+	ut_assert("loaded parameters don't match", _check_first_parameters(NUM_CHANGED, 4));
+
+	// an incomplete document at the end of the journal (power loss during a save) is ignored
+	char journal_file_name[256];
+	snprintf(journal_file_name, sizeof(journal_file_name), "%s%s", param_get_default_file(), PARAM_JOURNAL_SUFFIX);
+	fd = open(journal_file_name, O_WRONLY | O_APPEND);
+
+	if (fd >= 0) {
+		const int32_t truncated_document_size = 1000;
+		const bool written = write(fd, &truncated_document_size, sizeof(truncated_document_size)) == sizeof(int32_t);
+		close(fd);
+		ut_assert("journal write failed", written);
+
+		ut_compare("param_load_default failed", PX4_OK, param_load_default());
+		ut_assert("loaded parameters don't match", _check_first_parameters(NUM_CHANGED, 4));
+	}
+
+	// restore original params
+	param_reset_all();
+
+	fd = open(param_file_name, O_RDONLY);
+
+	if (fd < 0) {
+		PX4_ERR("open '%s' failed (%i)", param_file_name, errno);
+		return false;
+	}
+
+	result = param_import(fd);
+	close(fd);
+
+	if (result < 0) {
+		PX4_ERR("importing from '%s' failed (%i)", param_file_name, result);
+		return false;
+	}
+
+	ut_compare("param_save_default failed", PX4_OK, param_save_default());
+
+	return true;
+}
+
 bool ParameterTest::run_tests()
 {
 	param_control_autosave(false);
@@ -544,10 +799,12 @@ bool ParameterTest::run_tests()
 	ut_run_test(ResetAllExcludesBoundaryCheck);
 	ut_run_test(ResetAllExcludesWildcard);
 	ut_run_test(exportImport);
+	ut_run_test(getSetConcurrent);
 
 	// WARNING, can potentially trash your system
 #ifdef __PX4_POSIX
 	ut_run_test(exportImportAll);
+	ut_run_test(saveJournal);
 #endif /* __PX4_POSIX */
 
 	param_control_autosave(true);
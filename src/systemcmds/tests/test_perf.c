@@ -67,8 +67,31 @@ test_perf(int argc, char *argv[])
 	printf("perf: expect at least two counters\n");
 	perf_print_all(1);
 
+	perf_counter_t hc = perf_alloc(PC_ELAPSED, "test_histogram");
+
+	if ((hc == NULL) || (perf_histogram_enable(hc) != 0)) {
+		printf("perf: histogram alloc failed\n");
+		return 1;
+	}
+
+	for (int i = 1; i <= 1000; i++) {
+		perf_set_elapsed(hc, i);
+	}
+
+	// buckets are at most 25% wide, percentiles report the upper bucket bound
+	if (perf_percentile(hc, 50.f) < 500 || perf_percentile(hc, 50.f) > 625 ||
+	    perf_percentile(hc, 99.f) < 990 || perf_percentile(hc, 100.f) != 1000) {
+		printf("perf: unexpected percentiles\n");
+		perf_print_counter(hc);
+		return 1;
+	}
+
+	printf("perf: expect p50 of ~500us\n");
+	perf_print_counter(hc);
+
 	perf_free(cc);
 	perf_free(ec);
+	perf_free(hc);
 
 	return OK;
 }
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2019 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file work_queue.cpp
+ *
+ * Print the status and run statistics of the work queues.
+ */
+
+#include <px4_config.h>
+#include <px4_module.h>
+#include <px4_platform_common/px4_work_queue/WorkQueueManager.hpp>
+
+#include <string.h>
+
+extern "C" __EXPORT int work_queue_main(int argc, char *argv[]);
+
+static void print_usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+Tool to print the work queues and the run statistics of their work items.
+
+For each work item the number of runs, the latency from the schedule request
+to the start of the run and the run time are reported (average and maximum).
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME_SIMPLE("work_queue", "command");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print work queue status and work item statistics");
+	PRINT_MODULE_USAGE_PARAM_FLAG('v', "Also print latency and run time histograms", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Reset the work item statistics");
+}
+
+int work_queue_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		print_usage();
+		return 1;
+	}
+
+	if (strcmp(argv[1], "status") == 0) {
+		const bool verbose = (argc > 2) && (strcmp(argv[2], "-v") == 0);
+
+		px4::WorkQueueManagerStatus(verbose);
+		return 0;
+
+	} else if (strcmp(argv[1], "reset") == 0) {
+		px4::WorkQueueManagerResetStats();
+		return 0;
+	}
+
+	print_usage();
+	return 1;
+}